@@ -3,6 +3,9 @@
 
 #include "CommonDeveloperUtils.h"
 #include "SelectorUtils.h"
+#include "SelectorCallSiteUtils.h"
+#include "K2Node_CallFunction.h"
+#include "KismetCompiler.h"
 
 CommonDeveloperUtils::CommonDeveloperUtils()
 {
@@ -218,3 +221,39 @@ bool CommonDeveloperUtils::PostPinConnectionReconstructionWithCategoryInfoSync(U
 
 	return false;
 }
+
+FName CommonDeveloperUtils::MakeCallSiteName(const FKismetCompilerContext& CompilerContext, UK2Node* Node)
+{
+	// The node being expanded may be a duplicate made for compilation, so prefer the source node (the guid is kept either way)
+	const UEdGraphNode* SourceNode = Cast<UEdGraphNode>(CompilerContext.MessageLog.FindSourceObject(Node));
+	if (!SourceNode)
+	{
+		SourceNode = Node;
+	}
+
+	const UEdGraph* Graph = SourceNode->GetGraph();
+	const FString BlueprintPath = CompilerContext.Blueprint ? CompilerContext.Blueprint->GetPathName() : FString(TEXT("None"));
+	const FString GraphName = Graph ? Graph->GetName() : FString(TEXT("None"));
+	return FName(FString::Printf(TEXT("%s.%s:%s"), *BlueprintPath, *GraphName, *SourceNode->NodeGuid.ToString(EGuidFormats::Digits)));
+}
+
+void CommonDeveloperUtils::ExpandWithCallSiteTracking(FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph, UK2Node* Node, UEdGraphPin* ChainExecPin, UEdGraphPin* ChainThenPin)
+{
+	FName FuncName = GET_FUNCTION_NAME_CHECKED(USelectorCallSiteUtils, BeginSelectorCallSite);
+	UK2Node_CallFunction* BeginFuncNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(Node, SourceGraph);
+	BeginFuncNode->FunctionReference.SetExternalMember(FuncName, USelectorCallSiteUtils::StaticClass());
+	BeginFuncNode->AllocateDefaultPins();
+	UEdGraphPin* BeginCallSitePin = BeginFuncNode->FindPinChecked(TEXT("CallSite"));
+	CompilerContext.GetSchema()->TrySetDefaultValue(*BeginCallSitePin, MakeCallSiteName(CompilerContext, Node).ToString());
+
+	FuncName = GET_FUNCTION_NAME_CHECKED(USelectorCallSiteUtils, EndSelectorCallSite);
+	UK2Node_CallFunction* EndFuncNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(Node, SourceGraph);
+	EndFuncNode->FunctionReference.SetExternalMember(FuncName, USelectorCallSiteUtils::StaticClass());
+	EndFuncNode->AllocateDefaultPins();
+
+	// Exec -> Begin -> Chain -> End -> Then
+	CompilerContext.MovePinLinksToIntermediate(*Node->GetExecPin(), *BeginFuncNode->GetExecPin());
+	BeginFuncNode->GetThenPin()->MakeLinkTo(ChainExecPin);
+	ChainThenPin->MakeLinkTo(EndFuncNode->GetExecPin());
+	CompilerContext.MovePinLinksToIntermediate(*Node->GetThenPin(), *EndFuncNode->GetThenPin());
+}
@@ -11,8 +11,8 @@
 #include "Engine/DataTable.h"
 #include "SelectorUtils.h"
 #include "CommonUtils.h"
-#include "Kismet/BlueprintMapLibrary.h"
 #include "Kismet/DataTableFunctionLibrary.h"
+#include "Kismet/KismetStringLibrary.h"
 
 FText UK2Node_CookSelectorInput::GetTooltipText() const
 {
@@ -68,57 +68,50 @@ void UK2Node_CookSelectorInput::ExpandNode(FKismetCompilerContext& CompilerConte
 	CookFuncNode->FunctionReference.SetExternalMember(FuncName, USelectorUtils::StaticClass());
 	CookFuncNode->AllocateDefaultPins();
 
-	UEdGraphPin* ExecPin = GetExecPin();
 	UEdGraphPin* InputPin = GetInputPin();
 	UEdGraphPin* OutputPin = GetOutputPin();
-	UEdGraphPin* ThenPin = GetThenPin();
 	UEdGraphPin* CookFuncExecPin = CookFuncNode->GetExecPin();
 	UEdGraphPin* CookFuncInputPin = CookFuncNode->FindPin(FuncInputPinName);
 	UEdGraphPin* CookFuncOutputPin = CookFuncNode->FindPin(FuncOutputPinName);
 	UEdGraphPin* CookFuncThenPin = CookFuncNode->GetThenPin();
 
+	// First exec input and last then output of the expanded chain, wrapped with call site tracking after the chain is built
+	UEdGraphPin* ChainExecPin = nullptr;
+	UEdGraphPin* ChainThenPin = nullptr;
+
 	switch (CurrentFormat)
 	{
 	case EFenixSelectorInputFormat::Array:
 		{
-			CompilerContext.MovePinLinksToIntermediate(*ExecPin, *CookFuncExecPin);
+			ChainExecPin = CookFuncExecPin;
 			CompilerContext.MovePinLinksToIntermediate(*InputPin, *CookFuncInputPin);
 			CompilerContext.MovePinLinksToIntermediate(*OutputPin, *CookFuncOutputPin);
-			CompilerContext.MovePinLinksToIntermediate(*ThenPin, *CookFuncThenPin);
+			ChainThenPin = CookFuncThenPin;
 		}
 		break;
 	case EFenixSelectorInputFormat::Map:
 		{
 			UEdGraphPin* OutputKeysPin = GetOutputKeysPin();
 
-			FuncName = GET_FUNCTION_NAME_CHECKED(UBlueprintMapLibrary, Map_Keys);
-			UK2Node_CallFunction* GetKeysFuncNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
-			GetKeysFuncNode->FunctionReference.SetExternalMember(FuncName, UBlueprintMapLibrary::StaticClass());
-			GetKeysFuncNode->AllocateDefaultPins();
-			UEdGraphPin* GetKeysInputPin = GetKeysFuncNode->FindPin(TEXT("TargetMap"));
-			CommonDeveloperUtils::CopyPinTypeAndValueTypeInfo(GetKeysInputPin->PinType, InputPin->PinType);
-			UEdGraphPin* GetKeysOutputPin = GetKeysFuncNode->FindPin(TEXT("Keys"));
+			FuncName = GET_FUNCTION_NAME_CHECKED(UCommonUtils, Map_KeysAndValues);
+			UK2Node_CallFunction* GetKeysAndValuesFuncNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
+			GetKeysAndValuesFuncNode->FunctionReference.SetExternalMember(FuncName, UCommonUtils::StaticClass());
+			GetKeysAndValuesFuncNode->AllocateDefaultPins();
+			UEdGraphPin* GetKeysAndValuesInputPin = GetKeysAndValuesFuncNode->FindPin(TEXT("TargetMap"));
+			CommonDeveloperUtils::CopyPinTypeAndValueTypeInfo(GetKeysAndValuesInputPin->PinType, InputPin->PinType);
+			UEdGraphPin* GetKeysOutputPin = GetKeysAndValuesFuncNode->FindPin(TEXT("Keys"));
 			CommonDeveloperUtils::CopyPinTypeCategoryInfo(GetKeysOutputPin->PinType, OutputKeysPin->PinType);
-
-			FuncName = GET_FUNCTION_NAME_CHECKED(UBlueprintMapLibrary, Map_Values);
-			UK2Node_CallFunction* GetValuesFuncNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
-			GetValuesFuncNode->FunctionReference.SetExternalMember(FuncName, UBlueprintMapLibrary::StaticClass());
-			GetValuesFuncNode->AllocateDefaultPins();
-			UEdGraphPin* GetValuesInputPin = GetValuesFuncNode->FindPin(TEXT("TargetMap"));
-			CommonDeveloperUtils::CopyPinTypeAndValueTypeInfo(GetValuesInputPin->PinType, InputPin->PinType);
-			UEdGraphPin* GetValuesOutputPin = GetValuesFuncNode->FindPin(TEXT("Values"));
+			UEdGraphPin* GetValuesOutputPin = GetKeysAndValuesFuncNode->FindPin(TEXT("Values"));
 			CommonDeveloperUtils::CopyPinTypeCategoryInfo(GetValuesOutputPin->PinType, CookFuncInputPin->PinType);
 
-			// Keys = GetKeys(Map) -> Values = GetValues(Map) -> Cooked = Cook(Values) => Return (Cooked, Keys)
-			CompilerContext.MovePinLinksToIntermediate(*ExecPin, *(GetKeysFuncNode->GetExecPin()));
-			CompilerContext.CopyPinLinksToIntermediate(*InputPin, *GetKeysInputPin);
+			// (Keys, Values) = GetKeysAndValues(Map) -> Cooked = Cook(Values) => Return (Cooked, Keys)
+			ChainExecPin = GetKeysAndValuesFuncNode->GetExecPin();
+			CompilerContext.MovePinLinksToIntermediate(*InputPin, *GetKeysAndValuesInputPin);
 			CompilerContext.MovePinLinksToIntermediate(*OutputKeysPin, *GetKeysOutputPin);
-			GetKeysFuncNode->GetThenPin()->MakeLinkTo(GetValuesFuncNode->GetExecPin());
-			CompilerContext.MovePinLinksToIntermediate(*InputPin, *GetValuesInputPin);
 			GetValuesOutputPin->MakeLinkTo(CookFuncInputPin);
-			GetValuesFuncNode->GetThenPin()->MakeLinkTo(CookFuncExecPin);
+			GetKeysAndValuesFuncNode->GetThenPin()->MakeLinkTo(CookFuncExecPin);
 			CompilerContext.MovePinLinksToIntermediate(*OutputPin, *CookFuncOutputPin);
-			CompilerContext.MovePinLinksToIntermediate(*ThenPin, *CookFuncThenPin);
+			ChainThenPin = CookFuncThenPin;
 		}
 		break;
 	case EFenixSelectorInputFormat::DataTable:
@@ -160,7 +153,7 @@ void UK2Node_CookSelectorInput::ExpandNode(FKismetCompilerContext& CompilerConte
 			}
 
 			// Keys = GetRowNames(DataTable) -> Values = GetValues(DataTable, LabelNames) -> Cooked = Cook(Values) => Return (Cooked, Keys)
-			CompilerContext.MovePinLinksToIntermediate(*ExecPin, *(GetKeysFuncNode->GetExecPin()));
+			ChainExecPin = GetKeysFuncNode->GetExecPin();
 			CompilerContext.CopyPinLinksToIntermediate(*InputPin, *GetKeysInputPin);
 			CompilerContext.MovePinLinksToIntermediate(*OutputKeysPin, *GetKeysOutputPin);
 			GetKeysFuncNode->GetThenPin()->MakeLinkTo(GetValuesFuncNode->GetExecPin());
@@ -173,11 +166,28 @@ void UK2Node_CookSelectorInput::ExpandNode(FKismetCompilerContext& CompilerConte
 			GetValuesOutputPin->MakeLinkTo(CookFuncInputPin);
 			GetValuesFuncNode->GetThenPin()->MakeLinkTo(CookFuncExecPin);
 			CompilerContext.MovePinLinksToIntermediate(*OutputPin, *CookFuncOutputPin);
-			CompilerContext.MovePinLinksToIntermediate(*ThenPin, *CookFuncThenPin);
+			ChainThenPin = CookFuncThenPin;
 		}
 		break;
 	}
 
+	// Cooked = Cook(...) -> (SmallCooked, FitsSmall) = CookSmall(Cooked) => Return (..., SmallCooked, FitsSmall)
+	if (CurrentDataType == EFenixSelectorInputDataType::WeightOrProb && bCookSmall)
+	{
+		FuncName = GET_FUNCTION_NAME_CHECKED(USelectorUtils, CookSmallSelectorDistribution);
+		UK2Node_CallFunction* CookSmallFuncNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
+		CookSmallFuncNode->FunctionReference.SetExternalMember(FuncName, USelectorUtils::StaticClass());
+		CookSmallFuncNode->AllocateDefaultPins();
+
+		CookFuncOutputPin->MakeLinkTo(CookSmallFuncNode->FindPin(TEXT("Distribution")));
+		CompilerContext.MovePinLinksToIntermediate(*GetOutputSmallDistributionPin(), *CookSmallFuncNode->FindPin(TEXT("OutDistribution")));
+		CompilerContext.MovePinLinksToIntermediate(*GetOutputFitsSmallPin(), *CookSmallFuncNode->GetReturnValuePin());
+		ChainThenPin->MakeLinkTo(CookSmallFuncNode->GetExecPin());
+		ChainThenPin = CookSmallFuncNode->GetThenPin();
+	}
+
+	CommonDeveloperUtils::ExpandWithCallSiteTracking(CompilerContext, SourceGraph, this, ChainExecPin, ChainThenPin);
+
 	BreakAllNodeLinks();
 }
 
@@ -199,6 +209,12 @@ void UK2Node_CookSelectorInput::AllocateDefaultPins()
 	FormatPin->DefaultValue = FormatTypeObject->GetNameStringByValue(static_cast<int64>(CurrentFormat));
 	FormatPin->bNotConnectable = true;
 
+	// Add cook small pin, only meaningful for cooked distributions
+	if (CurrentDataType == EFenixSelectorInputDataType::WeightOrProb)
+	{
+		CreateCookSmallPin();
+	}
+
 	// Add other pins
 	CreateInOutPins();
 
@@ -217,6 +233,10 @@ void UK2Node_CookSelectorInput::PinDefaultValueChanged(UEdGraphPin* ChangedPin)
 	{
 		OnFormatPinUpdated(ChangedPin);
 	}
+	else if (ChangedPin == GetCookSmallPin())
+	{
+		OnCookSmallPinUpdated(ChangedPin);
+	}
 	else if (ChangedPin == GetInputPin())
 	{
 		OnInputPinUpdated(ChangedPin);
@@ -354,6 +374,10 @@ void UK2Node_CookSelectorInput::CreateInOutPins()
 		break;
 	case EFenixSelectorInputDataType::WeightOrProb:
 		CreatePin(EGPD_Output, UEdGraphSchema_K2::PC_Struct, FCookedSelectorDistribution::StaticStruct(), PIN_NAME_COOKED_DISTRIBUTION);
+		if (bCookSmall)
+		{
+			CreateSmallDistributionPins();
+		}
 		break;
 	}
 	FCreatePinParams OutKeysPinParam;
@@ -369,6 +393,35 @@ void UK2Node_CookSelectorInput::CreateInOutPins()
 	}
 }
 
+void UK2Node_CookSelectorInput::CreateCookSmallPin()
+{
+	UEdGraphPin* CookSmallPin = CreatePin(EGPD_Input, UEdGraphSchema_K2::PC_Boolean, PIN_NAME_COOK_SMALL);
+	CookSmallPin->DefaultValue = UKismetStringLibrary::Conv_BoolToString(bCookSmall);
+	CookSmallPin->bNotConnectable = true;
+}
+
+void UK2Node_CookSelectorInput::CreateSmallDistributionPins()
+{
+	CreatePin(EGPD_Output, UEdGraphSchema_K2::PC_Struct, FCookedSmallSelectorDistribution::StaticStruct(), PIN_NAME_SMALL_DISTRIBUTION);
+	CreatePin(EGPD_Output, UEdGraphSchema_K2::PC_Boolean, PIN_NAME_FITS_SMALL);
+}
+
+void UK2Node_CookSelectorInput::RemoveSmallDistributionPins()
+{
+	if (UEdGraphPin* SmallDistributionPin = GetOutputSmallDistributionPin())
+	{
+		if (!SmallDistributionPin->SubPins.IsEmpty())
+		{
+			GetSchema()->RecombinePin(SmallDistributionPin->SubPins[0]);
+		}
+		RemovePin(SmallDistributionPin);
+	}
+	if (UEdGraphPin* FitsSmallPin = GetOutputFitsSmallPin())
+	{
+		RemovePin(FitsSmallPin);
+	}
+}
+
 void UK2Node_CookSelectorInput::OnDataTypePinUpdated(UEdGraphPin* ChangedPin)
 {
 	// Get new data type
@@ -475,6 +528,27 @@ void UK2Node_CookSelectorInput::OnDataTypePinUpdated(UEdGraphPin* ChangedPin)
 		break;
 	}
 
+	// Cook small pins
+	if (NewDataType == EFenixSelectorInputDataType::WeightOrProb)
+	{
+		if (!GetCookSmallPin())
+		{
+			CreateCookSmallPin();
+		}
+		if (bCookSmall && !GetOutputSmallDistributionPin())
+		{
+			CreateSmallDistributionPins();
+		}
+	}
+	else
+	{
+		if (UEdGraphPin* CookSmallPin = GetCookSmallPin())
+		{
+			RemovePin(CookSmallPin);
+		}
+		RemoveSmallDistributionPins();
+	}
+
 	// Update data type cache
 	CurrentDataType = NewDataType;
 
@@ -659,6 +733,30 @@ void UK2Node_CookSelectorInput::OnFormatPinUpdated(UEdGraphPin* ChangedPin)
 	}
 }
 
+void UK2Node_CookSelectorInput::OnCookSmallPinUpdated(UEdGraphPin* ChangedPin)
+{
+	// Get new cook small flag
+	bCookSmall = ChangedPin->DefaultValue.ToBool();
+
+	// Create/remove small distribution pins
+	if (bCookSmall)
+	{
+		if (!GetOutputSmallDistributionPin())
+		{
+			CreateSmallDistributionPins();
+		}
+	}
+	else
+	{
+		RemoveSmallDistributionPins();
+	}
+
+	// Mark dirty/modified
+	CachedToolTip.MarkDirty();
+	FBlueprintEditorUtils::MarkBlueprintAsModified(GetBlueprint());
+	GetGraph()->NotifyGraphChanged();
+}
+
 void UK2Node_CookSelectorInput::OnInputPinUpdated(UEdGraphPin* ChangedPin)
 {
 	switch (CurrentFormat)
@@ -692,9 +790,10 @@ void UK2Node_CookSelectorInput::OnDataTableIsProbNamePinUpdated(UEdGraphPin* Cha
 
 FText UK2Node_CookSelectorInput::GetCurrentTooltip() const
 {
-	FText FormatString = FText::FromString("{0}{1}.");
+	FText FormatString = FText::FromString("{0}{1}{2}.");
 	FText Arg0 = FText();
 	FText Arg1 = FText();
+	FText Arg2 = FText();
 
 	switch (CurrentDataType)
 	{
@@ -705,7 +804,7 @@ FText UK2Node_CookSelectorInput::GetCurrentTooltip() const
 		FormatString = FText::FromString("Cook a probability {0} into cumulative probabilities{1}.");
 		break;
 	case EFenixSelectorInputDataType::WeightOrProb:
-		FormatString = FText::FromString("Cook a \"weight or probability\" {0} into a CookedSelectorDistribution{1}.");
+		FormatString = FText::FromString("Cook a \"weight or probability\" {0} into a CookedSelectorDistribution{1}{2}.");
 		break;
 	}
 
@@ -724,7 +823,12 @@ FText UK2Node_CookSelectorInput::GetCurrentTooltip() const
 		break;
 	}
 
-	return FText::Format(FormatString, Arg0, Arg1);
+	if (CurrentDataType == EFenixSelectorInputDataType::WeightOrProb && bCookSmall)
+	{
+		Arg2 = FText::FromString(", plus a CookedSmallSelectorDistribution with inline storage if it has at most 16 entries (Fits Small tells whether it does)");
+	}
+
+	return FText::Format(FormatString, Arg0, Arg1, Arg2);
 }
 
 UEdGraphPin* UK2Node_CookSelectorInput::GetDataTypePin()
@@ -737,6 +841,11 @@ UEdGraphPin* UK2Node_CookSelectorInput::GetFormatPin()
 	return FindPin(PIN_NAME_FORMAT);
 }
 
+UEdGraphPin* UK2Node_CookSelectorInput::GetCookSmallPin()
+{
+	return FindPin(PIN_NAME_COOK_SMALL);
+}
+
 UEdGraphPin* UK2Node_CookSelectorInput::GetInputPin()
 {
 	switch (CurrentFormat)
@@ -813,3 +922,13 @@ UEdGraphPin* UK2Node_CookSelectorInput::GetOutputKeysPin()
 	}
 	return nullptr;
 }
+
+UEdGraphPin* UK2Node_CookSelectorInput::GetOutputSmallDistributionPin()
+{
+	return FindPin(PIN_NAME_SMALL_DISTRIBUTION);
+}
+
+UEdGraphPin* UK2Node_CookSelectorInput::GetOutputFitsSmallPin()
+{
+	return FindPin(PIN_NAME_FITS_SMALL);
+}
@@ -11,8 +11,6 @@
 #include "Engine/DataTable.h"
 #include "SelectorUtils.h"
 #include "CommonUtils.h"
-#include "Kismet/BlueprintMapLibrary.h"
-#include "Kismet/DataTableFunctionLibrary.h"
 #include "Kismet/KismetStringLibrary.h"
 
 FText UK2Node_RandomSelect::GetTooltipText() const
@@ -82,27 +80,46 @@ void UK2Node_RandomSelect::ExpandNode(FKismetCompilerContext& CompilerContext, U
 		break;
 	}
 
+	if (CurrentFormat == EFenixSelectorInputFormat::DataTable)  // fused native call doing the extraction, the selection and the row output
+	{
+		switch (CurrentDataType)
+		{
+		case EFenixSelectorInputDataType::Weight:
+			FuncName = bUseStream ? GET_FUNCTION_NAME_CHECKED(USelectorUtils, DataTable_SelectRowWithWeightsFromStream) : GET_FUNCTION_NAME_CHECKED(USelectorUtils, DataTable_SelectRowWithWeights);
+			break;
+		case EFenixSelectorInputDataType::Prob:
+			FuncName = bUseStream ? GET_FUNCTION_NAME_CHECKED(USelectorUtils, DataTable_SelectRowWithProbsFromStream) : GET_FUNCTION_NAME_CHECKED(USelectorUtils, DataTable_SelectRowWithProbs);
+			break;
+		case EFenixSelectorInputDataType::WeightOrProb:
+			FuncName = bUseStream ? GET_FUNCTION_NAME_CHECKED(USelectorUtils, DataTable_SelectRowWithWeightOrProbEntriesFromStream) : GET_FUNCTION_NAME_CHECKED(USelectorUtils, DataTable_SelectRowWithWeightOrProbEntries);
+			break;
+		}
+		FuncInputPinName = PIN_NAME_DATA_TABLE;
+	}
+
 	UK2Node_CallFunction* SelectFuncNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
 	SelectFuncNode->FunctionReference.SetExternalMember(FuncName, USelectorUtils::StaticClass());
 	SelectFuncNode->AllocateDefaultPins();
 
-	UEdGraphPin* ExecPin = GetExecPin();
 	UEdGraphPin* InputPin = GetInputPin();
 	UEdGraphPin* OutputPin = GetOutputPin();
-	UEdGraphPin* ThenPin = GetThenPin();
 	UEdGraphPin* SelectFuncExecPin = SelectFuncNode->GetExecPin();
 	UEdGraphPin* SelectFuncInputPin = SelectFuncNode->FindPin(FuncInputPinName);
 	UEdGraphPin* SelectFuncOutputPin = SelectFuncNode->GetReturnValuePin();
 	UEdGraphPin* SelectFuncThenPin = SelectFuncNode->GetThenPin();
 
+	// First exec input and last then output of the expanded chain, wrapped with call site tracking after the chain is built
+	UEdGraphPin* ChainExecPin = nullptr;
+	UEdGraphPin* ChainThenPin = nullptr;
+
 	switch (CurrentFormat)
 	{
 	case EFenixSelectorInputFormat::Array: // this include the case where bUseCookedInput is true
 		{
-			CompilerContext.MovePinLinksToIntermediate(*ExecPin, *SelectFuncExecPin);
+			ChainExecPin = SelectFuncExecPin;
 			CompilerContext.MovePinLinksToIntermediate(*InputPin, *SelectFuncInputPin);
 			CompilerContext.MovePinLinksToIntermediate(*OutputPin, *SelectFuncOutputPin);
-			CompilerContext.MovePinLinksToIntermediate(*ThenPin, *SelectFuncThenPin);
+			ChainThenPin = SelectFuncThenPin;
 		}
 		break;
 	case EFenixSelectorInputFormat::Map:
@@ -110,22 +127,15 @@ void UK2Node_RandomSelect::ExpandNode(FKismetCompilerContext& CompilerContext, U
 			UEdGraphPin* OutputKeyPin = GetOutputKeyPin();
 			const FEdGraphPinType& OutputKeyPinType = OutputKeyPin->PinType;
 
-			FuncName = GET_FUNCTION_NAME_CHECKED(UBlueprintMapLibrary, Map_Keys);
-			UK2Node_CallFunction* GetKeysFuncNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
-			GetKeysFuncNode->FunctionReference.SetExternalMember(FuncName, UBlueprintMapLibrary::StaticClass());
-			GetKeysFuncNode->AllocateDefaultPins();
-			UEdGraphPin* GetKeysInputPin = GetKeysFuncNode->FindPin(TEXT("TargetMap"));
-			CommonDeveloperUtils::CopyPinTypeAndValueTypeInfo(GetKeysInputPin->PinType, InputPin->PinType);
-			UEdGraphPin* GetKeysOutputPin = GetKeysFuncNode->FindPin(TEXT("Keys"));
+			FuncName = GET_FUNCTION_NAME_CHECKED(UCommonUtils, Map_KeysAndValues);
+			UK2Node_CallFunction* GetKeysAndValuesFuncNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
+			GetKeysAndValuesFuncNode->FunctionReference.SetExternalMember(FuncName, UCommonUtils::StaticClass());
+			GetKeysAndValuesFuncNode->AllocateDefaultPins();
+			UEdGraphPin* GetKeysAndValuesInputPin = GetKeysAndValuesFuncNode->FindPin(TEXT("TargetMap"));
+			CommonDeveloperUtils::CopyPinTypeAndValueTypeInfo(GetKeysAndValuesInputPin->PinType, InputPin->PinType);
+			UEdGraphPin* GetKeysOutputPin = GetKeysAndValuesFuncNode->FindPin(TEXT("Keys"));
 			CommonDeveloperUtils::CopyPinTypeCategoryInfo(GetKeysOutputPin->PinType, OutputKeyPinType);
-
-			FuncName = GET_FUNCTION_NAME_CHECKED(UBlueprintMapLibrary, Map_Values);
-			UK2Node_CallFunction* GetValuesFuncNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
-			GetValuesFuncNode->FunctionReference.SetExternalMember(FuncName, UBlueprintMapLibrary::StaticClass());
-			GetValuesFuncNode->AllocateDefaultPins();
-			UEdGraphPin* GetValuesInputPin = GetValuesFuncNode->FindPin(TEXT("TargetMap"));
-			CommonDeveloperUtils::CopyPinTypeAndValueTypeInfo(GetValuesInputPin->PinType, InputPin->PinType);
-			UEdGraphPin* GetValuesOutputPin = GetValuesFuncNode->FindPin(TEXT("Values"));
+			UEdGraphPin* GetValuesOutputPin = GetKeysAndValuesFuncNode->FindPin(TEXT("Values"));
 			CommonDeveloperUtils::CopyPinTypeCategoryInfo(GetValuesOutputPin->PinType, SelectFuncInputPin->PinType);
 
 			FuncName = GET_FUNCTION_NAME_CHECKED(UCommonUtils, Array_Get_Impure);
@@ -138,88 +148,45 @@ void UK2Node_RandomSelect::ExpandNode(FKismetCompilerContext& CompilerContext, U
 			UEdGraphPin* GetItemOutputItemPin = GetItemFuncNode->FindPin(TEXT("Item"));
 			CommonDeveloperUtils::CopyPinTypeCategoryInfo(GetItemOutputItemPin->PinType, OutputKeyPinType);
 
-			// Keys = GetKeys(Map) -> Values = GetValues(Map) -> SelectedIndex = Select(Values) => SelectedKey = GetItem(Keys, SelectedIndex) => Return (SelectedIndex, SelectedKey)
-			CompilerContext.MovePinLinksToIntermediate(*ExecPin, *(GetKeysFuncNode->GetExecPin()));
-			CompilerContext.CopyPinLinksToIntermediate(*InputPin, *GetKeysInputPin);
+			// (Keys, Values) = GetKeysAndValues(Map) -> SelectedIndex = Select(Values) => SelectedKey = GetItem(Keys, SelectedIndex) => Return (SelectedIndex, SelectedKey)
+			ChainExecPin = GetKeysAndValuesFuncNode->GetExecPin();
+			CompilerContext.MovePinLinksToIntermediate(*InputPin, *GetKeysAndValuesInputPin);
 			GetKeysOutputPin->MakeLinkTo(GetItemInputArrayPin);
-			GetKeysFuncNode->GetThenPin()->MakeLinkTo(GetValuesFuncNode->GetExecPin());
-			CompilerContext.MovePinLinksToIntermediate(*InputPin, *GetValuesInputPin);
 			GetValuesOutputPin->MakeLinkTo(SelectFuncInputPin);
-			GetValuesFuncNode->GetThenPin()->MakeLinkTo(SelectFuncExecPin);
+			GetKeysAndValuesFuncNode->GetThenPin()->MakeLinkTo(SelectFuncExecPin);
 			CompilerContext.MovePinLinksToIntermediate(*OutputPin, *SelectFuncOutputPin);
 			SelectFuncOutputPin->MakeLinkTo(GetItemInputIndexPin);
 			SelectFuncThenPin->MakeLinkTo(GetItemFuncNode->GetExecPin());
 			CompilerContext.MovePinLinksToIntermediate(*OutputKeyPin, *GetItemOutputItemPin);
-			CompilerContext.MovePinLinksToIntermediate(*ThenPin, *GetItemFuncNode->GetThenPin());
+			ChainThenPin = GetItemFuncNode->GetThenPin();
 		}
 		break;
 	case EFenixSelectorInputFormat::DataTable:
 		{
-			UEdGraphPin* OutputKeyPin = GetOutputKeyPin();
-			const FEdGraphPinType& OutputKeyPinType = OutputKeyPin->PinType;
-
-			FuncName = GET_FUNCTION_NAME_CHECKED(UDataTableFunctionLibrary, GetDataTableRowNames);
-			UK2Node_CallFunction* GetKeysFuncNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
-			GetKeysFuncNode->FunctionReference.SetExternalMember(FuncName, UDataTableFunctionLibrary::StaticClass());
-			GetKeysFuncNode->AllocateDefaultPins();
-			UEdGraphPin* GetKeysInputPin = GetKeysFuncNode->FindPin(TEXT("Table"));
-			UEdGraphPin* GetKeysOutputPin = GetKeysFuncNode->FindPin(TEXT("OutRowNames"));
-
-			UK2Node_CallFunction* GetValuesFuncNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
-			UEdGraphPin* GetValuesInputPin = nullptr;
-			UEdGraphPin* GetValuesWeightOrProbNamePin = nullptr;
-			UEdGraphPin* GetValuesIsProbNamePin = nullptr;
-			UEdGraphPin* GetValuesOutputPin = nullptr;
-			switch (CurrentDataType)
+			UEdGraphPin* OutputRowPin = GetOutputRowPin();
+			UEdGraphPin* SelectFuncOutputRowPin = SelectFuncNode->FindPin(TEXT("OutRow"));
+			if (OutputRowPin->PinType.PinCategory == UEdGraphSchema_K2::PC_Struct)
 			{
-			case EFenixSelectorInputDataType::Weight:
-			case EFenixSelectorInputDataType::Prob:
-				FuncName = GET_FUNCTION_NAME_CHECKED(UCommonUtils, GetDataTableColumnAsFloats);
-				GetValuesFuncNode->FunctionReference.SetExternalMember(FuncName, UCommonUtils::StaticClass());
-				GetValuesFuncNode->AllocateDefaultPins();
-				GetValuesInputPin = GetValuesFuncNode->FindPin(TEXT("DataTable"));
-				GetValuesWeightOrProbNamePin = GetValuesFuncNode->FindPin(TEXT("PropertyName"));
-				GetValuesOutputPin = GetValuesFuncNode->FindPin(TEXT("OutValues"));
-				break;
-			case EFenixSelectorInputDataType::WeightOrProb:
-				FuncName = GET_FUNCTION_NAME_CHECKED(USelectorUtils, GetWeightOrProbEntriesFromDataTable);
-				GetValuesFuncNode->FunctionReference.SetExternalMember(FuncName, USelectorUtils::StaticClass());
-				GetValuesFuncNode->AllocateDefaultPins();
-				GetValuesInputPin = GetValuesFuncNode->FindPin(TEXT("DataTable"));
-				GetValuesWeightOrProbNamePin = GetValuesFuncNode->FindPin(TEXT("WeightOrProbPropertyName"));
-				GetValuesIsProbNamePin = GetValuesFuncNode->FindPin(TEXT("IsProbPropertyName"));
-				GetValuesOutputPin = GetValuesFuncNode->FindPin(TEXT("OutEntries"));
-				break;
+				CommonDeveloperUtils::CopyPinTypeCategoryInfo(SelectFuncOutputRowPin->PinType, OutputRowPin->PinType);
+			}
+			else  // row output unused, the native call skips the copy for the base row struct
+			{
+				SelectFuncOutputRowPin->PinType.PinCategory = UEdGraphSchema_K2::PC_Struct;
+				SelectFuncOutputRowPin->PinType.PinSubCategoryObject = FTableRowBase::StaticStruct();
 			}
 
-			FuncName = GET_FUNCTION_NAME_CHECKED(UCommonUtils, Array_Get_Impure);
-			UK2Node_CallFunction* GetItemFuncNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
-			GetItemFuncNode->FunctionReference.SetExternalMember(FuncName, UCommonUtils::StaticClass());
-			GetItemFuncNode->AllocateDefaultPins();
-			UEdGraphPin* GetItemInputArrayPin = GetItemFuncNode->FindPin(TEXT("TargetArray"));
-			CommonDeveloperUtils::CopyPinTypeCategoryInfo(GetItemInputArrayPin->PinType, OutputKeyPinType);
-			UEdGraphPin* GetItemInputIndexPin = GetItemFuncNode->FindPin(TEXT("Index"));
-			UEdGraphPin* GetItemOutputItemPin = GetItemFuncNode->FindPin(TEXT("Item"));
-			CommonDeveloperUtils::CopyPinTypeCategoryInfo(GetItemOutputItemPin->PinType, OutputKeyPinType);
-
-			// Keys = GetRowNames(DataTable) -> Values = GetValues(DataTable, LabelNames) -> SelectedIndex = Select(Values) => SelectedKey = GetItem(Keys, SelectedIndex) => Return (SelectedIndex, SelectedKey)
-			CompilerContext.MovePinLinksToIntermediate(*ExecPin, *(GetKeysFuncNode->GetExecPin()));
-			CompilerContext.CopyPinLinksToIntermediate(*InputPin, *GetKeysInputPin);
-			GetKeysOutputPin->MakeLinkTo(GetItemInputArrayPin);
-			GetKeysFuncNode->GetThenPin()->MakeLinkTo(GetValuesFuncNode->GetExecPin());
-			CompilerContext.MovePinLinksToIntermediate(*InputPin, *GetValuesInputPin);
-			CompilerContext.MovePinLinksToIntermediate(*GetInputDataTableWeightOrProbNamePin(), *GetValuesWeightOrProbNamePin);
-			if (GetValuesIsProbNamePin)
+			// (SelectedIndex, SelectedRowName, SelectedRow) = SelectRow(DataTable, LabelNames)
+			ChainExecPin = SelectFuncExecPin;
+			CompilerContext.MovePinLinksToIntermediate(*InputPin, *SelectFuncInputPin);
+			CompilerContext.MovePinLinksToIntermediate(*GetInputDataTableWeightOrProbNamePin(), *SelectFuncNode->FindPin(GetInputDataTableWeightOrProbNamePin()->PinName));
+			if (UEdGraphPin* InputDataTableIsProbNamePin = GetInputDataTableIsProbNamePin())
 			{
-				CompilerContext.MovePinLinksToIntermediate(*GetInputDataTableIsProbNamePin(), *GetValuesIsProbNamePin);
+				CompilerContext.MovePinLinksToIntermediate(*InputDataTableIsProbNamePin, *SelectFuncNode->FindPin(PIN_NAME_IS_PROB_PROPERTY_NAME));
 			}
-			GetValuesOutputPin->MakeLinkTo(SelectFuncInputPin);
-			GetValuesFuncNode->GetThenPin()->MakeLinkTo(SelectFuncExecPin);
 			CompilerContext.MovePinLinksToIntermediate(*OutputPin, *SelectFuncOutputPin);
-			SelectFuncOutputPin->MakeLinkTo(GetItemInputIndexPin);
-			SelectFuncThenPin->MakeLinkTo(GetItemFuncNode->GetExecPin());
-			CompilerContext.MovePinLinksToIntermediate(*OutputKeyPin, *GetItemOutputItemPin);
-			CompilerContext.MovePinLinksToIntermediate(*ThenPin, *GetItemFuncNode->GetThenPin());
+			CompilerContext.MovePinLinksToIntermediate(*GetOutputKeyPin(), *SelectFuncNode->FindPin(TEXT("OutRowName")));
+			CompilerContext.MovePinLinksToIntermediate(*OutputRowPin, *SelectFuncOutputRowPin);
+			ChainThenPin = SelectFuncThenPin;
 		}
 		break;
 	}
@@ -231,6 +198,8 @@ void UK2Node_RandomSelect::ExpandNode(FKismetCompilerContext& CompilerContext, U
 		CompilerContext.MovePinLinksToIntermediate(*StreamPin, *SelectFuncStreamPin);
 	}
 
+	CommonDeveloperUtils::ExpandWithCallSiteTracking(CompilerContext, SourceGraph, this, ChainExecPin, ChainThenPin);
+
 	BreakAllNodeLinks();
 }
 
@@ -326,6 +295,10 @@ void UK2Node_RandomSelect::PinConnectionListChanged(UEdGraphPin* Pin)
 			CommonDeveloperUtils::OnPinConnectionUpdatedWithCategoryInfoSync(OutputKeyPin, InputPin);
 		}
 	}
+	else if (CurrentFormat == EFenixSelectorInputFormat::DataTable && (Pin == GetInputPin() || Pin == GetOutputRowPin()))
+	{
+		RefreshOutputRowPinType();
+	}
 }
 
 void UK2Node_RandomSelect::PostReconstructNode()
@@ -343,6 +316,10 @@ void UK2Node_RandomSelect::PostReconstructNode()
 			CommonDeveloperUtils::PostPinConnectionReconstructionWithCategoryInfoSync(OutputKeyPin, InputPin);
 		}
 	}
+	else if (CurrentFormat == EFenixSelectorInputFormat::DataTable)
+	{
+		RefreshOutputRowPinType();
+	}
 }
 
 void UK2Node_RandomSelect::CreateInOutPins()
@@ -460,6 +437,8 @@ void UK2Node_RandomSelect::CreateInOutPins()
 		break;
 	case EFenixSelectorInputFormat::DataTable:
 		CreatePin(EGPD_Output, UEdGraphSchema_K2::PC_Name, PIN_NAME_SELECTED_ROW_NAME);
+		CreatePin(EGPD_Output, UEdGraphSchema_K2::PC_Wildcard, PIN_NAME_SELECTED_ROW);
+		RefreshOutputRowPinType();
 		break;
 	}
 }
@@ -695,6 +674,15 @@ void UK2Node_RandomSelect::OnFormatPinUpdated(UEdGraphPin* ChangedPin)
 
 	// Output pins
 	UEdGraphPin* OutputKeyPin = GetOutputKeyPin();
+	UEdGraphPin* OutputRowPin = GetOutputRowPin();
+	if (OutputRowPin && NewFormat != EFenixSelectorInputFormat::DataTable)
+	{
+		if (!OutputRowPin->SubPins.IsEmpty())
+		{
+			GetSchema()->RecombinePin(OutputRowPin->SubPins[0]);
+		}
+		RemovePin(OutputRowPin);
+	}
 	switch (NewFormat)
 	{
 	case EFenixSelectorInputFormat::Array:
@@ -731,11 +719,16 @@ void UK2Node_RandomSelect::OnFormatPinUpdated(UEdGraphPin* ChangedPin)
 			OutputKeyPin->PinName = PIN_NAME_SELECTED_ROW_NAME;
 			CommonDeveloperUtils::ChangePinCategoryToName(OutputKeyPin->PinType);
 		}
+		if (!OutputRowPin)
+		{
+			CreatePin(EGPD_Output, UEdGraphSchema_K2::PC_Wildcard, PIN_NAME_SELECTED_ROW);
+		}
 		break;
 	}
 
 	// Update format cache
 	CurrentFormat = NewFormat;
+	RefreshOutputRowPinType();
 
 	// Mark dirty/modified
 	CachedToolTip.MarkDirty();
@@ -844,6 +837,15 @@ void UK2Node_RandomSelect::OnUseCookedInputPinUpdated(UEdGraphPin* ChangedPin)
 		}
 		RemovePin(OutputKeyPin);
 	}
+	UEdGraphPin* OutputRowPin = GetOutputRowPin();
+	if (OutputRowPin)
+	{
+		if (!OutputRowPin->SubPins.IsEmpty())
+		{
+			GetSchema()->RecombinePin(OutputRowPin->SubPins[0]);
+		}
+		RemovePin(OutputRowPin);
+	}
 
 	// Update the use cooked input flag and set format to be array
 	bUseCookedInput = bNewUseCookedInput;
@@ -903,6 +905,8 @@ void UK2Node_RandomSelect::OnInputPinUpdated(UEdGraphPin* ChangedPin)
 	{
 	case EFenixSelectorInputFormat::DataTable:
 		DataTable = ChangedPin->DefaultObject;
+		RefreshOutputRowPinType();
+		GetGraph()->NotifyGraphChanged();
 		break;
 	}
 }
@@ -928,6 +932,44 @@ void UK2Node_RandomSelect::OnDataTableIsProbNamePinUpdated(UEdGraphPin* ChangedP
 	IsProbPropertyName = ChangedPin->DefaultValue;
 }
 
+void UK2Node_RandomSelect::RefreshOutputRowPinType()
+{
+	UEdGraphPin* OutputRowPin = GetOutputRowPin();
+	if (!OutputRowPin)
+	{
+		return;
+	}
+
+	UScriptStruct* RowStruct = nullptr;
+	UEdGraphPin* InputPin = GetInputPin();
+	if (InputPin && InputPin->LinkedTo.IsEmpty())
+	{
+		if (const UDataTable* InputDataTable = Cast<UDataTable>(InputPin->DefaultObject))
+		{
+			RowStruct = const_cast<UScriptStruct*>(InputDataTable->GetRowStruct());
+		}
+	}
+	if (!RowStruct && !OutputRowPin->LinkedTo.IsEmpty())
+	{
+		const FEdGraphPinType& NeighborPinType = OutputRowPin->LinkedTo[0]->PinType;
+		if (NeighborPinType.PinCategory == UEdGraphSchema_K2::PC_Struct)
+		{
+			RowStruct = Cast<UScriptStruct>(NeighborPinType.PinSubCategoryObject.Get());
+		}
+	}
+
+	if (RowStruct)
+	{
+		OutputRowPin->PinType.PinCategory = UEdGraphSchema_K2::PC_Struct;
+		OutputRowPin->PinType.PinSubCategory = NAME_None;
+		OutputRowPin->PinType.PinSubCategoryObject = RowStruct;
+	}
+	else if (OutputRowPin->LinkedTo.IsEmpty())
+	{
+		CommonDeveloperUtils::ChangePinCategoryToWildcard(OutputRowPin->PinType);
+	}
+}
+
 FText UK2Node_RandomSelect::GetCurrentTooltip() const
 {
 	FText FormatString = FText::FromString("{0}{1}{2}.");
@@ -977,7 +1019,7 @@ FText UK2Node_RandomSelect::GetCurrentTooltip() const
 			Arg1 = FText::FromString("map");
 			break;
 		case EFenixSelectorInputFormat::DataTable:
-			Arg0 = FText::FromString("index and row name");
+			Arg0 = FText::FromString("index, row name and row");
 			Arg1 = FText::FromString("data table");
 			break;
 		}
@@ -1097,3 +1139,8 @@ UEdGraphPin* UK2Node_RandomSelect::GetOutputKeyPin()
 	}
 	return nullptr;
 }
+
+UEdGraphPin* UK2Node_RandomSelect::GetOutputRowPin()
+{
+	return CurrentFormat == EFenixSelectorInputFormat::DataTable ? FindPin(PIN_NAME_SELECTED_ROW) : nullptr;
+}
@@ -20,6 +20,9 @@
 #define PIN_NAME_CUM_WEIGHTS (TEXT("CumWeights"))
 #define PIN_NAME_CUM_PROBS (TEXT("CumProbs"))
 #define PIN_NAME_COOKED_DISTRIBUTION (TEXT("CookedDistribution"))
+#define PIN_NAME_COOK_SMALL (TEXT("CookSmall"))
+#define PIN_NAME_SMALL_DISTRIBUTION (TEXT("SmallDistribution"))
+#define PIN_NAME_FITS_SMALL (TEXT("FitsSmall"))
 #define PIN_NAME_KEYS (TEXT("Keys"))
 #define PIN_NAME_ROW_NAMES (TEXT("RowNames"))
 #define PIN_NAME_USE_COOKED_INPUT (TEXT("UseCookedInput"))
@@ -28,6 +31,7 @@
 #define PIN_NAME_SELECTED_INEX (TEXT("SelectedIndex"))
 #define PIN_NAME_SELECTED_KEY (TEXT("SelectedKey"))
 #define PIN_NAME_SELECTED_ROW_NAME (TEXT("SelectedRowName"))
+#define PIN_NAME_SELECTED_ROW (TEXT("SelectedRow"))
 
 UENUM(BlueprintType)
 enum class EFenixSelectorInputDataType : uint8
@@ -4,6 +4,10 @@
 
 #include "CoreMinimal.h"
 
+class FKismetCompilerContext;
+class UEdGraph;
+class UK2Node;
+
 /**
  * 
  */
@@ -51,4 +55,13 @@ public:
 
 	/** Return whether pin info is updated (e.g. if the Pin has no connection then there's nothing to update). */
 	static bool PostPinConnectionReconstructionWithCategoryInfoSync(UEdGraphPin* Pin, UEdGraphPin* SyncedPin);
+
+	/** Stable call site name of a node being expanded, made of the owning blueprint path, the graph name and the node guid. */
+	static FName MakeCallSiteName(const FKismetCompilerContext& CompilerContext, UK2Node* Node);
+
+	/**
+	* Wrap an expanded chain of intermediate nodes with call site tracking: Exec -> BeginCallSite -> Chain -> EndCallSite -> Then.
+	* Moves the links of the exec and then pins of Node, so the chain pins must not have been linked to them.
+	*/
+	static void ExpandWithCallSiteTracking(FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph, UK2Node* Node, UEdGraphPin* ChainExecPin, UEdGraphPin* ChainThenPin);
 };
@@ -36,10 +36,18 @@ class FENIXSTOCHASTICUTILSDEVELOPER_API UK2Node_CookSelectorInput : public UK2No
 
 	void CreateInOutPins();
 
+	void CreateCookSmallPin();
+
+	void CreateSmallDistributionPins();
+
+	void RemoveSmallDistributionPins();
+
 	void OnDataTypePinUpdated(UEdGraphPin* ChangedPin);
 
 	void OnFormatPinUpdated(UEdGraphPin* ChangedPin);
 
+	void OnCookSmallPinUpdated(UEdGraphPin* ChangedPin);
+
 	void OnInputPinUpdated(UEdGraphPin* ChangedPin);
 
 	void OnDataTableWeightOrProbNamePinUpdated(UEdGraphPin* ChangedPin);
@@ -52,6 +60,8 @@ class FENIXSTOCHASTICUTILSDEVELOPER_API UK2Node_CookSelectorInput : public UK2No
 
 	UEdGraphPin* GetFormatPin();
 
+	UEdGraphPin* GetCookSmallPin();
+
 	UEdGraphPin* GetInputPin();
 
 	UEdGraphPin* GetInputDataTableWeightOrProbNamePin();
@@ -62,6 +72,10 @@ class FENIXSTOCHASTICUTILSDEVELOPER_API UK2Node_CookSelectorInput : public UK2No
 
 	UEdGraphPin* GetOutputKeysPin();
 
+	UEdGraphPin* GetOutputSmallDistributionPin();
+
+	UEdGraphPin* GetOutputFitsSmallPin();
+
 	FNodeTextCache CachedToolTip;
 
 	UPROPERTY()  // Need to store this in asset, plus need to use this in ExpandNode for the temporary node copy.
@@ -70,6 +84,9 @@ class FENIXSTOCHASTICUTILSDEVELOPER_API UK2Node_CookSelectorInput : public UK2No
 	UPROPERTY()  // Need to store this in asset, plus need to use this in ExpandNode for the temporary node copy.
 	EFenixSelectorInputFormat CurrentFormat = EFenixSelectorInputFormat::Array;
 
+	UPROPERTY()  // Need to store this in asset, plus need to use this in ExpandNode for the temporary node copy.
+	bool bCookSmall = false;
+
 	UPROPERTY()  // Store this in asset for maintaining history/preference.
 	TObjectPtr<UObject> DataTable;
 
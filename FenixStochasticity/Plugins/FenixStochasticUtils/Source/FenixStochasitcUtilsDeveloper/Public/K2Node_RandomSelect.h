@@ -51,6 +51,9 @@ class FENIXSTOCHASTICUTILSDEVELOPER_API UK2Node_RandomSelect : public UK2Node
 
 	void OnDataTableIsProbNamePinUpdated(UEdGraphPin* ChangedPin);
 
+	/** Type the selected row output from the row struct of the data table default, or else from its connection (wildcard if neither). */
+	void RefreshOutputRowPinType();
+
 	FText GetCurrentTooltip() const;
 
 	UEdGraphPin* GetDataTypePin();
@@ -73,6 +76,8 @@ class FENIXSTOCHASTICUTILSDEVELOPER_API UK2Node_RandomSelect : public UK2Node
 
 	UEdGraphPin* GetOutputKeyPin();
 
+	UEdGraphPin* GetOutputRowPin();
+
 	FNodeTextCache CachedToolTip;
 
 	UPROPERTY()  // Need to store this in asset, plus need to use this in ExpandNode for the temporary node copy.
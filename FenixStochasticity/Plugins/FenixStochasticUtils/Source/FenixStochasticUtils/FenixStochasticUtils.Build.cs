@@ -36,6 +36,8 @@ public class FenixStochasticUtils : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"Json",
+				"NavigationSystem",
 				"Slate",
 				"SlateCore",
 				// ... add private dependencies that you statically link with here ...	
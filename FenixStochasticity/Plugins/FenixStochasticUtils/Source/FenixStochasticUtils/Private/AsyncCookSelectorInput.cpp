@@ -0,0 +1,83 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+
+#include "AsyncCookSelectorInput.h"
+#include "SelectorAuditLog.h"
+#include "Async/Async.h"
+#include "Tasks/Task.h"
+
+UAsyncCookSelectorInput* UAsyncCookSelectorInput::CookWeightsAsync(UObject* WorldContextObject, const TArray<double>& Weights, const bool bBuildAliasTable)
+{
+	UAsyncCookSelectorInput* Action = CreateAction(WorldContextObject, ESelectorCookInputType::Weights, bBuildAliasTable);
+	Action->Values = Weights;
+	return Action;
+}
+
+UAsyncCookSelectorInput* UAsyncCookSelectorInput::CookProbsAsync(UObject* WorldContextObject, const TArray<double>& Probs, const bool bBuildAliasTable)
+{
+	UAsyncCookSelectorInput* Action = CreateAction(WorldContextObject, ESelectorCookInputType::Probs, bBuildAliasTable);
+	Action->Values = Probs;
+	return Action;
+}
+
+UAsyncCookSelectorInput* UAsyncCookSelectorInput::CookWeightOrProbEntriesAsync(UObject* WorldContextObject, const TArray<FWeightOrProbEntry>& Entries, const bool bBuildAliasTable)
+{
+	UAsyncCookSelectorInput* Action = CreateAction(WorldContextObject, ESelectorCookInputType::WeightOrProbEntries, bBuildAliasTable);
+	Action->Entries = Entries;
+	return Action;
+}
+
+UAsyncCookSelectorInput* UAsyncCookSelectorInput::CreateAction(UObject* WorldContextObject, const ESelectorCookInputType InInputType, const bool bInBuildAliasTable)
+{
+	UAsyncCookSelectorInput* Action = NewObject<UAsyncCookSelectorInput>();
+	Action->InputType = InInputType;
+	Action->bBuildAliasTable = bInBuildAliasTable;
+	Action->RegisterWithGameInstance(WorldContextObject);  // kept alive until SetReadyToDestroy
+	return Action;
+}
+
+void UAsyncCookSelectorInput::Activate()
+{
+	struct FCookResult
+	{
+		FCookedSelectorDistribution Distribution;
+		FCookedAliasTable AliasTable;
+	};
+
+	TWeakObjectPtr<UAsyncCookSelectorInput> WeakAction(this);
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakAction, InputType = InputType, bBuildAliasTable = bBuildAliasTable, Values = MoveTemp(Values), Entries = MoveTemp(Entries)]()
+	{
+		TSharedRef<FCookResult, ESPMode::ThreadSafe> Result = MakeShared<FCookResult, ESPMode::ThreadSafe>();
+		Cook(InputType, Values, Entries, bBuildAliasTable, Result->Distribution, Result->AliasTable);
+
+		AsyncTask(ENamedThreads::GameThread, [WeakAction, Result]()
+		{
+			if (UAsyncCookSelectorInput* Action = WeakAction.Get())
+			{
+				Action->OnCompleted.Broadcast(Result->Distribution, Result->AliasTable);
+				Action->SetReadyToDestroy();
+			}
+		});
+	});
+}
+
+void UAsyncCookSelectorInput::Cook(const ESelectorCookInputType InputType, const TArray<double>& Values, const TArray<FWeightOrProbEntry>& Entries, const bool bBuildAliasTable,
+	FCookedSelectorDistribution& OutDistribution, FCookedAliasTable& OutAliasTable)
+{
+	if (InputType == ESelectorCookInputType::WeightOrProbEntries)
+	{
+		USelectorUtils::CookSelectorDistribution(Entries, OutDistribution);
+	}
+	else
+	{
+		USelectorUtils::MakeCumulatives(Values, OutDistribution.CumWeightsOrCumProbs);
+		OutDistribution.bIsProbs = InputType == ESelectorCookInputType::Probs;
+		OutDistribution.TableId = static_cast<int32>(FSelectorAuditLog::MakeTableId(OutDistribution.CumWeightsOrCumProbs));
+		USelectorUtils::BuildGuideTable(OutDistribution, 0);  // any previous guide table was for other cumulatives
+	}
+
+	if (bBuildAliasTable)
+	{
+		USelectorUtils::CookAliasTableFromDistribution(OutDistribution, OutAliasTable);
+	}
+}
@@ -0,0 +1,110 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+
+#include "AsyncSimulateSelectorPulls.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Misc/ScopeLock.h"
+#include "Tasks/Task.h"
+
+UAsyncSimulateSelectorPulls* UAsyncSimulateSelectorPulls::SimulateSelectorPullsAsync(UObject* WorldContextObject, const FCookedSelectorDistribution& Distribution, const int64 NumPulls, const int32 Seed)
+{
+	UAsyncSimulateSelectorPulls* Action = NewObject<UAsyncSimulateSelectorPulls>();
+	Action->Simulation = MakeShared<FSimulation, ESPMode::ThreadSafe>();
+	Action->Simulation->NumPulls = FMath::Max(NumPulls, static_cast<int64>(0));
+	Action->Simulation->Seed = Seed;
+	Action->Simulation->Counts.SetNumZeroed(Distribution.CumWeightsOrCumProbs.Num());
+	USelectorUtils::CookAliasTableFromDistribution(Distribution, Action->Simulation->AliasTable);  // O(entries), selecting the same as the distribution in O(1)
+	Action->RegisterWithGameInstance(WorldContextObject);  // kept alive until SetReadyToDestroy
+	return Action;
+}
+
+void UAsyncSimulateSelectorPulls::Cancel()
+{
+	if (Simulation)
+	{
+		Simulation->bCancelled.store(true);
+	}
+	SetReadyToDestroy();
+}
+
+void UAsyncSimulateSelectorPulls::Activate()
+{
+	TWeakObjectPtr<UAsyncSimulateSelectorPulls> WeakAction(this);
+	TSharedPtr<FSimulation, ESPMode::ThreadSafe> SharedSimulation = Simulation;
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakAction, SharedSimulation]()
+	{
+		FSimulation& Sim = *SharedSimulation;
+		const int64 NumBatches = (Sim.NumPulls + PullsPerBatch - 1) / PullsPerBatch;
+		const int64 ProgressStep = FMath::Max(Sim.NumPulls / 100, static_cast<int64>(1));
+		ParallelFor(static_cast<int32>(NumBatches), [&Sim, &WeakAction, ProgressStep](const int32 BatchIdx)
+		{
+			if (Sim.bCancelled.load(std::memory_order_relaxed))
+			{
+				return;
+			}
+			const int64 NumPullsInBatch = RunBatch(Sim, BatchIdx);
+			const int64 NumPullsDone = Sim.NumPullsDone.fetch_add(NumPullsInBatch) + NumPullsInBatch;
+			if ((NumPullsDone - NumPullsInBatch) / ProgressStep != NumPullsDone / ProgressStep)  // crossed a percent
+			{
+				AsyncTask(ENamedThreads::GameThread, [WeakAction, NumPullsDone]()
+				{
+					if (UAsyncSimulateSelectorPulls* Action = WeakAction.Get())
+					{
+						Action->ReportProgress(NumPullsDone);
+					}
+				});
+			}
+		});
+
+		AsyncTask(ENamedThreads::GameThread, [WeakAction, SharedSimulation]()
+		{
+			UAsyncSimulateSelectorPulls* Action = WeakAction.Get();
+			if (Action && !SharedSimulation->bCancelled.load())
+			{
+				Action->OnCompleted.Broadcast(SharedSimulation->Counts, SharedSimulation->NumFailures);
+				Action->SetReadyToDestroy();
+			}
+		});
+	});
+}
+
+int64 UAsyncSimulateSelectorPulls::RunBatch(FSimulation& Simulation, const int64 BatchIdx)
+{
+	const int64 NumPullsInBatch = FMath::Min(PullsPerBatch, Simulation.NumPulls - BatchIdx * PullsPerBatch);
+	const FRandomStream RandomStream(static_cast<int32>(HashCombine(GetTypeHash(Simulation.Seed), GetTypeHash(BatchIdx))));
+	const int32 NumEntries = Simulation.Counts.Num();
+
+	TArray<int64> BatchCounts;
+	BatchCounts.SetNumZeroed(NumEntries + 1);  // the last for failures
+	if (Simulation.AliasTable.Thresholds.Num() > 0)
+	{
+		for (int64 Pull = 0; Pull < NumPullsInBatch; Pull++)
+		{
+			const int32 Selected = USelectorUtils::SelectWithAliasTableUnchecked(Simulation.AliasTable, &RandomStream);
+			BatchCounts[Selected >= 0 ? Selected : NumEntries]++;
+		}
+	}
+	else
+	{
+		BatchCounts[NumEntries] = NumPullsInBatch;
+	}
+
+	FScopeLock ScopeLock(&Simulation.CountsLock);
+	for (int32 Idx = 0; Idx < NumEntries; Idx++)
+	{
+		Simulation.Counts[Idx] += BatchCounts[Idx];
+	}
+	Simulation.NumFailures += BatchCounts[NumEntries];
+	return NumPullsInBatch;
+}
+
+void UAsyncSimulateSelectorPulls::ReportProgress(const int64 NumPullsDone)
+{
+	if (NumPullsDone <= LastReportedPulls || Simulation->bCancelled.load())  // the progress tasks of different workers may arrive out of order
+	{
+		return;
+	}
+	LastReportedPulls = NumPullsDone;
+	OnProgress.Broadcast(NumPullsDone, Simulation->NumPulls > 0 ? static_cast<float>(static_cast<double>(NumPullsDone) / Simulation->NumPulls) : 1.0f);
+}
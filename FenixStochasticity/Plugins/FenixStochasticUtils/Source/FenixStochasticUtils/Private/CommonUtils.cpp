@@ -2,6 +2,7 @@
 
 
 #include "CommonUtils.h"
+#include "FenixStochasticStats.h"
 #include "Engine/DataTable.h"
 
 int32 UCommonUtils::BinarySearchForInsertion(const double TargetKey, const TArray<double>& IncreasingKeys)
@@ -15,8 +16,26 @@ void UCommonUtils::Array_Get_Impure(const TArray<int32>& TargetArray, const int3
 	check(0);
 }
 
+void UCommonUtils::Map_KeysAndValues(const TMap<int32, int32>& TargetMap, TArray<int32>& Keys, TArray<int32>& Values)
+{
+	// We should never hit these!  They're stubs to avoid NoExport on the class.  Call the Generic* equivalent instead
+	check(0);
+}
+
+void UCommonUtils::GenericMap_KeysAndValues(const void* TargetMap, const FMapProperty* MapProperty, const void* KeysArray, const FArrayProperty* KeysArrayProperty, const void* ValuesArray, const FArrayProperty* ValuesArrayProperty)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixMapExtraction);
+	INC_DWORD_STAT(STAT_FenixMapExtractionCalls);
+
+	UBlueprintMapLibrary::GenericMap_Keys(TargetMap, MapProperty, KeysArray, KeysArrayProperty);
+	UBlueprintMapLibrary::GenericMap_Values(TargetMap, MapProperty, ValuesArray, ValuesArrayProperty);
+}
+
 void UCommonUtils::GetDataTableColumnAsFloats(const UDataTable* DataTable, const FName PropertyName, TArray<double>& OutValues)
 {
+	SCOPE_CYCLE_COUNTER(STAT_FenixDataTableExtraction);
+	INC_DWORD_STAT(STAT_FenixDataTableExtractionCalls);
+
 	OutValues.Empty();
 	if (DataTable && PropertyName != NAME_None)
 	{
@@ -37,6 +56,9 @@ void UCommonUtils::GetDataTableColumnAsFloats(const UDataTable* DataTable, const
 
 void UCommonUtils::GetDataTableColumnAsInts(const UDataTable* DataTable, const FName PropertyName, TArray<int32>& OutValues)
 {
+	SCOPE_CYCLE_COUNTER(STAT_FenixDataTableExtraction);
+	INC_DWORD_STAT(STAT_FenixDataTableExtractionCalls);
+
 	OutValues.Empty();
 	if (DataTable && PropertyName != NAME_None)
 	{
@@ -57,6 +79,9 @@ void UCommonUtils::GetDataTableColumnAsInts(const UDataTable* DataTable, const F
 
 void UCommonUtils::GetDataTableColumnAsBools(const UDataTable* DataTable, const FName PropertyName, TArray<bool>& OutValues)
 {
+	SCOPE_CYCLE_COUNTER(STAT_FenixDataTableExtraction);
+	INC_DWORD_STAT(STAT_FenixDataTableExtractionCalls);
+
 	OutValues.Empty();
 	if (DataTable && PropertyName != NAME_None)
 	{
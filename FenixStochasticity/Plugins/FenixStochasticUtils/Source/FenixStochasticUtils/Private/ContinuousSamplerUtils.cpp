@@ -0,0 +1,503 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+
+#include "ContinuousSamplerUtils.h"
+#include "CommonUtils.h"
+#include "FenixStochasticStats.h"
+#include "SelectorCallSiteUtils.h"
+
+namespace
+{
+	constexpr int32 NumNormalLayers = 128;
+	constexpr double NormalTailStart = 3.442619855899;
+	constexpr double NormalLayerArea = 9.91256303526217e-3;
+
+	constexpr int32 NumExponentialLayers = 256;
+	constexpr double ExponentialTailStart = 7.69711747013104972;
+	constexpr double ExponentialLayerArea = 3.949659822581572e-3;
+
+	/**
+	* Ziggurat layers of equal area under the (unnormalized) densities: right edges X, densities F at the edges, and the ratios of each edge to the one below,
+	* under which a point of the layer is inside the density for sure. Layer 0 is the base strip including the tail.
+	*/
+	struct FZigguratTables
+	{
+		double NormalX[NumNormalLayers + 1];
+		double NormalF[NumNormalLayers + 1];
+		double NormalRatios[NumNormalLayers];
+
+		double ExponentialX[NumExponentialLayers + 1];
+		double ExponentialF[NumExponentialLayers + 1];
+		double ExponentialRatios[NumExponentialLayers];
+
+		FZigguratTables()
+		{
+			NormalX[0] = NormalLayerArea / FMath::Exp(-0.5 * NormalTailStart * NormalTailStart);
+			NormalX[1] = NormalTailStart;
+			for (int32 Layer = 1; Layer < NumNormalLayers - 1; Layer++)
+			{
+				NormalX[Layer + 1] = FMath::Sqrt(-2.0 * FMath::Loge(NormalLayerArea / NormalX[Layer] + FMath::Exp(-0.5 * NormalX[Layer] * NormalX[Layer])));
+			}
+			NormalX[NumNormalLayers] = 0.0;
+			for (int32 Layer = 0; Layer <= NumNormalLayers; Layer++)
+			{
+				NormalF[Layer] = FMath::Exp(-0.5 * NormalX[Layer] * NormalX[Layer]);
+			}
+			for (int32 Layer = 0; Layer < NumNormalLayers; Layer++)
+			{
+				NormalRatios[Layer] = NormalX[Layer + 1] / NormalX[Layer];
+			}
+
+			ExponentialX[0] = ExponentialLayerArea / FMath::Exp(-ExponentialTailStart);
+			ExponentialX[1] = ExponentialTailStart;
+			for (int32 Layer = 1; Layer < NumExponentialLayers - 1; Layer++)
+			{
+				ExponentialX[Layer + 1] = -FMath::Loge(ExponentialLayerArea / ExponentialX[Layer] + FMath::Exp(-ExponentialX[Layer]));
+			}
+			ExponentialX[NumExponentialLayers] = 0.0;
+			for (int32 Layer = 0; Layer <= NumExponentialLayers; Layer++)
+			{
+				ExponentialF[Layer] = FMath::Exp(-ExponentialX[Layer]);
+			}
+			for (int32 Layer = 0; Layer < NumExponentialLayers; Layer++)
+			{
+				ExponentialRatios[Layer] = ExponentialX[Layer + 1] / ExponentialX[Layer];
+			}
+		}
+	};
+
+	const FZigguratTables ZigguratTables;
+
+	/** Uniform in (0, 1] from the upper 24 bits, safe for logarithms. */
+	FORCEINLINE double UniformOpenFromBits(const uint32 Bits)
+	{
+		return ((Bits >> 8) + 1) * (1.0 / 16777216.0);
+	}
+
+	/**
+	* Ziggurat layer from the top bits, which are the well mixed ones of a raw LCG state such as FRandomStream's (its low bits have short periods).
+	* The fraction within the layer is taken from the lower 24 bits.
+	*/
+	FORCEINLINE int32 NormalLayerFromBits(const uint32 Bits)
+	{
+		return static_cast<int32>(Bits >> (32 - 7));
+	}
+
+	FORCEINLINE int32 ExponentialLayerFromBits(const uint32 Bits)
+	{
+		return static_cast<int32>(Bits >> (32 - 8));
+	}
+
+	/** Uniform in [-1, 1) from the lower 24 bits, the upper ones selecting the layer. */
+	FORCEINLINE double SignedUniformFromBits(const uint32 Bits)
+	{
+		return (Bits & 0xFFFFFFu) * (1.0 / 8388608.0) - 1.0;
+	}
+
+	/** Uniform in [0, 1) from the lower 24 bits, the upper ones selecting the layer. */
+	FORCEINLINE double UniformFromBits(const uint32 Bits)
+	{
+		return (Bits & 0xFFFFFFu) * (1.0 / 16777216.0);
+	}
+
+	/** Random bits of a stream, or of the global random state. */
+	struct FStreamBitsSource
+	{
+		const FRandomStream* RandomStream;
+
+		FORCEINLINE uint32 operator()() const { return UCommonUtils::RandBitsMaybeWithStream(RandomStream); }
+	};
+
+	/**
+	* Random bits of 8 lanes generated in lockstep: a 32 bit LCG per lane (with its own increment, so lanes are different sequences) and a Murmur3 finalizer as output permutation.
+	* The lanes are plain loops over fixed size arrays of integer multiplies and shifts, which the compiler vectorizes.
+	*/
+	class FLaneBitsSource
+	{
+	public:
+		static constexpr int32 NumLanes = 8;
+
+		explicit FLaneBitsSource(const FRandomStream* RandomStream)
+		{
+			for (int32 Lane = 0; Lane < NumLanes; Lane++)
+			{
+				States[Lane] = UCommonUtils::RandBitsMaybeWithStream(RandomStream);
+				Increments[Lane] = UCommonUtils::RandBitsMaybeWithStream(RandomStream) | 1u;
+			}
+		}
+
+		FORCEINLINE void NextLanes(uint32 (&OutBits)[NumLanes])
+		{
+			for (int32 Lane = 0; Lane < NumLanes; Lane++)
+			{
+				States[Lane] = States[Lane] * 1664525u + Increments[Lane];
+				uint32 Hash = States[Lane];
+				Hash ^= Hash >> 16;
+				Hash *= 0x85EBCA6Bu;
+				Hash ^= Hash >> 13;
+				Hash *= 0xC2B2AE35u;
+				Hash ^= Hash >> 16;
+				OutBits[Lane] = Hash;
+			}
+		}
+
+		/** Scalar access for the slow paths, buffering one step of all the lanes. */
+		FORCEINLINE uint32 operator()()
+		{
+			if (NumBuffered == 0)
+			{
+				NextLanes(Buffer);
+				NumBuffered = NumLanes;
+			}
+			return Buffer[--NumBuffered];
+		}
+
+	private:
+		uint32 States[NumLanes];
+		uint32 Increments[NumLanes];
+		uint32 Buffer[NumLanes];
+		int32 NumBuffered = 0;
+	};
+
+	/** Standard normal with the Ziggurat method, continuing the attempt started with Bits (so a failed fast path is not biased by a restart). */
+	template <typename FBitsSource>
+	double ZigguratNormalFrom(uint32 Bits, FBitsSource& Source)
+	{
+		for (;;)
+		{
+			const int32 Layer = NormalLayerFromBits(Bits);
+			const double U = SignedUniformFromBits(Bits);
+			if (FMath::Abs(U) < ZigguratTables.NormalRatios[Layer])
+			{
+				return U * ZigguratTables.NormalX[Layer];
+			}
+			if (Layer == 0)  // beyond the tail start, Marsaglia's tail method
+			{
+				double TailX;
+				double TailY;
+				do
+				{
+					TailX = FMath::Loge(UniformOpenFromBits(Source())) / NormalTailStart;
+					TailY = FMath::Loge(UniformOpenFromBits(Source()));
+				}
+				while (-2.0 * TailY < TailX * TailX);
+				return U > 0.0 ? NormalTailStart - TailX : TailX - NormalTailStart;
+			}
+			const double X = U * ZigguratTables.NormalX[Layer];
+			const double FLow = ZigguratTables.NormalF[Layer];
+			if (FLow + UniformOpenFromBits(Source()) * (ZigguratTables.NormalF[Layer + 1] - FLow) < FMath::Exp(-0.5 * X * X))
+			{
+				return X;
+			}
+			Bits = Source();
+		}
+	}
+
+	/** Standard exponential with the Ziggurat method, continuing the attempt started with Bits. */
+	template <typename FBitsSource>
+	double ZigguratExponentialFrom(uint32 Bits, FBitsSource& Source)
+	{
+		for (;;)
+		{
+			const int32 Layer = ExponentialLayerFromBits(Bits);
+			const double U = UniformFromBits(Bits);
+			if (U < ZigguratTables.ExponentialRatios[Layer])
+			{
+				return U * ZigguratTables.ExponentialX[Layer];
+			}
+			if (Layer == 0)  // memoryless beyond the tail start
+			{
+				return ExponentialTailStart - FMath::Loge(UniformOpenFromBits(Source()));
+			}
+			const double X = U * ZigguratTables.ExponentialX[Layer];
+			const double FLow = ZigguratTables.ExponentialF[Layer];
+			if (FLow + UniformOpenFromBits(Source()) * (ZigguratTables.ExponentialF[Layer + 1] - FLow) < FMath::Exp(-X))
+			{
+				return X;
+			}
+			Bits = Source();
+		}
+	}
+
+	/** Gamma with scale 1 and a positive shape, Marsaglia and Tsang's method (boosted by a uniform power below shape 1). */
+	template <typename FBitsSource>
+	double MarsagliaTsangGamma(const double Shape, FBitsSource& Source)
+	{
+		if (Shape < 1.0)
+		{
+			return MarsagliaTsangGamma(Shape + 1.0, Source) * FMath::Pow(UniformOpenFromBits(Source()), 1.0 / Shape);
+		}
+
+		const double D = Shape - 1.0 / 3.0;
+		const double C = 1.0 / FMath::Sqrt(9.0 * D);
+		for (;;)
+		{
+			double X;
+			double V;
+			do
+			{
+				X = ZigguratNormalFrom(Source(), Source);
+				V = 1.0 + C * X;
+			}
+			while (V <= 0.0);
+			V = V * V * V;
+			const double U = UniformOpenFromBits(Source());
+			const double XSquared = X * X;
+			if (U < 1.0 - 0.0331 * XSquared * XSquared  // squeeze, accepting most without logarithms
+				|| FMath::Loge(U) < 0.5 * XSquared + D * (1.0 - V + FMath::Loge(V)))
+			{
+				return D * V;
+			}
+		}
+	}
+
+	template <typename FBitsSource>
+	double BetaFromGammas(const double Alpha, const double Beta, FBitsSource& Source)
+	{
+		const double X = MarsagliaTsangGamma(Alpha, Source);
+		const double Y = MarsagliaTsangGamma(Beta, Source);
+		const double Sum = X + Y;
+		if (Sum > 0.0)
+		{
+			return X / Sum;
+		}
+		return UniformOpenFromBits(Source()) * (Alpha + Beta) <= Alpha ? 1.0 : 0.0;  // both underflowed with tiny shapes, where the mass is at the ends
+	}
+
+	void FillStandardNormal(TArrayView<double> OutValues, FLaneBitsSource& Lanes)
+	{
+		constexpr int32 NumLanes = FLaneBitsSource::NumLanes;
+		const int32 Num = OutValues.Num();
+		uint32 Bits[NumLanes];
+		double Values[NumLanes];
+		bool bAccepted[NumLanes];
+		int32 Idx = 0;
+		for (; Idx + NumLanes <= Num; Idx += NumLanes)
+		{
+			Lanes.NextLanes(Bits);
+			for (int32 Lane = 0; Lane < NumLanes; Lane++)  // fast path of all the lanes, about 99% accepted
+			{
+				const int32 Layer = NormalLayerFromBits(Bits[Lane]);
+				const double U = SignedUniformFromBits(Bits[Lane]);
+				Values[Lane] = U * ZigguratTables.NormalX[Layer];
+				bAccepted[Lane] = FMath::Abs(U) < ZigguratTables.NormalRatios[Layer];
+			}
+			for (int32 Lane = 0; Lane < NumLanes; Lane++)
+			{
+				OutValues[Idx + Lane] = bAccepted[Lane] ? Values[Lane] : ZigguratNormalFrom(Bits[Lane], Lanes);
+			}
+		}
+		for (; Idx < Num; Idx++)
+		{
+			OutValues[Idx] = ZigguratNormalFrom(Lanes(), Lanes);
+		}
+	}
+
+	void FillStandardExponential(TArrayView<double> OutValues, FLaneBitsSource& Lanes)
+	{
+		constexpr int32 NumLanes = FLaneBitsSource::NumLanes;
+		const int32 Num = OutValues.Num();
+		uint32 Bits[NumLanes];
+		double Values[NumLanes];
+		bool bAccepted[NumLanes];
+		int32 Idx = 0;
+		for (; Idx + NumLanes <= Num; Idx += NumLanes)
+		{
+			Lanes.NextLanes(Bits);
+			for (int32 Lane = 0; Lane < NumLanes; Lane++)
+			{
+				const int32 Layer = ExponentialLayerFromBits(Bits[Lane]);
+				const double U = UniformFromBits(Bits[Lane]);
+				Values[Lane] = U * ZigguratTables.ExponentialX[Layer];
+				bAccepted[Lane] = U < ZigguratTables.ExponentialRatios[Layer];
+			}
+			for (int32 Lane = 0; Lane < NumLanes; Lane++)
+			{
+				OutValues[Idx + Lane] = bAccepted[Lane] ? Values[Lane] : ZigguratExponentialFrom(Bits[Lane], Lanes);
+			}
+		}
+		for (; Idx < Num; Idx++)
+		{
+			OutValues[Idx] = ZigguratExponentialFrom(Lanes(), Lanes);
+		}
+	}
+}
+
+double UContinuousSamplerUtils::BPFunc_SampleNormal(const double Mean, const double StdDev)
+{
+	return SampleNormal(Mean, StdDev);
+}
+
+double UContinuousSamplerUtils::BPFunc_SampleNormalFromStream(const FRandomStream& RandomStream, const double Mean, const double StdDev)
+{
+	return SampleNormal(Mean, StdDev, &RandomStream);
+}
+
+double UContinuousSamplerUtils::BPFunc_SampleExponential(const double Rate)
+{
+	return SampleExponential(Rate);
+}
+
+double UContinuousSamplerUtils::BPFunc_SampleExponentialFromStream(const FRandomStream& RandomStream, const double Rate)
+{
+	return SampleExponential(Rate, &RandomStream);
+}
+
+double UContinuousSamplerUtils::BPFunc_SampleGamma(const double Shape, const double Scale)
+{
+	return SampleGamma(Shape, Scale);
+}
+
+double UContinuousSamplerUtils::BPFunc_SampleGammaFromStream(const FRandomStream& RandomStream, const double Shape, const double Scale)
+{
+	return SampleGamma(Shape, Scale, &RandomStream);
+}
+
+double UContinuousSamplerUtils::BPFunc_SampleBeta(const double Alpha, const double Beta)
+{
+	return SampleBeta(Alpha, Beta);
+}
+
+double UContinuousSamplerUtils::BPFunc_SampleBetaFromStream(const FRandomStream& RandomStream, const double Alpha, const double Beta)
+{
+	return SampleBeta(Alpha, Beta, &RandomStream);
+}
+
+double UContinuousSamplerUtils::BPFunc_SampleLogNormal(const double Mu, const double Sigma)
+{
+	return SampleLogNormal(Mu, Sigma);
+}
+
+double UContinuousSamplerUtils::BPFunc_SampleLogNormalFromStream(const FRandomStream& RandomStream, const double Mu, const double Sigma)
+{
+	return SampleLogNormal(Mu, Sigma, &RandomStream);
+}
+
+double UContinuousSamplerUtils::SampleStandardNormal(const FRandomStream* RandomStream)
+{
+	FStreamBitsSource Source{RandomStream};
+	return ZigguratNormalFrom(Source(), Source);
+}
+
+double UContinuousSamplerUtils::SampleStandardExponential(const FRandomStream* RandomStream)
+{
+	FStreamBitsSource Source{RandomStream};
+	return ZigguratExponentialFrom(Source(), Source);
+}
+
+double UContinuousSamplerUtils::SampleNormal(const double Mean, const double StdDev, const FRandomStream* RandomStream)
+{
+	return StdDev > 0.0 ? Mean + StdDev * SampleStandardNormal(RandomStream) : Mean;
+}
+
+double UContinuousSamplerUtils::SampleExponential(const double Rate, const FRandomStream* RandomStream)
+{
+	return Rate > 0.0 ? SampleStandardExponential(RandomStream) / Rate : 0.0;
+}
+
+double UContinuousSamplerUtils::SampleGamma(const double Shape, const double Scale, const FRandomStream* RandomStream)
+{
+	if (Shape <= 0.0 || Scale <= 0.0)
+	{
+		return 0.0;
+	}
+	FStreamBitsSource Source{RandomStream};
+	return MarsagliaTsangGamma(Shape, Source) * Scale;
+}
+
+double UContinuousSamplerUtils::SampleBeta(const double Alpha, const double Beta, const FRandomStream* RandomStream)
+{
+	if (Alpha <= 0.0 || Beta <= 0.0)
+	{
+		return 0.0;
+	}
+	FStreamBitsSource Source{RandomStream};
+	return BetaFromGammas(Alpha, Beta, Source);
+}
+
+double UContinuousSamplerUtils::SampleLogNormal(const double Mu, const double Sigma, const FRandomStream* RandomStream)
+{
+	return FMath::Exp(SampleNormal(Mu, Sigma, RandomStream));
+}
+
+void UContinuousSamplerUtils::FillNormal(TArrayView<double> OutValues, const double Mean, const double StdDev, const FRandomStream* RandomStream)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixFillContinuousValues);
+	INC_DWORD_STAT_BY(STAT_FenixFilledContinuousValues, OutValues.Num());
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(OutValues.Num());
+
+	if (StdDev <= 0.0)
+	{
+		for (double& Value : OutValues)
+		{
+			Value = Mean;
+		}
+		return;
+	}
+	FLaneBitsSource Lanes(RandomStream);
+	FillStandardNormal(OutValues, Lanes);
+	for (double& Value : OutValues)
+	{
+		Value = Mean + StdDev * Value;
+	}
+}
+
+void UContinuousSamplerUtils::FillExponential(TArrayView<double> OutValues, const double Rate, const FRandomStream* RandomStream)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixFillContinuousValues);
+	INC_DWORD_STAT_BY(STAT_FenixFilledContinuousValues, OutValues.Num());
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(OutValues.Num());
+
+	if (Rate <= 0.0)
+	{
+		for (double& Value : OutValues)
+		{
+			Value = 0.0;
+		}
+		return;
+	}
+	FLaneBitsSource Lanes(RandomStream);
+	FillStandardExponential(OutValues, Lanes);
+	const double Mean = 1.0 / Rate;
+	for (double& Value : OutValues)
+	{
+		Value *= Mean;
+	}
+}
+
+void UContinuousSamplerUtils::FillGamma(TArrayView<double> OutValues, const double Shape, const double Scale, const FRandomStream* RandomStream)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixFillContinuousValues);
+	INC_DWORD_STAT_BY(STAT_FenixFilledContinuousValues, OutValues.Num());
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(OutValues.Num());
+
+	const bool bValid = Shape > 0.0 && Scale > 0.0;
+	FLaneBitsSource Lanes(RandomStream);
+	for (double& Value : OutValues)
+	{
+		Value = bValid ? MarsagliaTsangGamma(Shape, Lanes) * Scale : 0.0;
+	}
+}
+
+void UContinuousSamplerUtils::FillBeta(TArrayView<double> OutValues, const double Alpha, const double Beta, const FRandomStream* RandomStream)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixFillContinuousValues);
+	INC_DWORD_STAT_BY(STAT_FenixFilledContinuousValues, OutValues.Num());
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(OutValues.Num());
+
+	const bool bValid = Alpha > 0.0 && Beta > 0.0;
+	FLaneBitsSource Lanes(RandomStream);
+	for (double& Value : OutValues)
+	{
+		Value = bValid ? BetaFromGammas(Alpha, Beta, Lanes) : 0.0;
+	}
+}
+
+void UContinuousSamplerUtils::FillLogNormal(TArrayView<double> OutValues, const double Mu, const double Sigma, const FRandomStream* RandomStream)
+{
+	FillNormal(OutValues, Mu, Sigma, RandomStream);
+	for (double& Value : OutValues)
+	{
+		Value = FMath::Exp(Value);
+	}
+}
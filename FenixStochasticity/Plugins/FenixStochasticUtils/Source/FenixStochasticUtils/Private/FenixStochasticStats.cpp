@@ -0,0 +1,67 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+
+#include "FenixStochasticStats.h"
+
+DEFINE_STAT(STAT_FenixSelectWithCumWeights);
+DEFINE_STAT(STAT_FenixSelectWithWeights);
+DEFINE_STAT(STAT_FenixSelectWithCumProbs);
+DEFINE_STAT(STAT_FenixSelectWithProbs);
+DEFINE_STAT(STAT_FenixSelectWithCookedDistribution);
+DEFINE_STAT(STAT_FenixSelectWithWeightOrProbEntries);
+DEFINE_STAT(STAT_FenixDataTableExtraction);
+DEFINE_STAT(STAT_FenixMapExtraction);
+DEFINE_STAT(STAT_FenixSelectWithAliasTable);
+DEFINE_STAT(STAT_FenixSampleSurfacePoints);
+DEFINE_STAT(STAT_FenixPoissonDiskSampling);
+DEFINE_STAT(STAT_FenixSampleDensityMap);
+DEFINE_STAT(STAT_FenixFillContinuousValues);
+DEFINE_STAT(STAT_FenixSampleCounts);
+DEFINE_STAT(STAT_FenixShuffle);
+DEFINE_STAT(STAT_FenixWeightedShuffle);
+DEFINE_STAT(STAT_FenixDrawFromShuffleBag);
+DEFINE_STAT(STAT_FenixSelectWithQuantizedDistribution);
+DEFINE_STAT(STAT_FenixSelectWithTickets);
+DEFINE_STAT(STAT_FenixSelectWithSmallDistribution);
+DEFINE_STAT(STAT_FenixSelectWithWeightedSearchTree);
+DEFINE_STAT(STAT_FenixSelectWithCompactDistribution);
+DEFINE_STAT(STAT_FenixSelectWithCategorySelector);
+
+DEFINE_STAT(STAT_FenixMakeCumulatives);
+DEFINE_STAT(STAT_FenixCookSelectorDistribution);
+DEFINE_STAT(STAT_FenixCookAliasTable);
+DEFINE_STAT(STAT_FenixCookSurfaceSampler);
+DEFINE_STAT(STAT_FenixCookDensityMapSampler);
+DEFINE_STAT(STAT_FenixCookShuffleBag);
+DEFINE_STAT(STAT_FenixCookQuantizedDistribution);
+DEFINE_STAT(STAT_FenixCookSmallSelectorDistribution);
+DEFINE_STAT(STAT_FenixCookWeightedSearchTree);
+DEFINE_STAT(STAT_FenixCookCompactDistribution);
+DEFINE_STAT(STAT_FenixCookCategorySelector);
+
+DEFINE_STAT(STAT_FenixEncodeSelectorSaveStates);
+DEFINE_STAT(STAT_FenixDecodeSelectorSaveStates);
+
+DEFINE_STAT(STAT_FenixSelectWithCumWeightsCalls);
+DEFINE_STAT(STAT_FenixSelectWithWeightsCalls);
+DEFINE_STAT(STAT_FenixSelectWithCumProbsCalls);
+DEFINE_STAT(STAT_FenixSelectWithProbsCalls);
+DEFINE_STAT(STAT_FenixSelectWithCookedDistributionCalls);
+DEFINE_STAT(STAT_FenixSelectWithWeightOrProbEntriesCalls);
+DEFINE_STAT(STAT_FenixDataTableExtractionCalls);
+DEFINE_STAT(STAT_FenixMapExtractionCalls);
+DEFINE_STAT(STAT_FenixSelectWithAliasTableCalls);
+DEFINE_STAT(STAT_FenixSampledSurfacePoints);
+DEFINE_STAT(STAT_FenixSampledDensityMapPoints);
+DEFINE_STAT(STAT_FenixFilledContinuousValues);
+DEFINE_STAT(STAT_FenixDrawFromShuffleBagCalls);
+DEFINE_STAT(STAT_FenixSelectWithQuantizedDistributionCalls);
+DEFINE_STAT(STAT_FenixSelectWithTicketsCalls);
+DEFINE_STAT(STAT_FenixSelectWithSmallDistributionCalls);
+DEFINE_STAT(STAT_FenixSelectWithWeightedSearchTreeCalls);
+DEFINE_STAT(STAT_FenixSelectWithCompactDistributionCalls);
+DEFINE_STAT(STAT_FenixSelectWithCategorySelectorCalls);
+DEFINE_STAT(STAT_FenixCookCalls);
+
+DEFINE_STAT(STAT_FenixTempAllocations);
+DEFINE_STAT(STAT_FenixTempAllocatedBytes);
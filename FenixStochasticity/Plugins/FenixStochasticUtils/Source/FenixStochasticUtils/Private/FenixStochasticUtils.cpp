@@ -1,6 +1,7 @@
 // Copyright 2025, Tiannan Chen, All rights reserved.
 
 #include "FenixStochasticUtils.h"
+#include "SelectorAuditLog.h"
 
 #define LOCTEXT_NAMESPACE "FFenixStochasticUtilsModule"
 
@@ -13,6 +14,7 @@ void FFenixStochasticUtilsModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	FSelectorAuditLog::Stop();
 }
 
 #undef LOCTEXT_NAMESPACE
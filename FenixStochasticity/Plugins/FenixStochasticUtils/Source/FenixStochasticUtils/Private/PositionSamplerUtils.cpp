@@ -0,0 +1,747 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+
+#include "PositionSamplerUtils.h"
+#include "FenixStochasticStats.h"
+#include "SelectorCallSiteUtils.h"
+#include "Engine/StaticMesh.h"
+#include "StaticMeshResources.h"
+#include "Engine/Texture2D.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "NavigationSystem.h"
+#include "AI/NavigationSystemBase.h"
+#include "Async/ParallelFor.h"
+#if WITH_RECAST
+#include "NavMesh/RecastNavMesh.h"
+#endif
+
+namespace
+{
+	/** A point of Poisson disk sampling with its own spacing. */
+	struct FPoissonDiskPoint
+	{
+		FVector Position;
+		double Radius = 0.0;  // 0 for an empty grid cell
+	};
+
+	/** Most cells of a Poisson disk background grid (32 bytes each), beyond which the region is rejected rather than allocating gigabytes. */
+	constexpr double MaxPoissonDiskCells = 1 << 24;
+
+	/**
+	* Background grid of Poisson disk sampling. The cell diagonal is the minimum distance, so a cell holds at most one point.
+	* Tiles of the same phase never touch the same cells, so they can write concurrently. Invalid (no cells) if it would exceed MaxPoissonDiskCells.
+	*/
+	class FPoissonDiskGrid
+	{
+	public:
+		FPoissonDiskGrid(const FBox& InRegion, const bool bInIs2D, const double MinRadius, const double MaxRadius)
+			: Origin(InRegion.Min)
+			, bIs2D(bInIs2D)
+		{
+			CellSize = MinRadius / FMath::Sqrt(bIs2D ? 2.0 : 3.0);
+			InvCellSize = 1.0 / CellSize;
+			// counted in doubles, so a huge region with a tiny distance is rejected instead of overflowing the integer counts
+			const FVector Size = InRegion.GetSize();
+			const double NumCellsX = FMath::Max(FMath::CeilToDouble(Size.X * InvCellSize), 1.0);
+			const double NumCellsY = FMath::Max(FMath::CeilToDouble(Size.Y * InvCellSize), 1.0);
+			const double NumCellsZ = bIs2D ? 1.0 : FMath::Max(FMath::CeilToDouble(Size.Z * InvCellSize), 1.0);
+			if (NumCellsX * NumCellsY * NumCellsZ > MaxPoissonDiskCells)
+			{
+				NumCells = FIntVector::ZeroValue;
+				return;
+			}
+			NumCells = FIntVector(static_cast<int32>(NumCellsX), static_cast<int32>(NumCellsY), static_cast<int32>(NumCellsZ));
+			SearchRange = static_cast<int32>(FMath::Min(FMath::CeilToDouble(MaxRadius * InvCellSize), static_cast<double>(NumCells.GetMax())));
+			Cells.SetNum(NumCells.X * NumCells.Y * NumCells.Z);
+		}
+
+		bool IsValid() const { return Cells.Num() > 0; }
+
+		/** Whether a point with its radius keeps the spacing of all the points in the grid (the larger radius of each pair applies). */
+		bool IsFarEnough(const FVector& Position, const double Radius) const
+		{
+			const FIntVector Cell = GetCell(Position);
+			const int32 Range = FMath::Max(SearchRange, static_cast<int32>(FMath::Min(FMath::CeilToDouble(Radius * InvCellSize), static_cast<double>(NumCells.GetMax()))));
+			const int32 MinZ = FMath::Max(Cell.Z - Range, 0), MaxZ = FMath::Min(Cell.Z + Range, NumCells.Z - 1);
+			const int32 MinY = FMath::Max(Cell.Y - Range, 0), MaxY = FMath::Min(Cell.Y + Range, NumCells.Y - 1);
+			const int32 MinX = FMath::Max(Cell.X - Range, 0), MaxX = FMath::Min(Cell.X + Range, NumCells.X - 1);
+			for (int32 Z = MinZ; Z <= MaxZ; Z++)
+			{
+				for (int32 Y = MinY; Y <= MaxY; Y++)
+				{
+					const FPoissonDiskPoint* Row = &Cells[(Z * NumCells.Y + Y) * NumCells.X];
+					for (int32 X = MinX; X <= MaxX; X++)
+					{
+						const FPoissonDiskPoint& Other = Row[X];
+						if (Other.Radius > 0.0 && FVector::DistSquared(Position, Other.Position) < FMath::Square(FMath::Max(Radius, Other.Radius)))
+						{
+							return false;
+						}
+					}
+				}
+			}
+			return true;
+		}
+
+		void Insert(const FPoissonDiskPoint& Point)
+		{
+			const FIntVector Cell = GetCell(Point.Position);
+			Cells[(Cell.Z * NumCells.Y + Cell.Y) * NumCells.X + Cell.X] = Point;
+		}
+
+		double GetCellSize() const { return CellSize; }
+
+	private:
+		FIntVector GetCell(const FVector& Position) const
+		{
+			const FVector Local = (Position - Origin) * InvCellSize;
+			return FIntVector(
+				FMath::Clamp(FMath::FloorToInt(Local.X), 0, NumCells.X - 1),
+				FMath::Clamp(FMath::FloorToInt(Local.Y), 0, NumCells.Y - 1),
+				bIs2D ? 0 : FMath::Clamp(FMath::FloorToInt(Local.Z), 0, NumCells.Z - 1));
+		}
+
+		FVector Origin;
+		bool bIs2D;
+		double CellSize = 1.0;
+		double InvCellSize = 1.0;
+		int32 SearchRange = 1;
+		FIntVector NumCells;
+		TArray<FPoissonDiskPoint> Cells;
+	};
+
+	/** Bridson's algorithm within one tile: grow from random seed points until MaxAttempts seed points in a row are rejected. */
+	void SamplePoissonDiskTile(const FBox& TileBox, const bool bIs2D, const FPoissonDiskSettings& Settings, const TFunction<double(const FVector&)>& DensityFunction,
+		const FRandomStream& TileStream, FPoissonDiskGrid& Grid, TArray<FVector>& OutTilePoints)
+	{
+		const double MaxDistance = FMath::Max(Settings.MaxDistance, Settings.MinDistance);  // never a radius below MinDistance, as the grid assumes
+		const auto GetRadius = [&Settings, &DensityFunction, MaxDistance](const FVector& Position)  // 0 for no point allowed
+		{
+			if (!DensityFunction)
+			{
+				return Settings.MinDistance;
+			}
+			const double Density = FMath::Min(DensityFunction(Position), 1.0);
+			return Density > 0.0 ? FMath::Lerp(MaxDistance, Settings.MinDistance, Density) : 0.0;
+		};
+		const auto RandomInTile = [&TileBox, &TileStream, bIs2D]()
+		{
+			return FVector(
+				TileStream.FRandRange(TileBox.Min.X, TileBox.Max.X),
+				TileStream.FRandRange(TileBox.Min.Y, TileBox.Max.Y),
+				bIs2D ? TileBox.Min.Z : TileStream.FRandRange(TileBox.Min.Z, TileBox.Max.Z));
+		};
+
+		TArray<FPoissonDiskPoint> ActivePoints;
+		int32 NumSeedFailures = 0;
+		while (NumSeedFailures < Settings.MaxAttempts)
+		{
+			const FVector SeedPosition = RandomInTile();
+			const double SeedRadius = GetRadius(SeedPosition);
+			if (SeedRadius <= 0.0 || !Grid.IsFarEnough(SeedPosition, SeedRadius))
+			{
+				NumSeedFailures++;
+				continue;
+			}
+			NumSeedFailures = 0;
+			Grid.Insert({SeedPosition, SeedRadius});
+			OutTilePoints.Add(SeedPosition);
+			ActivePoints.Add({SeedPosition, SeedRadius});
+
+			while (ActivePoints.Num() > 0)
+			{
+				const int32 ActiveIdx = TileStream.RandHelper(ActivePoints.Num());
+				const FPoissonDiskPoint Active = ActivePoints[ActiveIdx];
+				bool bFoundCandidate = false;
+				for (int32 AttemptIdx = 0; AttemptIdx < Settings.MaxAttempts; AttemptIdx++)
+				{
+					FVector Direction;
+					if (bIs2D)
+					{
+						const double Angle = TileStream.FRandRange(0.0, UE_DOUBLE_TWO_PI);
+						Direction = FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0);
+					}
+					else
+					{
+						Direction = TileStream.GetUnitVector();
+					}
+					const FVector Candidate = Active.Position + Direction * TileStream.FRandRange(Active.Radius, 2.0 * Active.Radius);  // the annulus [r, 2r)
+					if (!TileBox.IsInsideOrOn(Candidate))
+					{
+						continue;
+					}
+					const double CandidateRadius = GetRadius(Candidate);
+					if (CandidateRadius > 0.0 && Grid.IsFarEnough(Candidate, CandidateRadius))
+					{
+						Grid.Insert({Candidate, CandidateRadius});
+						OutTilePoints.Add(Candidate);
+						ActivePoints.Add({Candidate, CandidateRadius});
+						bFoundCandidate = true;
+						break;
+					}
+				}
+				if (!bFoundCandidate)
+				{
+					ActivePoints.RemoveAtSwap(ActiveIdx, 1, false);
+				}
+			}
+		}
+	}
+}
+
+double FPoissonDiskDensityMap::GetDensity(const double U, const double V) const
+{
+	const double X = FMath::Clamp(U * SizeX - 0.5, 0.0, SizeX - 1.0);  // texel centers
+	const double Y = FMath::Clamp(V * SizeY - 0.5, 0.0, SizeY - 1.0);
+	const int32 X0 = FMath::FloorToInt(X), Y0 = FMath::FloorToInt(Y);
+	const int32 X1 = FMath::Min(X0 + 1, SizeX - 1), Y1 = FMath::Min(Y0 + 1, SizeY - 1);
+	const double AlphaX = X - X0, AlphaY = Y - Y0;
+	const double Top = FMath::Lerp<double>(Densities[Y0 * SizeX + X0], Densities[Y0 * SizeX + X1], AlphaX);
+	const double Bottom = FMath::Lerp<double>(Densities[Y1 * SizeX + X0], Densities[Y1 * SizeX + X1], AlphaX);
+	return FMath::Lerp(Top, Bottom, AlphaY);
+}
+
+bool UPositionSamplerUtils::CookSurfaceSamplerFromTriangles(const TArray<FVector>& Vertices, const TArray<int32>& Indices, FCookedSurfaceSampler& OutSampler)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixCookSurfaceSampler);
+	INC_DWORD_STAT(STAT_FenixCookCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Indices.Num() / 3);
+
+	const int32 NumTriangles = Indices.Num() / 3;
+	OutSampler.TriangleVectors.Reset(NumTriangles * 3);
+	TArray<double> Areas;
+	Areas.Reserve(NumTriangles);
+	for (int32 TriIdx = 0; TriIdx < NumTriangles; TriIdx++)
+	{
+		const int32 IdxA = Indices[TriIdx * 3];
+		const int32 IdxB = Indices[TriIdx * 3 + 1];
+		const int32 IdxC = Indices[TriIdx * 3 + 2];
+		if (Vertices.IsValidIndex(IdxA) && Vertices.IsValidIndex(IdxB) && Vertices.IsValidIndex(IdxC))
+		{
+			AddTriangle(OutSampler.TriangleVectors, Areas, Vertices[IdxA], Vertices[IdxB], Vertices[IdxC]);
+		}
+	}
+	return FinishCooking(Areas, OutSampler);
+}
+
+bool UPositionSamplerUtils::CookSurfaceSamplerFromStaticMesh(const UStaticMesh* StaticMesh, FCookedSurfaceSampler& OutSampler, const FTransform& Transform, const int32 LODIndex)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixCookSurfaceSampler);
+	INC_DWORD_STAT(STAT_FenixCookCalls);
+
+	OutSampler = FCookedSurfaceSampler();
+	const FStaticMeshRenderData* RenderData = StaticMesh ? StaticMesh->GetRenderData() : nullptr;
+	if (!RenderData || !RenderData->LODResources.IsValidIndex(LODIndex))
+	{
+		return false;
+	}
+#if !WITH_EDITOR
+	if (!StaticMesh->bAllowCPUAccess)  // the vertex and index data are released after being uploaded to the GPU
+	{
+		FFrame::KismetExecutionMessage(*FString::Printf(TEXT("CookSurfaceSamplerFromStaticMesh: %s needs \"Allow CPU Access\" to be sampled."), *StaticMesh->GetPathName()), ELogVerbosity::Warning);
+		return false;
+	}
+#endif
+
+	const FStaticMeshLODResources& LODResources = RenderData->LODResources[LODIndex];
+	const FPositionVertexBuffer& PositionBuffer = LODResources.VertexBuffers.PositionVertexBuffer;
+	const FIndexArrayView IndexView = LODResources.IndexBuffer.GetArrayView();
+	const int32 NumVertices = PositionBuffer.GetNumVertices();
+	const int32 NumTriangles = IndexView.Num() / 3;
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(NumTriangles);
+
+	TArray<FVector> Vertices;
+	Vertices.SetNumUninitialized(NumVertices);
+	for (int32 VertIdx = 0; VertIdx < NumVertices; VertIdx++)
+	{
+		Vertices[VertIdx] = Transform.TransformPosition(FVector(PositionBuffer.VertexPosition(VertIdx)));
+	}
+
+	OutSampler.TriangleVectors.Reserve(NumTriangles * 3);
+	TArray<double> Areas;
+	Areas.Reserve(NumTriangles);
+	for (int32 TriIdx = 0; TriIdx < NumTriangles; TriIdx++)
+	{
+		const uint32 IdxA = IndexView[TriIdx * 3];
+		const uint32 IdxB = IndexView[TriIdx * 3 + 1];
+		const uint32 IdxC = IndexView[TriIdx * 3 + 2];
+		if (IdxA < static_cast<uint32>(NumVertices) && IdxB < static_cast<uint32>(NumVertices) && IdxC < static_cast<uint32>(NumVertices))  // skip triangles of broken index data
+		{
+			AddTriangle(OutSampler.TriangleVectors, Areas, Vertices[IdxA], Vertices[IdxB], Vertices[IdxC]);
+		}
+	}
+	return FinishCooking(Areas, OutSampler);
+}
+
+bool UPositionSamplerUtils::CookSurfaceSamplerFromNavMesh(const UObject* WorldContextObject, FCookedSurfaceSampler& OutSampler, const FBox& Bounds)
+{
+	const UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull) : nullptr;
+	const UNavigationSystemV1* NavSys = World ? FNavigationSystem::GetCurrent<UNavigationSystemV1>(World) : nullptr;
+	const ANavigationData* NavData = NavSys ? NavSys->GetDefaultNavDataInstance() : nullptr;
+	return CookSurfaceSamplerFromNavData(NavData, OutSampler, Bounds);
+}
+
+bool UPositionSamplerUtils::CookSurfaceSamplerFromNavData(const ANavigationData* NavData, FCookedSurfaceSampler& OutSampler, const FBox& Bounds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixCookSurfaceSampler);
+	INC_DWORD_STAT(STAT_FenixCookCalls);
+
+	OutSampler = FCookedSurfaceSampler();
+#if WITH_RECAST
+	const ARecastNavMesh* NavMesh = Cast<const ARecastNavMesh>(NavData);
+	if (!NavMesh)
+	{
+		return false;
+	}
+
+	TArray<double> Areas;
+	TArray<FNavPoly> Polys;
+	TArray<FVector> PolyVerts;
+	const int32 NumTiles = NavMesh->GetNavMeshTilesCount();
+	for (int32 TileIdx = 0; TileIdx < NumTiles; TileIdx++)
+	{
+		Polys.Reset();
+		if (!NavMesh->GetPolysInTile(TileIdx, Polys))
+		{
+			continue;
+		}
+		for (const FNavPoly& Poly : Polys)
+		{
+			if (Bounds.IsValid && !Bounds.IsInside(Poly.Center))
+			{
+				continue;
+			}
+			PolyVerts.Reset();
+			if (NavMesh->GetPolyVerts(Poly.Ref, PolyVerts))
+			{
+				for (int32 VertIdx = 2; VertIdx < PolyVerts.Num(); VertIdx++)  // navmesh polygons are convex, so a fan triangulates them
+				{
+					AddTriangle(OutSampler.TriangleVectors, Areas, PolyVerts[0], PolyVerts[VertIdx - 1], PolyVerts[VertIdx]);
+				}
+			}
+		}
+	}
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Areas.Num());
+	return FinishCooking(Areas, OutSampler);
+#else
+	return false;
+#endif
+}
+
+void UPositionSamplerUtils::SamplePoissonDisk2D(const FBox2D& Region, const FPoissonDiskSettings& Settings, const FRandomStream& RandomStream, const FPoissonDiskDensityMap& DensityMap, TArray<FVector2D>& OutPoints)
+{
+	OutPoints.Reset();
+	if (!Region.bIsValid)
+	{
+		return;
+	}
+
+	TFunction<double(const FVector&)> DensityFunction;
+	if (DensityMap.IsValid())
+	{
+		const FVector2D InvSize = FVector2D(1.0) / Region.GetSize().ComponentMax(FVector2D(UE_DOUBLE_SMALL_NUMBER));
+		DensityFunction = [&DensityMap, &Region, InvSize](const FVector& Position)
+		{
+			return DensityMap.GetDensity((Position.X - Region.Min.X) * InvSize.X, (Position.Y - Region.Min.Y) * InvSize.Y);
+		};
+	}
+
+	TArray<FVector> Points;
+	SamplePoissonDisk(FBox(FVector(Region.Min, 0.0), FVector(Region.Max, 0.0)), true, Settings, RandomStream, Points, MoveTemp(DensityFunction));
+	OutPoints.SetNumUninitialized(Points.Num());
+	for (int32 PointIdx = 0; PointIdx < Points.Num(); PointIdx++)
+	{
+		OutPoints[PointIdx] = FVector2D(Points[PointIdx]);
+	}
+}
+
+void UPositionSamplerUtils::SamplePoissonDisk3D(const FBox& Region, const FPoissonDiskSettings& Settings, const FRandomStream& RandomStream, const FPoissonDiskDensityMap& DensityMap, TArray<FVector>& OutPoints)
+{
+	OutPoints.Reset();
+	if (!Region.IsValid)
+	{
+		return;
+	}
+
+	TFunction<double(const FVector&)> DensityFunction;
+	if (DensityMap.IsValid())
+	{
+		const FVector InvSize = FVector(1.0) / Region.GetSize().ComponentMax(FVector(UE_DOUBLE_SMALL_NUMBER));
+		DensityFunction = [&DensityMap, &Region, InvSize](const FVector& Position)
+		{
+			return DensityMap.GetDensity((Position.X - Region.Min.X) * InvSize.X, (Position.Y - Region.Min.Y) * InvSize.Y);
+		};
+	}
+	SamplePoissonDisk(Region, false, Settings, RandomStream, OutPoints, MoveTemp(DensityFunction));
+}
+
+bool UPositionSamplerUtils::CookDensityMapSampler(const TArray<float>& Densities, const int32 SizeX, const int32 SizeY, FCookedDensityMapSampler& OutSampler, const bool bUseAliasTables)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixCookDensityMapSampler);
+	INC_DWORD_STAT(STAT_FenixCookCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Densities.Num());
+
+	OutSampler = FCookedDensityMapSampler();
+	if (SizeX <= 0 || SizeY <= 0 || Densities.Num() != SizeX * SizeY)
+	{
+		return false;
+	}
+
+	OutSampler.SizeX = SizeX;
+	OutSampler.SizeY = SizeY;
+	OutSampler.bUseAliasTables = bUseAliasTables;
+	OutSampler.Densities.SetNumUninitialized(Densities.Num());
+	for (int32 Idx = 0; Idx < Densities.Num(); Idx++)
+	{
+		OutSampler.Densities[Idx] = FMath::Max(Densities[Idx], 0.0f);
+	}
+	OutSampler.RowTotals.SetNumZeroed(SizeY);
+	if (bUseAliasTables)
+	{
+		OutSampler.RowAliasTables.SetNum(SizeY);
+	}
+	else
+	{
+		OutSampler.RowCumDensities.SetNumUninitialized(Densities.Num());
+	}
+	for (int32 Row = 0; Row < SizeY; Row++)
+	{
+		CookDensityMapRow(OutSampler, Row);
+	}
+	return CookDensityMapMarginal(OutSampler);
+}
+
+bool UPositionSamplerUtils::CookDensityMapSamplerFromTexture(UTexture2D* Texture, FCookedDensityMapSampler& OutSampler, const int32 ChannelIndex, const bool bUseAliasTables)
+{
+	OutSampler = FCookedDensityMapSampler();
+	const FTexturePlatformData* PlatformData = Texture ? Texture->GetPlatformData() : nullptr;
+	if (!PlatformData || PlatformData->Mips.Num() == 0 || ChannelIndex < 0 || ChannelIndex > 3)
+	{
+		return false;
+	}
+
+	const FTexture2DMipMap& Mip = PlatformData->Mips[0];
+	const int32 SizeX = Mip.SizeX;
+	const int32 SizeY = Mip.SizeY;
+	const int32 NumTexels = SizeX * SizeY;
+	int32 BytesPerTexel;
+	switch (PlatformData->PixelFormat)
+	{
+	case PF_G8: BytesPerTexel = 1; break;
+	case PF_B8G8R8A8: BytesPerTexel = 4; break;
+	case PF_R32_FLOAT: BytesPerTexel = 4; break;
+	case PF_FloatRGBA: BytesPerTexel = 8; break;
+	case PF_A32B32G32R32F: BytesPerTexel = 16; break;
+	default: BytesPerTexel = 0; break;
+	}
+	const uint8* Data = BytesPerTexel > 0 ? static_cast<const uint8*>(Mip.BulkData.LockReadOnly()) : nullptr;
+	if (!Data || Mip.BulkData.GetBulkDataSize() < static_cast<int64>(NumTexels) * BytesPerTexel)
+	{
+		if (Data)
+		{
+			Mip.BulkData.Unlock();
+		}
+		FFrame::KismetExecutionMessage(*FString::Printf(TEXT("CookDensityMapSamplerFromTexture: %s needs an uncompressed format with CPU data to be sampled."), *Texture->GetPathName()), ELogVerbosity::Warning);
+		return false;
+	}
+
+	TArray<float> Densities;
+	Densities.SetNumUninitialized(NumTexels);
+	for (int32 TexelIdx = 0; TexelIdx < NumTexels; TexelIdx++)
+	{
+		const uint8* Texel = Data + TexelIdx * BytesPerTexel;
+		switch (PlatformData->PixelFormat)
+		{
+		case PF_G8: Densities[TexelIdx] = Texel[0] / 255.0f; break;
+		case PF_B8G8R8A8: Densities[TexelIdx] = Texel[ChannelIndex == 3 ? 3 : 2 - ChannelIndex] / 255.0f; break;  // stored as BGRA
+		case PF_R32_FLOAT: Densities[TexelIdx] = reinterpret_cast<const float*>(Texel)[0]; break;
+		case PF_FloatRGBA: Densities[TexelIdx] = reinterpret_cast<const FFloat16*>(Texel)[ChannelIndex].GetFloat(); break;
+		default: Densities[TexelIdx] = reinterpret_cast<const float*>(Texel)[ChannelIndex]; break;
+		}
+	}
+	Mip.BulkData.Unlock();
+	return CookDensityMapSampler(Densities, SizeX, SizeY, OutSampler, bUseAliasTables);
+}
+
+bool UPositionSamplerUtils::UpdateDensityMapSamplerRegion(FCookedDensityMapSampler& Sampler, const int32 MinX, const int32 MinY, const int32 RegionSizeX, const int32 RegionSizeY, const TArray<float>& RegionDensities)
+{
+	if (RegionSizeX <= 0 || RegionSizeY <= 0 || MinX < 0 || MinY < 0 || MinX + RegionSizeX > Sampler.SizeX || MinY + RegionSizeY > Sampler.SizeY
+		|| RegionDensities.Num() != RegionSizeX * RegionSizeY || Sampler.Densities.Num() != Sampler.SizeX * Sampler.SizeY)
+	{
+		return false;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_FenixCookDensityMapSampler);
+	INC_DWORD_STAT(STAT_FenixCookCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(RegionDensities.Num());
+
+	for (int32 RegionRow = 0; RegionRow < RegionSizeY; RegionRow++)
+	{
+		const int32 Row = MinY + RegionRow;
+		float* RowDensities = &Sampler.Densities[Row * Sampler.SizeX + MinX];
+		const float* NewDensities = &RegionDensities[RegionRow * RegionSizeX];
+		for (int32 Idx = 0; Idx < RegionSizeX; Idx++)
+		{
+			RowDensities[Idx] = FMath::Max(NewDensities[Idx], 0.0f);
+		}
+		CookDensityMapRow(Sampler, Row);
+	}
+	CookDensityMapMarginal(Sampler);
+	return true;
+}
+
+bool UPositionSamplerUtils::BPFunc_SampleSurfacePoint(const FCookedSurfaceSampler& Sampler, FVector& OutPoint, FVector& OutNormal)
+{
+	return SampleSurfacePoint(Sampler, OutPoint, &OutNormal);
+}
+
+bool UPositionSamplerUtils::BPFunc_SampleSurfacePointFromStream(const FCookedSurfaceSampler& Sampler, const FRandomStream& RandomStream, FVector& OutPoint, FVector& OutNormal)
+{
+	return SampleSurfacePoint(Sampler, OutPoint, &OutNormal, &RandomStream);
+}
+
+void UPositionSamplerUtils::BPFunc_SampleSurfacePoints(const FCookedSurfaceSampler& Sampler, const int32 NumPoints, TArray<FVector>& OutPoints)
+{
+	OutPoints.Reset();
+	SampleSurfacePoints(Sampler, NumPoints, OutPoints);
+}
+
+void UPositionSamplerUtils::BPFunc_SampleSurfacePointsFromStream(const FCookedSurfaceSampler& Sampler, const int32 NumPoints, const FRandomStream& RandomStream, TArray<FVector>& OutPoints)
+{
+	OutPoints.Reset();
+	SampleSurfacePoints(Sampler, NumPoints, OutPoints, &RandomStream);
+}
+
+bool UPositionSamplerUtils::BPFunc_SampleDensityMap(const FCookedDensityMapSampler& Sampler, const FBox2D& Region, FVector2D& OutPoint)
+{
+	FVector2D UV;
+	const bool bSampled = SampleDensityMap(Sampler, UV);
+	OutPoint = Region.Min + UV * Region.GetSize();
+	return bSampled;
+}
+
+bool UPositionSamplerUtils::BPFunc_SampleDensityMapFromStream(const FCookedDensityMapSampler& Sampler, const FBox2D& Region, const FRandomStream& RandomStream, FVector2D& OutPoint)
+{
+	FVector2D UV;
+	const bool bSampled = SampleDensityMap(Sampler, UV, &RandomStream);
+	OutPoint = Region.Min + UV * Region.GetSize();
+	return bSampled;
+}
+
+void UPositionSamplerUtils::BPFunc_SampleDensityMapPoints(const FCookedDensityMapSampler& Sampler, const FBox2D& Region, const int32 NumPoints, TArray<FVector2D>& OutPoints)
+{
+	OutPoints.Reset();
+	SampleDensityMapPoints(Sampler, Region, NumPoints, OutPoints);
+}
+
+void UPositionSamplerUtils::BPFunc_SampleDensityMapPointsFromStream(const FCookedDensityMapSampler& Sampler, const FBox2D& Region, const int32 NumPoints, const FRandomStream& RandomStream, TArray<FVector2D>& OutPoints)
+{
+	OutPoints.Reset();
+	SampleDensityMapPoints(Sampler, Region, NumPoints, OutPoints, &RandomStream);
+}
+
+bool UPositionSamplerUtils::SampleSurfacePoint(const FCookedSurfaceSampler& Sampler, FVector& OutPoint, FVector* OutNormal, const FRandomStream* RandomStream)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixSampleSurfacePoints);
+	INC_DWORD_STAT(STAT_FenixSampledSurfacePoints);
+
+	const int32 TriIdx = Sampler.AreaAliasTable.Thresholds.Num() > 0 ? USelectorUtils::SelectWithAliasTableUnchecked(Sampler.AreaAliasTable, RandomStream) : -1;
+	if (TriIdx < 0)
+	{
+		return false;
+	}
+
+	const FVector& A = Sampler.TriangleVectors[TriIdx * 3];
+	const FVector& AB = Sampler.TriangleVectors[TriIdx * 3 + 1];
+	const FVector& AC = Sampler.TriangleVectors[TriIdx * 3 + 2];
+	OutPoint = SampleInTriangle(A, AB, AC, RandomStream);
+	if (OutNormal)
+	{
+		*OutNormal = FVector::CrossProduct(AB, AC).GetSafeNormal();
+	}
+	return true;
+}
+
+void UPositionSamplerUtils::SampleSurfacePoints(const FCookedSurfaceSampler& Sampler, const int32 NumPoints, TArray<FVector>& OutPoints, const FRandomStream* RandomStream)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixSampleSurfacePoints);
+
+	if (Sampler.AreaAliasTable.Thresholds.Num() == 0 || NumPoints <= 0)
+	{
+		return;
+	}
+	INC_DWORD_STAT_BY(STAT_FenixSampledSurfacePoints, NumPoints);
+
+	const TArray<FVector>& TriangleVectors = Sampler.TriangleVectors;
+	OutPoints.Reserve(OutPoints.Num() + NumPoints);
+	for (int32 PointIdx = 0; PointIdx < NumPoints; PointIdx++)
+	{
+		const int32 TriIdx = USelectorUtils::SelectWithAliasTableUnchecked(Sampler.AreaAliasTable, RandomStream);
+		OutPoints.Add(SampleInTriangle(TriangleVectors[TriIdx * 3], TriangleVectors[TriIdx * 3 + 1], TriangleVectors[TriIdx * 3 + 2], RandomStream));
+	}
+}
+
+bool UPositionSamplerUtils::SampleDensityMap(const FCookedDensityMapSampler& Sampler, FVector2D& OutUV, const FRandomStream* RandomStream)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixSampleDensityMap);
+	INC_DWORD_STAT(STAT_FenixSampledDensityMapPoints);
+
+	if (Sampler.TotalDensity <= 0.0)
+	{
+		OutUV = FVector2D::ZeroVector;
+		return false;
+	}
+	OutUV = SampleDensityMapUnchecked(Sampler, RandomStream);
+	return true;
+}
+
+void UPositionSamplerUtils::SampleDensityMapPoints(const FCookedDensityMapSampler& Sampler, const FBox2D& Region, const int32 NumPoints, TArray<FVector2D>& OutPoints, const FRandomStream* RandomStream)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixSampleDensityMap);
+
+	if (Sampler.TotalDensity <= 0.0 || NumPoints <= 0)
+	{
+		return;
+	}
+	INC_DWORD_STAT_BY(STAT_FenixSampledDensityMapPoints, NumPoints);
+
+	const FVector2D RegionSize = Region.GetSize();
+	OutPoints.Reserve(OutPoints.Num() + NumPoints);
+	for (int32 PointIdx = 0; PointIdx < NumPoints; PointIdx++)
+	{
+		OutPoints.Add(Region.Min + SampleDensityMapUnchecked(Sampler, RandomStream) * RegionSize);
+	}
+}
+
+void UPositionSamplerUtils::SamplePoissonDisk(const FBox& Region, const bool bIs2D, const FPoissonDiskSettings& Settings, const FRandomStream& RandomStream, TArray<FVector>& OutPoints, TFunction<double(const FVector&)> DensityFunction)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixPoissonDiskSampling);
+
+	if (!Region.IsValid || Settings.MinDistance <= 0.0 || Settings.MaxAttempts <= 0)
+	{
+		return;
+	}
+
+	const double MaxRadius = DensityFunction ? FMath::Max(Settings.MaxDistance, Settings.MinDistance) : Settings.MinDistance;
+	FPoissonDiskGrid Grid(Region, bIs2D, Settings.MinDistance, MaxRadius);
+	if (!Grid.IsValid())
+	{
+		FFrame::KismetExecutionMessage(TEXT("SamplePoissonDisk: the region is too large for the minimum distance, the background grid would exceed 16M cells."), ELogVerbosity::Warning);
+		return;
+	}
+
+	// tiles of the same phase are a whole tile apart, so no read or write of one reaches the cells written by another
+	const FVector RegionSize = Region.GetSize();
+	const double TileSize = Settings.TileSize > 0.0 ? FMath::Max(Settings.TileSize, MaxRadius + 3.0 * Grid.GetCellSize()) : FMath::Max(RegionSize.GetMax(), UE_DOUBLE_SMALL_NUMBER);
+	const FIntVector NumTiles(
+		FMath::Max(FMath::CeilToInt(RegionSize.X / TileSize), 1),
+		FMath::Max(FMath::CeilToInt(RegionSize.Y / TileSize), 1),
+		bIs2D ? 1 : FMath::Max(FMath::CeilToInt(RegionSize.Z / TileSize), 1));
+	const int32 TotalNumTiles = NumTiles.X * NumTiles.Y * NumTiles.Z;
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(TotalNumTiles);
+
+	TArray<TArray<FVector>> TilePoints;
+	TilePoints.SetNum(TotalNumTiles);
+	TArray<int32> PhaseTiles;
+	const int32 NumPhases = bIs2D ? 4 : 8;
+	for (int32 Phase = 0; Phase < NumPhases; Phase++)
+	{
+		PhaseTiles.Reset();
+		for (int32 TileIdx = 0; TileIdx < TotalNumTiles; TileIdx++)
+		{
+			const int32 TileX = TileIdx % NumTiles.X;
+			const int32 TileY = TileIdx / NumTiles.X % NumTiles.Y;
+			const int32 TileZ = TileIdx / (NumTiles.X * NumTiles.Y);
+			if (((TileX & 1) | (TileY & 1) << 1 | (TileZ & 1) << 2) == Phase)
+			{
+				PhaseTiles.Add(TileIdx);
+			}
+		}
+
+		ParallelFor(PhaseTiles.Num(), [&](const int32 PhaseTileIdx)
+		{
+			const int32 TileIdx = PhaseTiles[PhaseTileIdx];
+			const FVector TileMin = Region.Min + FVector(static_cast<double>(TileIdx % NumTiles.X), static_cast<double>(TileIdx / NumTiles.X % NumTiles.Y), static_cast<double>(TileIdx / (NumTiles.X * NumTiles.Y))) * TileSize;
+			const FBox TileBox(TileMin, FVector::Min(TileMin + FVector(TileSize), Region.Max));
+			const FRandomStream TileStream(static_cast<int32>(HashCombine(static_cast<uint32>(RandomStream.GetCurrentSeed()), static_cast<uint32>(TileIdx))));  // independent of scheduling
+			SamplePoissonDiskTile(TileBox, bIs2D, Settings, DensityFunction, TileStream, Grid, TilePoints[TileIdx]);
+		}, PhaseTiles.Num() <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+	}
+
+	int32 NumPoints = 0;
+	for (const TArray<FVector>& Points : TilePoints)
+	{
+		NumPoints += Points.Num();
+	}
+	OutPoints.Reserve(OutPoints.Num() + NumPoints);
+	for (const TArray<FVector>& Points : TilePoints)
+	{
+		OutPoints.Append(Points);
+	}
+}
+
+void UPositionSamplerUtils::AddTriangle(TArray<FVector>& TriangleVectors, TArray<double>& Areas, const FVector& A, const FVector& B, const FVector& C)
+{
+	const FVector AB = B - A;
+	const FVector AC = C - A;
+	TriangleVectors.Add(A);
+	TriangleVectors.Add(AB);
+	TriangleVectors.Add(AC);
+	Areas.Add(0.5 * FVector::CrossProduct(AB, AC).Size());
+}
+
+void UPositionSamplerUtils::CookDensityMapRow(FCookedDensityMapSampler& Sampler, const int32 Row)
+{
+	const int32 RowStart = Row * Sampler.SizeX;
+	double RowTotal = 0.0;
+	if (Sampler.bUseAliasTables)
+	{
+		TArray<double> Weights;
+		Weights.SetNumUninitialized(Sampler.SizeX);
+		for (int32 Column = 0; Column < Sampler.SizeX; Column++)
+		{
+			Weights[Column] = Sampler.Densities[RowStart + Column];
+			RowTotal += Weights[Column];
+		}
+		USelectorUtils::CookAliasTable(Weights, Sampler.RowAliasTables[Row]);  // an empty row gets an empty table, never selected by the marginal
+	}
+	else
+	{
+		for (int32 Column = 0; Column < Sampler.SizeX; Column++)
+		{
+			RowTotal += Sampler.Densities[RowStart + Column];
+			Sampler.RowCumDensities[RowStart + Column] = RowTotal;
+		}
+	}
+	Sampler.RowTotals[Row] = RowTotal;
+}
+
+bool UPositionSamplerUtils::CookDensityMapMarginal(FCookedDensityMapSampler& Sampler)
+{
+	Sampler.TotalDensity = 0.0;
+	for (const double RowTotal : Sampler.RowTotals)
+	{
+		Sampler.TotalDensity += RowTotal;
+	}
+	if (Sampler.bUseAliasTables)
+	{
+		USelectorUtils::CookAliasTable(Sampler.RowTotals, Sampler.MarginalAliasTable);
+	}
+	else
+	{
+		UCommonUtils::MakeSimpleCumulatives(Sampler.RowTotals, Sampler.MarginalCumDensities);
+	}
+	return Sampler.TotalDensity > 0.0;
+}
+
+bool UPositionSamplerUtils::FinishCooking(TArray<double>& Areas, FCookedSurfaceSampler& OutSampler)
+{
+	OutSampler.TotalArea = 0.0;
+	for (const double Area : Areas)
+	{
+		OutSampler.TotalArea += Area;
+	}
+	USelectorUtils::CookAliasTable(Areas, OutSampler.AreaAliasTable);  // zero area triangles get zero thresholds, never kept
+	return OutSampler.AreaAliasTable.Thresholds.Num() > 0;
+}
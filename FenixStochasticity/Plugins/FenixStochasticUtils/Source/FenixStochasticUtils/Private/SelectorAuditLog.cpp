@@ -0,0 +1,514 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+
+#include "SelectorAuditLog.h"
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+std::atomic<bool> FSelectorAuditLog::bEnabled(false);
+
+namespace
+{
+	constexpr uint32 AuditFileMagic = 0x4C415846;  // "FXAL"
+	constexpr uint32 AuditFileVersion = 1;
+	constexpr uint32 RingCapacity = 4096;  // must be a power of 2
+	constexpr int32 MinRecordRawSize = 1 + 4 * sizeof(uint32);  // a one byte timestamp delta and the four fixed size columns
+	constexpr int64 MaxCompressionRatio = 1032;  // upper bound of Zlib's deflate ratio
+	constexpr double FlushIntervalSeconds = 0.05;
+
+	/** Anchors of the recorded timestamps, written at the start of the file. */
+	struct FAuditFileHeader
+	{
+		uint32 Magic = AuditFileMagic;
+		uint32 Version = AuditFileVersion;
+		int64 StartUtcTicks = 0;
+		uint64 StartCycles = 0;
+		double SecondsPerCycle = 0.0;
+
+		friend FArchive& operator<<(FArchive& Ar, FAuditFileHeader& Header)
+		{
+			return Ar << Header.Magic << Header.Version << Header.StartUtcTicks << Header.StartCycles << Header.SecondsPerCycle;
+		}
+	};
+
+	/** Ring buffer of one recording thread. Only that thread pushes, and draining is serialized by the rings lock. */
+	struct FAuditRing
+	{
+		FSelectorAuditRecord Records[RingCapacity];
+		std::atomic<uint32> Head{0};
+		std::atomic<uint32> Tail{0};
+		uint32 ThreadId = 0;
+
+		bool Push(const FSelectorAuditRecord& Record)
+		{
+			const uint32 CurrentHead = Head.load(std::memory_order_relaxed);
+			if (CurrentHead - Tail.load(std::memory_order_acquire) >= RingCapacity)
+			{
+				return false;
+			}
+			Records[CurrentHead & (RingCapacity - 1)] = Record;
+			Head.store(CurrentHead + 1, std::memory_order_release);
+			return true;
+		}
+
+		void Drain(TArray<FSelectorAuditRecord>& OutRecords)
+		{
+			const uint32 CurrentHead = Head.load(std::memory_order_acquire);
+			for (uint32 CurrentTail = Tail.load(std::memory_order_relaxed); CurrentTail != CurrentHead; CurrentTail++)
+			{
+				OutRecords.Add(Records[CurrentTail & (RingCapacity - 1)]);
+			}
+			Tail.store(CurrentHead, std::memory_order_release);
+		}
+	};
+
+	/** Rings of all the threads that have recorded, and the records that did not fit into them. */
+	struct FAuditBuffers
+	{
+		FCriticalSection RingsLock;
+		TArray<FAuditRing*> Rings;  // owned by the recording threads, see FLocalRingOwner
+
+		FCriticalSection OverflowLock;
+		TArray<FSelectorAuditRecord> OverflowRecords;
+
+		void DrainAll(TArray<FSelectorAuditRecord>& OutRecords)
+		{
+			{
+				FScopeLock ScopeLock(&RingsLock);
+				for (FAuditRing* Ring : Rings)
+				{
+					Ring->Drain(OutRecords);
+				}
+			}
+			{
+				FScopeLock ScopeLock(&OverflowLock);
+				OutRecords.Append(OverflowRecords);
+				OverflowRecords.Reset();
+			}
+		}
+	};
+
+	FAuditBuffers& GetBuffers()
+	{
+		static FAuditBuffers Buffers;
+		return Buffers;
+	}
+
+	/** Ring of the current thread. On thread exit it is unregistered, its remaining records moved to the overflow, and freed. */
+	struct FLocalRingOwner
+	{
+		FAuditRing* Ring = nullptr;
+
+		~FLocalRingOwner()
+		{
+			if (!Ring)
+			{
+				return;
+			}
+
+			FAuditBuffers& Buffers = GetBuffers();
+			TArray<FSelectorAuditRecord> RemainingRecords;
+			{
+				FScopeLock ScopeLock(&Buffers.RingsLock);
+				Buffers.Rings.RemoveSingleSwap(Ring);
+				Ring->Drain(RemainingRecords);
+			}
+			if (RemainingRecords.Num() > 0)
+			{
+				FScopeLock ScopeLock(&Buffers.OverflowLock);
+				Buffers.OverflowRecords.Append(RemainingRecords);
+			}
+			delete Ring;
+		}
+	};
+
+	thread_local FLocalRingOwner LocalRing;
+
+	void WriteVarUInt64(FArchive& Ar, uint64 Value)
+	{
+		do
+		{
+			uint8 Byte = Value & 0x7F;
+			Value >>= 7;
+			if (Value != 0)
+			{
+				Byte |= 0x80;
+			}
+			Ar << Byte;
+		} while (Value != 0);
+	}
+
+	uint64 ReadVarUInt64(FArchive& Ar)
+	{
+		uint64 Value = 0;
+		for (int32 Shift = 0; Shift < 64 && !Ar.IsError(); Shift += 7)
+		{
+			uint8 Byte = 0;
+			Ar << Byte;
+			Value |= static_cast<uint64>(Byte & 0x7F) << Shift;
+			if ((Byte & 0x80) == 0)
+			{
+				break;
+			}
+		}
+		return Value;
+	}
+
+	/**
+	* Write one block of records: NumRecords, RawSize, CompressedSize (0 if stored uncompressed), then the data.
+	* The data is column-wise (timestamp deltas as varints, then table ids, indices, seeds and thread ids), which compresses well.
+	*/
+	void WriteBlock(FArchive& FileAr, TArray<FSelectorAuditRecord>& Records)
+	{
+		Records.Sort([](const FSelectorAuditRecord& A, const FSelectorAuditRecord& B) { return A.Timestamp < B.Timestamp; });
+
+		TArray<uint8> RawData;
+		FMemoryWriter RawAr(RawData);
+		uint64 PrevTimestamp = 0;
+		for (const FSelectorAuditRecord& Record : Records)
+		{
+			WriteVarUInt64(RawAr, Record.Timestamp - PrevTimestamp);
+			PrevTimestamp = Record.Timestamp;
+		}
+		for (FSelectorAuditRecord& Record : Records)
+		{
+			RawAr << Record.TableId;
+		}
+		for (FSelectorAuditRecord& Record : Records)
+		{
+			RawAr << Record.SelectedIndex;
+		}
+		for (FSelectorAuditRecord& Record : Records)
+		{
+			RawAr << Record.StreamSeed;
+		}
+		for (FSelectorAuditRecord& Record : Records)
+		{
+			RawAr << Record.ThreadId;
+		}
+
+		int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, RawData.Num());
+		TArray<uint8> CompressedData;
+		CompressedData.SetNumUninitialized(CompressedSize);
+		if (!FCompression::CompressMemory(NAME_Zlib, CompressedData.GetData(), CompressedSize, RawData.GetData(), RawData.Num()))
+		{
+			CompressedSize = 0;
+		}
+
+		uint32 NumRecords = Records.Num();
+		int32 RawSize = RawData.Num();
+		FileAr << NumRecords << RawSize << CompressedSize;
+		if (CompressedSize > 0)
+		{
+			FileAr.Serialize(CompressedData.GetData(), CompressedSize);
+		}
+		else
+		{
+			FileAr.Serialize(RawData.GetData(), RawSize);
+		}
+		FileAr.Flush();
+	}
+
+	bool ReadAuditFile(const FString& FilePath, FAuditFileHeader& OutHeader, TArray<FSelectorAuditRecord>& OutRecords)
+	{
+		OutRecords.Reset();
+		TUniquePtr<FArchive> FileAr(IFileManager::Get().CreateFileReader(*FilePath));
+		if (!FileAr)
+		{
+			return false;
+		}
+
+		*FileAr << OutHeader;
+		if (FileAr->IsError() || OutHeader.Magic != AuditFileMagic || OutHeader.Version > AuditFileVersion)
+		{
+			return false;
+		}
+
+		TArray<uint8> RawData;
+		TArray<uint8> CompressedData;
+		while (FileAr->Tell() < FileAr->TotalSize())
+		{
+			uint32 NumRecords = 0;
+			int32 RawSize = 0;
+			int32 CompressedSize = 0;
+			*FileAr << NumRecords << RawSize << CompressedSize;
+			if (FileAr->IsError() || RawSize < 0 || CompressedSize < 0)
+			{
+				return false;
+			}
+
+			// reject sizes the rest of the file cannot hold before allocating anything for them
+			const int64 RemainingSize = FileAr->TotalSize() - FileAr->Tell();
+			const bool bSizesValid = CompressedSize > 0
+				? CompressedSize <= RemainingSize && RawSize <= CompressedSize * MaxCompressionRatio
+				: RawSize <= RemainingSize;
+			if (!bSizesValid || static_cast<int64>(NumRecords) * MinRecordRawSize > RawSize)
+			{
+				return false;
+			}
+
+			RawData.SetNumUninitialized(RawSize);
+			if (CompressedSize > 0)
+			{
+				CompressedData.SetNumUninitialized(CompressedSize);
+				FileAr->Serialize(CompressedData.GetData(), CompressedSize);
+				if (FileAr->IsError() || !FCompression::UncompressMemory(NAME_Zlib, RawData.GetData(), RawSize, CompressedData.GetData(), CompressedSize))
+				{
+					return false;
+				}
+			}
+			else
+			{
+				FileAr->Serialize(RawData.GetData(), RawSize);
+			}
+
+			const int32 FirstIdx = OutRecords.Num();
+			OutRecords.AddDefaulted(NumRecords);
+			TArrayView<FSelectorAuditRecord> BlockRecords(OutRecords.GetData() + FirstIdx, NumRecords);
+			FMemoryReader RawAr(RawData);
+			uint64 Timestamp = 0;
+			for (FSelectorAuditRecord& Record : BlockRecords)
+			{
+				Timestamp += ReadVarUInt64(RawAr);
+				Record.Timestamp = Timestamp;
+			}
+			for (FSelectorAuditRecord& Record : BlockRecords)
+			{
+				RawAr << Record.TableId;
+			}
+			for (FSelectorAuditRecord& Record : BlockRecords)
+			{
+				RawAr << Record.SelectedIndex;
+			}
+			for (FSelectorAuditRecord& Record : BlockRecords)
+			{
+				RawAr << Record.StreamSeed;
+			}
+			for (FSelectorAuditRecord& Record : BlockRecords)
+			{
+				RawAr << Record.ThreadId;
+			}
+			if (FileAr->IsError() || RawAr.IsError())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/** Background thread periodically draining the rings into the file. */
+	class FAuditWriter : public FRunnable
+	{
+	public:
+		explicit FAuditWriter(FArchive* InFileAr)
+			: FileAr(InFileAr)
+			, WakeEvent(FPlatformProcess::GetSynchEventFromPool(false))
+		{
+		}
+
+		virtual ~FAuditWriter() override
+		{
+			FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		}
+
+		virtual uint32 Run() override
+		{
+			while (!bStopRequested.load())
+			{
+				WakeEvent->Wait(FTimespan::FromSeconds(FlushIntervalSeconds));
+				Flush();
+			}
+			Flush();  // whatever was recorded before the stop
+			FileAr->Close();
+			return 0;
+		}
+
+		virtual void Stop() override
+		{
+			bStopRequested.store(true);
+			WakeEvent->Trigger();
+		}
+
+	private:
+		void Flush()
+		{
+			PendingRecords.Reset();
+			GetBuffers().DrainAll(PendingRecords);
+			if (PendingRecords.Num() > 0)
+			{
+				WriteBlock(*FileAr, PendingRecords);
+			}
+		}
+
+		TUniquePtr<FArchive> FileAr;
+		FEvent* WakeEvent;
+		std::atomic<bool> bStopRequested{false};
+		TArray<FSelectorAuditRecord> PendingRecords;
+	};
+
+	/** The active recording, guarded by the lock for Start/Stop. */
+	struct FAuditSession
+	{
+		FCriticalSection Lock;
+		TUniquePtr<FAuditWriter> Writer;
+		TUniquePtr<FRunnableThread> Thread;
+	};
+
+	FAuditSession& GetSession()
+	{
+		static FAuditSession Session;
+		return Session;
+	}
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice StartAuditCommand(
+		TEXT("Fenix.Selector.Audit.Start"),
+		TEXT("Start recording every selection into the file given as argument."),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			if (Args.Num() < 1 || !FSelectorAuditLog::Start(Args[0]))
+			{
+				Ar.Logf(ELogVerbosity::Warning, TEXT("Fenix.Selector.Audit.Start: failed, need a writable file path and no recording in progress."));
+			}
+		}));
+
+	FAutoConsoleCommand StopAuditCommand(
+		TEXT("Fenix.Selector.Audit.Stop"),
+		TEXT("Stop recording selections."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FSelectorAuditLog::Stop();
+		}));
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice ExportAuditCsvCommand(
+		TEXT("Fenix.Selector.Audit.ExportCsv"),
+		TEXT("Convert a recorded selection audit file (first argument) into CSV (second argument)."),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			if (Args.Num() < 2 || !FSelectorAuditLog::ExportCsv(Args[0], Args[1]))
+			{
+				Ar.Logf(ELogVerbosity::Warning, TEXT("Fenix.Selector.Audit.ExportCsv: failed, need a valid audit file and a writable CSV path."));
+			}
+		}));
+}
+
+bool FSelectorAuditLog::Start(const FString& FilePath)
+{
+	FAuditSession& Session = GetSession();
+	FScopeLock ScopeLock(&Session.Lock);
+	if (Session.Thread)
+	{
+		return false;
+	}
+
+	FArchive* FileAr = IFileManager::Get().CreateFileWriter(*FilePath);
+	if (!FileAr)
+	{
+		return false;
+	}
+
+	FAuditFileHeader Header;
+	Header.StartUtcTicks = FDateTime::UtcNow().GetTicks();
+	Header.StartCycles = FPlatformTime::Cycles64();
+	Header.SecondsPerCycle = FPlatformTime::GetSecondsPerCycle64();
+	*FileAr << Header;
+
+	// discard what was left by late records of the previous session
+	TArray<FSelectorAuditRecord> StaleRecords;
+	GetBuffers().DrainAll(StaleRecords);
+
+	Session.Writer = MakeUnique<FAuditWriter>(FileAr);
+	Session.Thread.Reset(FRunnableThread::Create(Session.Writer.Get(), TEXT("FenixSelectorAuditWriter"), 0, TPri_BelowNormal));
+	if (!Session.Thread)
+	{
+		Session.Writer.Reset();
+		return false;
+	}
+
+	bEnabled.store(true, std::memory_order_relaxed);
+	return true;
+}
+
+void FSelectorAuditLog::Stop()
+{
+	FAuditSession& Session = GetSession();
+	FScopeLock ScopeLock(&Session.Lock);
+	if (!Session.Thread)
+	{
+		return;
+	}
+
+	// records racing with the stop may land after the final flush, and are discarded by the next start
+	bEnabled.store(false, std::memory_order_relaxed);
+	Session.Thread->Kill(true);
+	Session.Thread.Reset();
+	Session.Writer.Reset();
+}
+
+void FSelectorAuditLog::Record(const uint32 TableId, const int32 SelectedIndex, const int32 StreamSeed)
+{
+	FAuditRing* Ring = LocalRing.Ring;
+	if (!Ring)
+	{
+		Ring = new FAuditRing();
+		Ring->ThreadId = FPlatformTLS::GetCurrentThreadId();
+		FAuditBuffers& Buffers = GetBuffers();
+		FScopeLock ScopeLock(&Buffers.RingsLock);
+		Buffers.Rings.Add(Ring);
+		LocalRing.Ring = Ring;
+	}
+
+	FSelectorAuditRecord Record;
+	Record.Timestamp = FPlatformTime::Cycles64();
+	Record.TableId = TableId;
+	Record.SelectedIndex = SelectedIndex;
+	Record.StreamSeed = StreamSeed;
+	Record.ThreadId = Ring->ThreadId;
+	if (!Ring->Push(Record))  // writer is behind: fall back to the locked overflow rather than losing the record
+	{
+		FAuditBuffers& Buffers = GetBuffers();
+		FScopeLock ScopeLock(&Buffers.OverflowLock);
+		Buffers.OverflowRecords.Add(Record);
+	}
+}
+
+uint32 FSelectorAuditLog::MakeTableId(const TArray<double>& Values)
+{
+	return FCrc::MemCrc32(Values.GetData(), Values.Num() * sizeof(double));
+}
+
+bool FSelectorAuditLog::ReadFile(const FString& FilePath, TArray<FSelectorAuditRecord>& OutRecords)
+{
+	FAuditFileHeader Header;
+	return ReadAuditFile(FilePath, Header, OutRecords);
+}
+
+bool FSelectorAuditLog::ExportCsv(const FString& FilePath, const FString& CsvFilePath)
+{
+	FAuditFileHeader Header;
+	TArray<FSelectorAuditRecord> Records;
+	if (!ReadAuditFile(FilePath, Header, Records))
+	{
+		return false;
+	}
+
+	TArray<FString> Lines;
+	Lines.Reserve(Records.Num() + 1);
+	Lines.Add(TEXT("UtcTime,SecondsSinceStart,ThreadId,TableId,SelectedIndex,StreamSeed"));
+	for (const FSelectorAuditRecord& Record : Records)
+	{
+		const double SecondsSinceStart = static_cast<int64>(Record.Timestamp - Header.StartCycles) * Header.SecondsPerCycle;
+		const FDateTime UtcTime = FDateTime(Header.StartUtcTicks) + FTimespan::FromSeconds(SecondsSinceStart);
+		Lines.Add(FString::Printf(TEXT("%s,%.9f,%u,%08X,%d,%d"),
+			*UtcTime.ToIso8601(), SecondsSinceStart, Record.ThreadId, Record.TableId, Record.SelectedIndex, Record.StreamSeed));
+	}
+	return FFileHelper::SaveStringArrayToFile(Lines, *CsvFilePath);
+}
@@ -0,0 +1,251 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+
+#include "SelectorCallSiteUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+	/** The call site being executed on the current thread. */
+	struct FActiveCallSite
+	{
+		FName CallSite;
+		uint64 StartCycles = 0;
+		int32 InputSize = 0;
+		bool bActive = false;
+	};
+
+	thread_local FActiveCallSite ActiveCallSite;
+
+	/** Stats recorded by one thread. Its lock is only contended by readers (dump, reset), never by other recording threads. */
+	struct FThreadCallSiteStats
+	{
+		FCriticalSection Lock;
+		TMap<FName, FSelectorCallSiteStats> Stats;
+	};
+
+	/** The stats of all the threads that have recorded, and those merged from exited threads. */
+	struct FCallSiteStatsThreads
+	{
+		FCriticalSection Lock;
+		TArray<FThreadCallSiteStats*> Threads;
+		TMap<FName, FSelectorCallSiteStats> ExitedThreadStats;
+	};
+
+	FCallSiteStatsThreads& GetCallSiteStatsThreads()
+	{
+		static FCallSiteStatsThreads StatsThreads;
+		return StatsThreads;
+	}
+
+	void MergeCallSiteStats(const TMap<FName, FSelectorCallSiteStats>& From, TMap<FName, FSelectorCallSiteStats>& To)
+	{
+		for (const TPair<FName, FSelectorCallSiteStats>& Pair : From)
+		{
+			To.FindOrAdd(Pair.Key).Merge(Pair.Value);
+		}
+	}
+
+	/** Stats of the current thread, registered by its first recorded call and merged into the exited thread stats when the thread exits. */
+	struct FLocalCallSiteStatsOwner
+	{
+		FThreadCallSiteStats* ThreadStats = nullptr;
+
+		FThreadCallSiteStats& GetOrRegister()
+		{
+			if (!ThreadStats)
+			{
+				ThreadStats = new FThreadCallSiteStats();
+				FCallSiteStatsThreads& StatsThreads = GetCallSiteStatsThreads();
+				FScopeLock ScopeLock(&StatsThreads.Lock);
+				StatsThreads.Threads.Add(ThreadStats);
+			}
+			return *ThreadStats;
+		}
+
+		~FLocalCallSiteStatsOwner()
+		{
+			if (!ThreadStats)
+			{
+				return;
+			}
+
+			FCallSiteStatsThreads& StatsThreads = GetCallSiteStatsThreads();
+			{
+				FScopeLock ScopeLock(&StatsThreads.Lock);
+				StatsThreads.Threads.RemoveSingleSwap(ThreadStats);
+				MergeCallSiteStats(ThreadStats->Stats, StatsThreads.ExitedThreadStats);
+			}
+			delete ThreadStats;
+		}
+	};
+
+	thread_local FLocalCallSiteStatsOwner LocalCallSiteStats;
+
+#if FENIX_WITH_CALL_SITE_TRACKING
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice DumpCallSitesCommand(
+		TEXT("Fenix.Selector.DumpCallSites"),
+		TEXT("Dump the Blueprint selector call sites sorted by table size multiplied by calls per second. Optional argument: number of call sites to show."),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			const int32 TopN = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 20;
+			FSelectorCallSiteRegistry::Get().Dump(Ar, TopN);
+		}));
+
+	FAutoConsoleCommand ResetCallSitesCommand(
+		TEXT("Fenix.Selector.ResetCallSites"),
+		TEXT("Reset the statistics of the Blueprint selector call sites."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FSelectorCallSiteRegistry::Get().Reset();
+		}));
+#endif
+}
+
+double FSelectorCallSiteStats::GetCallsPerSecond() const
+{
+	const double Duration = LastCallTime - FirstCallTime;
+	return Duration > 0.0 ? NumCalls / Duration : static_cast<double>(NumCalls);  // a single burst counts as one second
+}
+
+void FSelectorCallSiteStats::Merge(const FSelectorCallSiteStats& Other)
+{
+	if (Other.NumCalls == 0)
+	{
+		return;
+	}
+	FirstCallTime = NumCalls > 0 ? FMath::Min(FirstCallTime, Other.FirstCallTime) : Other.FirstCallTime;
+	LastCallTime = NumCalls > 0 ? FMath::Max(LastCallTime, Other.LastCallTime) : Other.LastCallTime;
+	NumCalls += Other.NumCalls;
+	TotalCycles += Other.TotalCycles;
+	TotalInputSize += Other.TotalInputSize;
+	MaxInputSize = FMath::Max(MaxInputSize, Other.MaxInputSize);
+}
+
+double FSelectorCallSiteStats::GetScore() const
+{
+	if (NumCalls == 0)
+	{
+		return 0.0;
+	}
+	const double AverageInputSize = static_cast<double>(TotalInputSize) / NumCalls;
+	return AverageInputSize * GetCallsPerSecond();
+}
+
+FSelectorCallSiteRegistry& FSelectorCallSiteRegistry::Get()
+{
+	static FSelectorCallSiteRegistry Registry;
+	return Registry;
+}
+
+void FSelectorCallSiteRegistry::BeginCallSite(const FName CallSite)
+{
+	ActiveCallSite.CallSite = CallSite;
+	ActiveCallSite.InputSize = 0;
+	ActiveCallSite.bActive = true;
+	ActiveCallSite.StartCycles = FPlatformTime::Cycles64();
+}
+
+void FSelectorCallSiteRegistry::EndCallSite()
+{
+	if (!ActiveCallSite.bActive)
+	{
+		return;
+	}
+
+	const uint64 Cycles = FPlatformTime::Cycles64() - ActiveCallSite.StartCycles;
+	const double Now = FPlatformTime::Seconds();
+	ActiveCallSite.bActive = false;
+
+	FThreadCallSiteStats& ThreadStats = LocalCallSiteStats.GetOrRegister();
+	FScopeLock ScopeLock(&ThreadStats.Lock);  // uncontended unless stats are being read
+	FSelectorCallSiteStats& SiteStats = ThreadStats.Stats.FindOrAdd(ActiveCallSite.CallSite);
+	if (SiteStats.NumCalls == 0)
+	{
+		SiteStats.FirstCallTime = Now;
+	}
+	SiteStats.NumCalls++;
+	SiteStats.TotalCycles += Cycles;
+	SiteStats.TotalInputSize += ActiveCallSite.InputSize;
+	SiteStats.MaxInputSize = FMath::Max(SiteStats.MaxInputSize, ActiveCallSite.InputSize);
+	SiteStats.LastCallTime = Now;
+}
+
+void FSelectorCallSiteRegistry::ReportInputSize(const int32 InputSize)
+{
+	if (ActiveCallSite.bActive)
+	{
+		ActiveCallSite.InputSize = FMath::Max(ActiveCallSite.InputSize, InputSize);  // nested calls (e.g. cooked -> cum weights) report the same table
+	}
+}
+
+void FSelectorCallSiteRegistry::GetSortedStats(TArray<TPair<FName, FSelectorCallSiteStats>>& OutStats) const
+{
+	{
+		FCallSiteStatsThreads& StatsThreads = GetCallSiteStatsThreads();
+		FScopeLock ScopeLock(&StatsThreads.Lock);
+		TMap<FName, FSelectorCallSiteStats> MergedStats = StatsThreads.ExitedThreadStats;
+		for (FThreadCallSiteStats* ThreadStats : StatsThreads.Threads)
+		{
+			FScopeLock ThreadScopeLock(&ThreadStats->Lock);
+			MergeCallSiteStats(ThreadStats->Stats, MergedStats);
+		}
+		OutStats = MergedStats.Array();
+	}
+	OutStats.Sort([](const TPair<FName, FSelectorCallSiteStats>& A, const TPair<FName, FSelectorCallSiteStats>& B)
+	{
+		return A.Value.GetScore() > B.Value.GetScore();
+	});
+}
+
+void FSelectorCallSiteRegistry::Reset()
+{
+	FCallSiteStatsThreads& StatsThreads = GetCallSiteStatsThreads();
+	FScopeLock ScopeLock(&StatsThreads.Lock);
+	StatsThreads.ExitedThreadStats.Reset();
+	for (FThreadCallSiteStats* ThreadStats : StatsThreads.Threads)
+	{
+		FScopeLock ThreadScopeLock(&ThreadStats->Lock);
+		ThreadStats->Stats.Reset();
+	}
+}
+
+void FSelectorCallSiteRegistry::Dump(FOutputDevice& Ar, const int32 TopN) const
+{
+	TArray<TPair<FName, FSelectorCallSiteStats>> SortedStats;
+	GetSortedStats(SortedStats);
+
+	const int32 NumToShow = TopN > 0 ? FMath::Min(TopN, SortedStats.Num()) : SortedStats.Num();
+	Ar.Logf(TEXT("Fenix selector call sites: showing %d of %d, sorted by average table size * calls per second"), NumToShow, SortedStats.Num());
+	Ar.Logf(TEXT("%12s %10s %10s %10s %10s %12s %12s  %s"), TEXT("Score"), TEXT("Calls"), TEXT("Calls/s"), TEXT("AvgSize"), TEXT("MaxSize"), TEXT("AvgTime(us)"), TEXT("Total(ms)"), TEXT("CallSite"));
+	for (int32 Idx = 0; Idx < NumToShow; Idx++)
+	{
+		const FName CallSite = SortedStats[Idx].Key;
+		const FSelectorCallSiteStats& SiteStats = SortedStats[Idx].Value;
+		const double TotalMs = FPlatformTime::ToMilliseconds64(SiteStats.TotalCycles);
+		Ar.Logf(TEXT("%12.1f %10llu %10.1f %10.1f %10d %12.3f %12.3f  %s"),
+			SiteStats.GetScore(),
+			SiteStats.NumCalls,
+			SiteStats.GetCallsPerSecond(),
+			SiteStats.NumCalls > 0 ? static_cast<double>(SiteStats.TotalInputSize) / SiteStats.NumCalls : 0.0,
+			SiteStats.MaxInputSize,
+			SiteStats.NumCalls > 0 ? TotalMs * 1000.0 / SiteStats.NumCalls : 0.0,
+			TotalMs,
+			*CallSite.ToString());
+	}
+}
+
+void USelectorCallSiteUtils::BeginSelectorCallSite(const FName CallSite)
+{
+#if FENIX_WITH_CALL_SITE_TRACKING
+	FSelectorCallSiteRegistry::Get().BeginCallSite(CallSite);
+#endif
+}
+
+void USelectorCallSiteUtils::EndSelectorCallSite()
+{
+#if FENIX_WITH_CALL_SITE_TRACKING
+	FSelectorCallSiteRegistry::Get().EndCallSite();
+#endif
+}
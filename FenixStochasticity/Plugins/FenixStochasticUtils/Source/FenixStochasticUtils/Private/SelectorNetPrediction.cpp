@@ -0,0 +1,51 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+
+#include "SelectorNetPrediction.h"
+
+bool FSelectorNetRandomState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << Seed;
+
+	// counters stay small in a session, so they mostly take 1 to 3 bytes
+	uint32 PackedCounter = static_cast<uint32>(Counter);
+	Ar.SerializeIntPacked(PackedCounter);
+	if (Ar.IsLoading())
+	{
+		Counter = static_cast<int32>(PackedCounter);
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+FRandomStream FSelectorNetRandomState::MakeStream(const int32 PredictionKey) const
+{
+	// Murmur3 64 bit finalizer over (Seed, Key), avoiding the platform dependent hashes so that every build rolls alike
+	uint64 Hash = (static_cast<uint64>(static_cast<uint32>(Seed)) << 32) | static_cast<uint32>(PredictionKey);
+	Hash ^= Hash >> 33;
+	Hash *= 0xff51afd7ed558ccdull;
+	Hash ^= Hash >> 33;
+	Hash *= 0xc4ceb9fe1a85ec53ull;
+	Hash ^= Hash >> 33;
+	return FRandomStream(static_cast<int32>(Hash ^ (Hash >> 32)));
+}
+
+FSelectorNetRandomState USelectorNetPredictionUtils::MakeNetRandomState(const int32 Seed)
+{
+	FSelectorNetRandomState State;
+	State.Seed = Seed;
+	return State;
+}
+
+int32 USelectorNetPredictionUtils::SelectWithNetRandomState(const FCookedSelectorDistribution& Distribution, FSelectorNetRandomState& State, int32& OutPredictionKey)
+{
+	OutPredictionKey = State.Counter++;
+	return PredictSelectionWithNetRandomState(Distribution, State, OutPredictionKey);
+}
+
+int32 USelectorNetPredictionUtils::PredictSelectionWithNetRandomState(const FCookedSelectorDistribution& Distribution, const FSelectorNetRandomState& State, const int32 PredictionKey)
+{
+	const FRandomStream RandomStream = State.MakeStream(PredictionKey);
+	return USelectorUtils::SelectWithCookedDistribution(Distribution, &RandomStream);
+}
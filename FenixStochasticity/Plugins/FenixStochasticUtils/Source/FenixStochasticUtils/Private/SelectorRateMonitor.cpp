@@ -0,0 +1,303 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+
+#include "SelectorRateMonitor.h"
+#include "Async/Async.h"
+#include "Misc/ScopeLock.h"
+#include <cmath>
+
+namespace
+{
+	/** Counters per cache line. */
+	constexpr int32 CountersPerCacheLine = PLATFORM_CACHE_LINE_SIZE / sizeof(uint64);
+
+	int32 GetShardOfCurrentThread(const int32 NumShards)
+	{
+		thread_local const uint32 ThreadHash = FPlatformTLS::GetCurrentThreadId() * 2654435761u;  // Knuth's multiplicative hash, thread ids are often multiples of 4
+		return static_cast<int32>(ThreadHash >> 16) & (NumShards - 1);
+	}
+}
+
+TSharedRef<FSelectorRateMonitor, ESPMode::ThreadSafe> FSelectorRateMonitor::Create(const FCookedSelectorDistribution& InDistribution,
+	const double InSignificanceLevel, const float InCheckInterval, const uint64 InMinSamples, const ESelectorRateTest InTest)
+{
+	TSharedRef<FSelectorRateMonitor, ESPMode::ThreadSafe> Monitor = MakeShareable(new FSelectorRateMonitor(InDistribution, InSignificanceLevel, InCheckInterval, InMinSamples, InTest));
+	TWeakPtr<FSelectorRateMonitor, ESPMode::ThreadSafe> WeakMonitor = Monitor;
+	Monitor->TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakMonitor](float DeltaTime)
+	{
+		const TSharedPtr<FSelectorRateMonitor, ESPMode::ThreadSafe> PinnedMonitor = WeakMonitor.Pin();
+		return PinnedMonitor ? PinnedMonitor->OnTick(DeltaTime) : false;
+	}), InCheckInterval);
+	return Monitor;
+}
+
+FSelectorRateMonitor::FSelectorRateMonitor(const FCookedSelectorDistribution& InDistribution, const double InSignificanceLevel, const float InCheckInterval, const uint64 InMinSamples, const ESelectorRateTest InTest)
+	: Distribution(InDistribution)
+	, SignificanceLevel(InSignificanceLevel)
+	, CheckInterval(InCheckInterval)
+	, MinSamples(InMinSamples)
+	, Test(InTest)
+{
+	const TArray<double>& Cums = Distribution.CumWeightsOrCumProbs;
+	const int32 Num = Cums.Num();
+	ExpectedProbs.SetNumZeroed(Num + 1);
+	if (Distribution.bIsProbs)  // the roll is in [0, 1), anything beyond 1 is never reached, anything below 1 selects nothing
+	{
+		double PrevCum = 0.0;
+		for (int32 Idx = 0; Idx < Num; Idx++)
+		{
+			const double Cum = FMath::Clamp(Cums[Idx], PrevCum, 1.0);
+			ExpectedProbs[Idx] = Cum - PrevCum;
+			PrevCum = Cum;
+		}
+		ExpectedProbs[Num] = 1.0 - PrevCum;
+	}
+	else if (Num > 0 && Cums[Num - 1] > 0.0)
+	{
+		const double InvSumWeight = 1.0 / Cums[Num - 1];
+		double PrevCum = 0.0;
+		for (int32 Idx = 0; Idx < Num; Idx++)
+		{
+			const double Cum = FMath::Max(Cums[Idx], PrevCum);
+			ExpectedProbs[Idx] = (Cum - PrevCum) * InvSumWeight;
+			PrevCum = Cum;
+		}
+	}
+	else
+	{
+		ExpectedProbs[Num] = 1.0;
+	}
+
+	ShardStride = Align(ExpectedProbs.Num(), CountersPerCacheLine);  // no false sharing between shards
+	ShardCounts = MakeUnique<std::atomic<uint64>[]>(NumShards * ShardStride);
+	WindowStartCounts.SetNumZeroed(ExpectedProbs.Num());
+}
+
+FSelectorRateMonitor::~FSelectorRateMonitor()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+}
+
+void FSelectorRateMonitor::RecordSelection(const int32 SelectedIndex)
+{
+	const int32 NoneIndex = ExpectedProbs.Num() - 1;
+	const int32 CounterIndex = SelectedIndex >= 0 && SelectedIndex < NoneIndex ? SelectedIndex : NoneIndex;
+	ShardCounts[GetShardOfCurrentThread(NumShards) * ShardStride + CounterIndex].fetch_add(1, std::memory_order_relaxed);
+}
+
+int32 FSelectorRateMonitor::Select(const FRandomStream* RandomStream)
+{
+	const int32 SelectedIndex = USelectorUtils::SelectWithCookedDistribution(Distribution, RandomStream);
+	RecordSelection(SelectedIndex);
+	return SelectedIndex;
+}
+
+void FSelectorRateMonitor::SnapshotCounts(TArray<uint64>& OutCounts) const
+{
+	OutCounts.SetNumZeroed(ExpectedProbs.Num());
+	for (int32 Shard = 0; Shard < NumShards; Shard++)
+	{
+		const std::atomic<uint64>* Counts = &ShardCounts[Shard * ShardStride];
+		for (int32 Idx = 0; Idx < OutCounts.Num(); Idx++)
+		{
+			OutCounts[Idx] += Counts[Idx].load(std::memory_order_relaxed);
+		}
+	}
+}
+
+FSelectorRateTestResult FSelectorRateMonitor::RunTestNow() const
+{
+	TArray<uint64> WindowCounts;
+	SnapshotCounts(WindowCounts);
+	{
+		FScopeLock ScopeLock(&WindowLock);
+		for (int32 Idx = 0; Idx < WindowCounts.Num(); Idx++)
+		{
+			WindowCounts[Idx] -= WindowStartCounts[Idx];
+		}
+	}
+	return RunTest(WindowCounts);
+}
+
+void FSelectorRateMonitor::ResetWindow()
+{
+	TArray<uint64> Counts;
+	SnapshotCounts(Counts);
+	FScopeLock ScopeLock(&WindowLock);
+	WindowStartCounts = MoveTemp(Counts);
+}
+
+bool FSelectorRateMonitor::OnTick(float DeltaTime)
+{
+	if (bTestInFlight.exchange(true))  // the previous test is still running, skip this round
+	{
+		return true;
+	}
+
+	TWeakPtr<FSelectorRateMonitor, ESPMode::ThreadSafe> WeakMonitor = AsShared();
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [WeakMonitor]()
+	{
+		const TSharedPtr<FSelectorRateMonitor, ESPMode::ThreadSafe> Monitor = WeakMonitor.Pin();
+		if (!Monitor)
+		{
+			return;
+		}
+
+		TArray<uint64> Counts;
+		Monitor->SnapshotCounts(Counts);
+		TArray<uint64> WindowCounts = Counts;
+		uint64 NumSamples = 0;
+		{
+			FScopeLock ScopeLock(&Monitor->WindowLock);
+			for (int32 Idx = 0; Idx < WindowCounts.Num(); Idx++)
+			{
+				WindowCounts[Idx] -= Monitor->WindowStartCounts[Idx];
+				NumSamples += WindowCounts[Idx];
+			}
+			if (NumSamples >= Monitor->MinSamples)  // tumbling windows, so a drift starting late is not diluted by the history
+			{
+				Monitor->WindowStartCounts = MoveTemp(Counts);
+			}
+		}
+
+		if (NumSamples >= Monitor->MinSamples)
+		{
+			const FSelectorRateTestResult Result = Monitor->RunTest(WindowCounts);
+			if (Result.PValue < Monitor->SignificanceLevel)
+			{
+				AsyncTask(ENamedThreads::GameThread, [WeakMonitor, Result]()
+				{
+					if (const TSharedPtr<FSelectorRateMonitor, ESPMode::ThreadSafe> GameThreadMonitor = WeakMonitor.Pin())
+					{
+						GameThreadMonitor->OnDriftDetected.Broadcast(Result);
+					}
+				});
+			}
+		}
+		Monitor->bTestInFlight.store(false);
+	});
+	return true;
+}
+
+FSelectorRateTestResult FSelectorRateMonitor::RunTest(const TArray<uint64>& WindowCounts) const
+{
+	FSelectorRateTestResult Result;
+	for (const uint64 Count : WindowCounts)
+	{
+		Result.NumSamples += Count;
+	}
+	if (Result.NumSamples == 0)
+	{
+		return Result;
+	}
+
+	const double NumSamples = static_cast<double>(Result.NumSamples);
+	const int32 NoneIndex = ExpectedProbs.Num() - 1;
+	int32 NumPossibleOutcomes = 0;
+	double WorstResidual = -1.0;
+	for (int32 Idx = 0; Idx < ExpectedProbs.Num(); Idx++)
+	{
+		const double Observed = static_cast<double>(WindowCounts[Idx]);
+		const double Expected = ExpectedProbs[Idx] * NumSamples;
+		if (Expected <= 0.0)
+		{
+			if (Observed > 0.0)  // an impossible outcome, no need of statistics
+			{
+				Result.Statistic = TNumericLimits<double>::Max();
+				Result.PValue = 0.0;
+				Result.WorstIndex = Idx == NoneIndex ? INDEX_NONE : Idx;
+				Result.ObservedFrequency = Observed / NumSamples;
+				Result.ExpectedFrequency = 0.0;
+				return Result;
+			}
+			continue;
+		}
+
+		NumPossibleOutcomes++;
+		if (Test == ESelectorRateTest::ChiSquare)
+		{
+			Result.Statistic += FMath::Square(Observed - Expected) / Expected;
+		}
+		else if (Observed > 0.0)
+		{
+			Result.Statistic += 2.0 * Observed * FMath::Loge(Observed / Expected);
+		}
+
+		const double Residual = FMath::Abs(Observed - Expected) / FMath::Sqrt(Expected);  // standardized (Pearson) residual
+		if (Residual > WorstResidual)
+		{
+			WorstResidual = Residual;
+			Result.WorstIndex = Idx == NoneIndex ? INDEX_NONE : Idx;
+			Result.ObservedFrequency = Observed / NumSamples;
+			Result.ExpectedFrequency = ExpectedProbs[Idx];
+		}
+	}
+
+	Result.DegreesOfFreedom = NumPossibleOutcomes - 1;
+	Result.PValue = Result.DegreesOfFreedom > 0 && Result.Statistic > 0.0 ? RegularizedUpperGamma(0.5 * Result.DegreesOfFreedom, 0.5 * Result.Statistic) : 1.0;
+	return Result;
+}
+
+double FSelectorRateMonitor::RegularizedUpperGamma(const double A, const double X)
+{
+	if (X <= 0.0)
+	{
+		return 1.0;
+	}
+	if (A <= 0.0)
+	{
+		return 0.0;
+	}
+
+	constexpr int32 MaxIterations = 500;
+	constexpr double Epsilon = 1e-15;
+	const double LogPrefactor = -X + A * FMath::Loge(X) - std::lgamma(A);
+
+	if (X < A + 1.0)  // series of the lower function P converges quickly here
+	{
+		double Term = 1.0 / A;
+		double Sum = Term;
+		double Denominator = A;
+		for (int32 Iter = 0; Iter < MaxIterations; Iter++)
+		{
+			Denominator += 1.0;
+			Term *= X / Denominator;
+			Sum += Term;
+			if (FMath::Abs(Term) < FMath::Abs(Sum) * Epsilon)
+			{
+				break;
+			}
+		}
+		return FMath::Max(1.0 - Sum * FMath::Exp(LogPrefactor), 0.0);
+	}
+
+	// continued fraction of Q, evaluated with the modified Lentz's method
+	constexpr double Tiny = 1e-300;
+	double B = X + 1.0 - A;
+	double C = 1.0 / Tiny;
+	double D = 1.0 / B;
+	double Fraction = D;
+	for (int32 Iter = 1; Iter <= MaxIterations; Iter++)
+	{
+		const double An = -Iter * (Iter - A);
+		B += 2.0;
+		D = An * D + B;
+		if (FMath::Abs(D) < Tiny)
+		{
+			D = Tiny;
+		}
+		C = B + An / C;
+		if (FMath::Abs(C) < Tiny)
+		{
+			C = Tiny;
+		}
+		D = 1.0 / D;
+		const double Delta = D * C;
+		Fraction *= Delta;
+		if (FMath::Abs(Delta - 1.0) < Epsilon)
+		{
+			break;
+		}
+	}
+	return FMath::Exp(LogPrefactor) * Fraction;
+}
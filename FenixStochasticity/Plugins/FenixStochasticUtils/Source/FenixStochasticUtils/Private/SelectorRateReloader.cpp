@@ -0,0 +1,358 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+
+#include "SelectorRateReloader.h"
+#include "Async/Async.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/JsonReader.h"
+
+const FName FSelectorRateReloader::DefaultTableName(TEXT("Default"));
+
+namespace
+{
+	enum class ECsvRecordResult : uint8
+	{
+		Record,
+		EndOfText,
+		UnterminatedQuote,
+	};
+
+	/**
+	* Read the next CSV record at Cursor into Fields and move Cursor past it. Quoted fields may hold commas, line breaks and doubled quotes,
+	* but must be closed before the end of the text.
+	*/
+	ECsvRecordResult ReadCsvRecord(const TCHAR*& Cursor, TArray<FString>& Fields)
+	{
+		Fields.Reset();
+		if (*Cursor == TEXT('\0'))
+		{
+			return ECsvRecordResult::EndOfText;
+		}
+
+		FString Field;
+		bool bInQuotes = false;
+		for (;; Cursor++)
+		{
+			const TCHAR Char = *Cursor;
+			if (bInQuotes)
+			{
+				if (Char == TEXT('\0'))
+				{
+					return ECsvRecordResult::UnterminatedQuote;
+				}
+				if (Char != TEXT('"'))
+				{
+					Field.AppendChar(Char);
+				}
+				else if (Cursor[1] == TEXT('"'))
+				{
+					Field.AppendChar(TEXT('"'));
+					Cursor++;
+				}
+				else
+				{
+					bInQuotes = false;
+				}
+			}
+			else if (Char == TEXT('"'))
+			{
+				bInQuotes = true;
+			}
+			else if (Char == TEXT(','))
+			{
+				Fields.Add(MoveTemp(Field));
+				Field.Reset();
+			}
+			else if (Char == TEXT('\r') || Char == TEXT('\n') || Char == TEXT('\0'))
+			{
+				if (Char == TEXT('\r') && Cursor[1] == TEXT('\n'))
+				{
+					Cursor++;
+				}
+				if (Char != TEXT('\0'))
+				{
+					Cursor++;
+				}
+				break;
+			}
+			else
+			{
+				Field.AppendChar(Char);
+			}
+		}
+		Fields.Add(MoveTemp(Field));
+		return ECsvRecordResult::Record;
+	}
+
+	bool TryParseWeightOrProb(const FString& Text, double& OutValue)
+	{
+		return LexTryParseString(OutValue, *Text.TrimStartAndEnd()) && FMath::IsFinite(OutValue);
+	}
+
+	bool IsIsProbName(const FString& Name)
+	{
+		return Name.Equals(TEXT("IsProb"), ESearchCase::IgnoreCase) || Name.Equals(TEXT("bIsProb"), ESearchCase::IgnoreCase);
+	}
+}
+
+TSharedRef<FSelectorRateReloader, ESPMode::ThreadSafe> FSelectorRateReloader::Create()
+{
+	return MakeShareable(new FSelectorRateReloader());
+}
+
+void FSelectorRateReloader::RegisterTable(const FName TableName, const TSharedRef<FSharedCookedDistribution, ESPMode::ThreadSafe>& Table)
+{
+	FScopeLock ScopeLock(&TablesLock);
+	Tables.Add(TableName, Table);
+}
+
+void FSelectorRateReloader::UnregisterTable(const FName TableName)
+{
+	FScopeLock ScopeLock(&TablesLock);
+	Tables.Remove(TableName);
+}
+
+bool FSelectorRateReloader::ReloadFromFile(const FString& FilePath)
+{
+	if (bReloading.exchange(true))
+	{
+		return false;
+	}
+
+	TWeakPtr<FSelectorRateReloader, ESPMode::ThreadSafe> WeakReloader = AsShared();
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [WeakReloader, FilePath]()
+	{
+		const TSharedPtr<FSelectorRateReloader, ESPMode::ThreadSafe> Reloader = WeakReloader.Pin();
+		if (!Reloader)
+		{
+			return;
+		}
+
+		FString Error;
+		const bool bSucceeded = Reloader->RunReload(FilePath, Error);
+		if (bSucceeded)
+		{
+			Reloader->NumReloads++;
+		}
+		Reloader->bReloading.store(false);
+
+		AsyncTask(ENamedThreads::GameThread, [WeakReloader, bSucceeded, Error]()
+		{
+			if (const TSharedPtr<FSelectorRateReloader, ESPMode::ThreadSafe> GameThreadReloader = WeakReloader.Pin())
+			{
+				GameThreadReloader->OnReloaded.Broadcast(bSucceeded, Error);
+			}
+		});
+	});
+	return true;
+}
+
+bool FSelectorRateReloader::RunReload(const FString& FilePath, FString& OutError)
+{
+	TMap<FName, TArray<FWeightOrProbEntry>> TableEntries;
+	if (!ParseRateFile(FilePath, TableEntries, OutError))
+	{
+		return false;
+	}
+
+	// cook every table before publishing any, so a broken table leaves all the previous rates in use;
+	// the publishes themselves are per table, so a reader rolling several tables meanwhile may see some old and some new
+	TArray<TPair<TSharedRef<FSharedCookedDistribution, ESPMode::ThreadSafe>, const TArray<FWeightOrProbEntry>*>> TablesToCook;
+	{
+		FScopeLock ScopeLock(&TablesLock);
+		for (const TPair<FName, TArray<FWeightOrProbEntry>>& Pair : TableEntries)
+		{
+			const TSharedRef<FSharedCookedDistribution, ESPMode::ThreadSafe>* Table = Tables.Find(Pair.Key);
+			if (Table && Pair.Value.Num() == 0)
+			{
+				OutError = FString::Printf(TEXT("Table %s has no entries."), *Pair.Key.ToString());
+				return false;
+			}
+			if (Table)
+			{
+				TablesToCook.Emplace(*Table, &Pair.Value);
+			}
+		}
+	}
+
+	TArray<FCookedSelectorDistribution> Distributions;
+	Distributions.SetNum(TablesToCook.Num());
+	for (int32 TableIdx = 0; TableIdx < TablesToCook.Num(); TableIdx++)
+	{
+		USelectorUtils::CookSelectorDistribution(*TablesToCook[TableIdx].Value, Distributions[TableIdx]);
+	}
+	for (int32 TableIdx = 0; TableIdx < TablesToCook.Num(); TableIdx++)
+	{
+		TablesToCook[TableIdx].Key->Publish(Distributions[TableIdx]);
+	}
+	return true;
+}
+
+bool FSelectorRateReloader::ParseRateFile(const FString& FilePath, TMap<FName, TArray<FWeightOrProbEntry>>& OutTableEntries, FString& OutError)
+{
+	FString Text;
+	if (!FFileHelper::LoadFileToString(Text, *FilePath))
+	{
+		OutError = FString::Printf(TEXT("Failed to read %s."), *FilePath);
+		return false;
+	}
+	return FPaths::GetExtension(FilePath).Equals(TEXT("json"), ESearchCase::IgnoreCase)
+		? ParseRatesJson(Text, OutTableEntries, OutError)
+		: ParseRatesCsv(Text, OutTableEntries, OutError);
+}
+
+bool FSelectorRateReloader::ParseRatesCsv(const FString& Text, TMap<FName, TArray<FWeightOrProbEntry>>& OutTableEntries, FString& OutError)
+{
+	OutTableEntries.Reset();
+
+	const TCHAR* Cursor = *Text;
+	TArray<FString> Fields;
+	const ECsvRecordResult HeaderResult = ReadCsvRecord(Cursor, Fields);
+	if (HeaderResult != ECsvRecordResult::Record)
+	{
+		OutError = HeaderResult == ECsvRecordResult::EndOfText ? TEXT("Empty CSV.") : TEXT("Unterminated quoted field in the CSV header.");
+		return false;
+	}
+	int32 TableColumn = INDEX_NONE;
+	int32 ValueColumn = INDEX_NONE;
+	int32 IsProbColumn = INDEX_NONE;
+	for (int32 Column = 0; Column < Fields.Num(); Column++)
+	{
+		const FString Name = Fields[Column].TrimStartAndEnd();
+		if (Name.Equals(TEXT("Table"), ESearchCase::IgnoreCase))
+		{
+			TableColumn = Column;
+		}
+		else if (Name.Equals(TEXT("WeightOrProb"), ESearchCase::IgnoreCase))
+		{
+			ValueColumn = Column;
+		}
+		else if (IsIsProbName(Name))
+		{
+			IsProbColumn = Column;
+		}
+	}
+	if (ValueColumn == INDEX_NONE)
+	{
+		OutError = TEXT("No WeightOrProb column in the CSV header.");
+		return false;
+	}
+
+	for (int32 Record = 1;; Record++)
+	{
+		const ECsvRecordResult Result = ReadCsvRecord(Cursor, Fields);
+		if (Result == ECsvRecordResult::EndOfText)
+		{
+			break;
+		}
+		if (Result == ECsvRecordResult::UnterminatedQuote)
+		{
+			OutError = FString::Printf(TEXT("Unterminated quoted field in CSV record %d."), Record);
+			return false;
+		}
+		if (Fields.Num() == 1 && Fields[0].TrimStartAndEnd().IsEmpty())  // blank line
+		{
+			continue;
+		}
+
+		FWeightOrProbEntry Entry;
+		if (!Fields.IsValidIndex(ValueColumn) || !TryParseWeightOrProb(Fields[ValueColumn], Entry.WeightOrProb))
+		{
+			OutError = FString::Printf(TEXT("Invalid WeightOrProb in CSV record %d."), Record);
+			return false;
+		}
+		Entry.bIsProb = Fields.IsValidIndex(IsProbColumn) && FCString::ToBool(*Fields[IsProbColumn].TrimStartAndEnd());
+		const FString TableName = Fields.IsValidIndex(TableColumn) ? Fields[TableColumn].TrimStartAndEnd() : FString();
+		OutTableEntries.FindOrAdd(TableName.IsEmpty() ? DefaultTableName : FName(*TableName)).Add(Entry);
+	}
+	return true;
+}
+
+bool FSelectorRateReloader::ParseRatesJson(const FString& Text, TMap<FName, TArray<FWeightOrProbEntry>>& OutTableEntries, FString& OutError)
+{
+	OutTableEntries.Reset();
+
+	// pull parser over the tokens, nothing but the entries is built: the root (depth 1) holds the tables or is the default table,
+	// entries are one level below the tables
+	const TSharedRef<TJsonReader<TCHAR>> Reader = TJsonReaderFactory<TCHAR>::Create(Text);
+	EJsonNotation Notation;
+	int32 Depth = 0;
+	int32 EntryDepth = 3;
+	TArray<FWeightOrProbEntry>* Entries = nullptr;
+	FWeightOrProbEntry* Entry = nullptr;
+	while (Reader->ReadNext(Notation))
+	{
+		switch (Notation)
+		{
+		case EJsonNotation::ObjectStart:
+		case EJsonNotation::ArrayStart:
+			Depth++;
+			if (Depth == 1 && Notation == EJsonNotation::ArrayStart)
+			{
+				EntryDepth = 2;
+				Entries = &OutTableEntries.FindOrAdd(DefaultTableName);
+			}
+			else if (Depth == EntryDepth - 1 && Depth > 1)
+			{
+				if (Notation != EJsonNotation::ArrayStart)
+				{
+					OutError = FString::Printf(TEXT("Table %s is not an array."), *Reader->GetIdentifier());
+					return false;
+				}
+				Entries = &OutTableEntries.FindOrAdd(FName(*Reader->GetIdentifier()));
+			}
+			else if (Depth == EntryDepth && Notation == EJsonNotation::ObjectStart)
+			{
+				Entry = &Entries->AddDefaulted_GetRef();
+			}
+			else if (Depth > 1)
+			{
+				OutError = TEXT("Unexpected nesting in the rate JSON.");
+				return false;
+			}
+			break;
+
+		case EJsonNotation::ObjectEnd:
+		case EJsonNotation::ArrayEnd:
+			if (Depth == EntryDepth)
+			{
+				Entry = nullptr;
+			}
+			Depth--;
+			break;
+
+		case EJsonNotation::Number:
+			if (Depth == EntryDepth - 1 && Entries)  // plain weight
+			{
+				Entries->AddDefaulted_GetRef().WeightOrProb = Reader->GetValueAsNumber();
+			}
+			else if (Entry && Reader->GetIdentifier().Equals(TEXT("WeightOrProb"), ESearchCase::IgnoreCase))
+			{
+				Entry->WeightOrProb = Reader->GetValueAsNumber();
+			}
+			break;
+
+		case EJsonNotation::Boolean:
+			if (Entry && IsIsProbName(Reader->GetIdentifier()))
+			{
+				Entry->bIsProb = Reader->GetValueAsBoolean();
+			}
+			break;
+
+		case EJsonNotation::Error:
+			OutError = Reader->GetErrorMessage();
+			return false;
+
+		default:  // strings and nulls, e.g. row names
+			break;
+		}
+	}
+	if (!Reader->GetErrorMessage().IsEmpty())
+	{
+		OutError = Reader->GetErrorMessage();
+		return false;
+	}
+	return true;
+}
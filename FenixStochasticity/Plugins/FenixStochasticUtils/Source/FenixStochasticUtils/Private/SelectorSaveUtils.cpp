@@ -0,0 +1,457 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+
+#include "SelectorSaveUtils.h"
+#include "FenixStochasticStats.h"
+#include "SelectorAuditLog.h"
+#include "Async/ParallelFor.h"
+#include <atomic>
+
+namespace
+{
+	/** Fields present in the encoded bytes, the others being default. */
+	enum ESaveFieldMask : uint32
+	{
+		SaveField_Stream = 1 << 0,
+		SaveField_StreamAdvanced = 1 << 1,  // the current seed differs from the initial seed
+		SaveField_NetRandomState = 1 << 2,
+		SaveField_ShuffleBag = 1 << 3,
+		SaveField_Distribution = 1 << 4,
+		SaveField_PityCounters = 1 << 5,
+		SaveField_DistributionGuideTable = 1 << 6,  // only the bucket count, the table is rebuilt on decoding
+	};
+
+	/** Batches at least this large are encoded/decoded in parallel. */
+	constexpr int32 ParallelBatchThreshold = 256;
+
+	/** Largest encoded state read by the archive operator, so a corrupted size cannot allocate the world. */
+	constexpr uint32 MaxArchivedStateBytes = 16 * 1024 * 1024;
+
+	/** Sets the current seed of a stream, which FRandomStream keeps private, through its reflected Seed property. */
+	void SetStreamCurrentSeed(FRandomStream& Stream, const int32 InSeed)
+	{
+		static const FIntProperty* SeedProperty = CastField<FIntProperty>(TBaseStructure<FRandomStream>::Get()->FindPropertyByName(TEXT("Seed")));
+		check(SeedProperty);
+		SeedProperty->SetPropertyValue_InContainer(&Stream, InSeed);
+	}
+
+	struct FSaveWriter
+	{
+		TArray<uint8>& Bytes;
+
+		void WriteVarUInt64(uint64 Value)
+		{
+			while (Value >= 0x80)
+			{
+				Bytes.Add(static_cast<uint8>(Value) | 0x80);
+				Value >>= 7;
+			}
+			Bytes.Add(static_cast<uint8>(Value));
+		}
+
+		void WriteVarInt64(const int64 Value)
+		{
+			WriteVarUInt64((static_cast<uint64>(Value) << 1) ^ static_cast<uint64>(Value >> 63));  // zigzag, so small negatives stay short
+		}
+
+		void WriteFixed32(const uint32 Value)
+		{
+			const uint8 Data[4] = { static_cast<uint8>(Value), static_cast<uint8>(Value >> 8), static_cast<uint8>(Value >> 16), static_cast<uint8>(Value >> 24) };
+			Bytes.Append(Data, 4);
+		}
+
+		void WriteDouble(const double Value)
+		{
+			uint64 Bits;
+			FMemory::Memcpy(&Bits, &Value, sizeof(double));
+			WriteFixed32(static_cast<uint32>(Bits));
+			WriteFixed32(static_cast<uint32>(Bits >> 32));
+		}
+	};
+
+	struct FSaveReader
+	{
+		TArrayView<const uint8> Bytes;
+		int32 Pos = 0;
+		bool bError = false;
+
+		int32 NumLeft() const { return Bytes.Num() - Pos; }
+
+		uint8 ReadByte()
+		{
+			if (Pos >= Bytes.Num())
+			{
+				bError = true;
+				return 0;
+			}
+			return Bytes[Pos++];
+		}
+
+		uint64 ReadVarUInt64()
+		{
+			uint64 Value = 0;
+			for (int32 Shift = 0; Shift < 64; Shift += 7)
+			{
+				const uint8 Byte = ReadByte();
+				Value |= static_cast<uint64>(Byte & 0x7F) << Shift;
+				if ((Byte & 0x80) == 0)
+				{
+					return Value;
+				}
+			}
+			bError = true;  // more than 10 bytes
+			return Value;
+		}
+
+		int64 ReadVarInt64()
+		{
+			const uint64 Value = ReadVarUInt64();
+			return static_cast<int64>(Value >> 1) ^ -static_cast<int64>(Value & 1);
+		}
+
+		uint32 ReadFixed32()
+		{
+			if (NumLeft() < 4)
+			{
+				bError = true;
+				Pos = Bytes.Num();
+				return 0;
+			}
+			const uint32 Value = Bytes[Pos] | (Bytes[Pos + 1] << 8) | (Bytes[Pos + 2] << 16) | (static_cast<uint32>(Bytes[Pos + 3]) << 24);
+			Pos += 4;
+			return Value;
+		}
+
+		double ReadDouble()
+		{
+			const uint64 Low = ReadFixed32();
+			const uint64 High = ReadFixed32();
+			const uint64 Bits = Low | (High << 32);
+			double Value;
+			FMemory::Memcpy(&Value, &Bits, sizeof(double));
+			return Value;
+		}
+
+		/** Element count of an array whose elements take at least MinBytesPerElement each, rejected if the bytes left cannot hold it. */
+		int32 ReadCount(const int32 MinBytesPerElement)
+		{
+			const uint64 Count = ReadVarUInt64();
+			if (bError || Count > static_cast<uint64>(NumLeft() / MinBytesPerElement))
+			{
+				bError = true;
+				return 0;
+			}
+			return static_cast<int32>(Count);
+		}
+	};
+
+	bool IsDefaultDistribution(const FCookedSelectorDistribution& Distribution)
+	{
+		return !Distribution.bIsProbs && Distribution.TableId == 0 && Distribution.CumWeightsOrCumProbs.Num() == 1 && Distribution.CumWeightsOrCumProbs[0] == 1.0;
+	}
+
+	bool IsDefaultShuffleBag(const FSelectorShuffleBagSnapshot& ShuffleBag)
+	{
+		return ShuffleBag.DeckCounts.Num() == 0 && ShuffleBag.RemainingCounts.Num() == 0 && ShuffleBag.NumRefills == 0 && ShuffleBag.TableId == 0;
+	}
+
+	void EncodeState(const FSelectorSaveState& State, FSaveWriter& Writer)
+	{
+		uint32 FieldMask = 0;
+		if (State.Stream.GetInitialSeed() != 0 || State.Stream.GetCurrentSeed() != 0)
+		{
+			FieldMask |= SaveField_Stream;
+			if (State.Stream.GetCurrentSeed() != State.Stream.GetInitialSeed())
+			{
+				FieldMask |= SaveField_StreamAdvanced;
+			}
+		}
+		if (State.NetRandomState.Seed != 0 || State.NetRandomState.Counter != 0)
+		{
+			FieldMask |= SaveField_NetRandomState;
+		}
+		if (!IsDefaultShuffleBag(State.ShuffleBag))
+		{
+			FieldMask |= SaveField_ShuffleBag;
+		}
+		if (!IsDefaultDistribution(State.Distribution))
+		{
+			FieldMask |= SaveField_Distribution;
+		}
+		if (State.PityCounters.Num() > 0)
+		{
+			FieldMask |= SaveField_PityCounters;
+		}
+		if ((FieldMask & SaveField_Distribution) && State.Distribution.GuideTable.Num() > 0)
+		{
+			FieldMask |= SaveField_DistributionGuideTable;
+		}
+
+		Writer.WriteVarUInt64(USelectorSaveUtils::SaveVersion);
+		Writer.WriteVarUInt64(FieldMask);
+		if (FieldMask & SaveField_Stream)
+		{
+			Writer.WriteFixed32(static_cast<uint32>(State.Stream.GetInitialSeed()));
+			if (FieldMask & SaveField_StreamAdvanced)
+			{
+				Writer.WriteFixed32(static_cast<uint32>(State.Stream.GetCurrentSeed()));
+			}
+		}
+		if (FieldMask & SaveField_NetRandomState)
+		{
+			Writer.WriteFixed32(static_cast<uint32>(State.NetRandomState.Seed));
+			Writer.WriteVarUInt64(static_cast<uint32>(State.NetRandomState.Counter));
+		}
+		if (FieldMask & SaveField_ShuffleBag)
+		{
+			const FSelectorShuffleBagSnapshot& ShuffleBag = State.ShuffleBag;
+			Writer.WriteVarUInt64(ShuffleBag.DeckCounts.Num());
+			for (const int64 Count : ShuffleBag.DeckCounts)
+			{
+				Writer.WriteVarUInt64(static_cast<uint64>(Count));
+			}
+			// cards drawn rather than remaining, zero right after a refill
+			Writer.WriteVarUInt64(ShuffleBag.RemainingCounts.Num());
+			for (int32 Idx = 0; Idx < ShuffleBag.RemainingCounts.Num(); Idx++)
+			{
+				const int64 DeckCount = ShuffleBag.DeckCounts.IsValidIndex(Idx) ? ShuffleBag.DeckCounts[Idx] : 0;
+				Writer.WriteVarUInt64(static_cast<uint64>(DeckCount) - static_cast<uint64>(ShuffleBag.RemainingCounts[Idx]));
+			}
+			Writer.WriteVarInt64(ShuffleBag.NumRefills);
+			Writer.WriteFixed32(static_cast<uint32>(ShuffleBag.TableId));
+		}
+		if (FieldMask & SaveField_Distribution)
+		{
+			const FCookedSelectorDistribution& Distribution = State.Distribution;
+			Writer.Bytes.Add(Distribution.bIsProbs ? 1 : 0);
+			Writer.WriteFixed32(static_cast<uint32>(Distribution.TableId));
+			Writer.WriteVarUInt64(Distribution.CumWeightsOrCumProbs.Num());
+			for (const double Cum : Distribution.CumWeightsOrCumProbs)
+			{
+				Writer.WriteDouble(Cum);
+			}
+		}
+		if (FieldMask & SaveField_PityCounters)
+		{
+			Writer.WriteVarUInt64(State.PityCounters.Num());
+			for (const int64 Counter : State.PityCounters)
+			{
+				Writer.WriteVarInt64(Counter);
+			}
+		}
+		if (FieldMask & SaveField_DistributionGuideTable)
+		{
+			Writer.WriteVarUInt64(State.Distribution.GuideTable.Num());
+		}
+	}
+
+	bool DecodeState(FSaveReader& Reader, FSelectorSaveState& OutState)
+	{
+		const uint64 Version = Reader.ReadVarUInt64();
+		if (Reader.bError || Version == 0 || Version > USelectorSaveUtils::SaveVersion)
+		{
+			return false;
+		}
+
+		const uint64 FieldMask = Reader.ReadVarUInt64();
+		if (FieldMask & SaveField_Stream)
+		{
+			const int32 InitialSeed = static_cast<int32>(Reader.ReadFixed32());
+			OutState.Stream.Initialize(InitialSeed);
+			if (FieldMask & SaveField_StreamAdvanced)
+			{
+				SetStreamCurrentSeed(OutState.Stream, static_cast<int32>(Reader.ReadFixed32()));
+			}
+		}
+		if (FieldMask & SaveField_NetRandomState)
+		{
+			OutState.NetRandomState.Seed = static_cast<int32>(Reader.ReadFixed32());
+			OutState.NetRandomState.Counter = static_cast<int32>(static_cast<uint32>(Reader.ReadVarUInt64()));
+		}
+		if (FieldMask & SaveField_ShuffleBag)
+		{
+			FSelectorShuffleBagSnapshot& ShuffleBag = OutState.ShuffleBag;
+			ShuffleBag.DeckCounts.SetNumUninitialized(Reader.ReadCount(1));
+			for (int64& Count : ShuffleBag.DeckCounts)
+			{
+				Count = static_cast<int64>(Reader.ReadVarUInt64());
+			}
+			ShuffleBag.RemainingCounts.SetNumUninitialized(Reader.ReadCount(1));
+			for (int32 Idx = 0; Idx < ShuffleBag.RemainingCounts.Num(); Idx++)
+			{
+				const int64 DeckCount = ShuffleBag.DeckCounts.IsValidIndex(Idx) ? ShuffleBag.DeckCounts[Idx] : 0;
+				ShuffleBag.RemainingCounts[Idx] = static_cast<int64>(static_cast<uint64>(DeckCount) - Reader.ReadVarUInt64());
+			}
+			ShuffleBag.NumRefills = static_cast<int32>(Reader.ReadVarInt64());
+			ShuffleBag.TableId = static_cast<int32>(Reader.ReadFixed32());
+		}
+		if (FieldMask & SaveField_Distribution)
+		{
+			FCookedSelectorDistribution& Distribution = OutState.Distribution;
+			Distribution.bIsProbs = Reader.ReadByte() != 0;
+			Reader.ReadFixed32();  // the saved table id, recomputed below as the cumulatives may have been edited since
+			Distribution.CumWeightsOrCumProbs.SetNumUninitialized(Reader.ReadCount(8));
+			for (double& Cum : Distribution.CumWeightsOrCumProbs)
+			{
+				Cum = Reader.ReadDouble();
+			}
+			Distribution.TableId = static_cast<int32>(FSelectorAuditLog::MakeTableId(Distribution.CumWeightsOrCumProbs));
+		}
+		if (FieldMask & SaveField_PityCounters)
+		{
+			OutState.PityCounters.SetNumUninitialized(Reader.ReadCount(1));
+			for (int64& Counter : OutState.PityCounters)
+			{
+				Counter = Reader.ReadVarInt64();
+			}
+		}
+		if (FieldMask & SaveField_DistributionGuideTable)
+		{
+			// bounded relative to the entries, so a corrupted count cannot allocate the world
+			const uint64 MaxGuideBuckets = static_cast<uint64>(OutState.Distribution.CumWeightsOrCumProbs.Num()) * 16;
+			const uint64 NumGuideBuckets = Reader.ReadVarUInt64();
+			if (NumGuideBuckets > MaxGuideBuckets)
+			{
+				Reader.bError = true;
+			}
+			if (!Reader.bError)
+			{
+				USelectorUtils::BuildGuideTable(OutState.Distribution, static_cast<int32>(NumGuideBuckets));
+			}
+		}
+		return !Reader.bError;
+	}
+}
+
+FArchive& operator<<(FArchive& Ar, FSelectorSaveState& State)
+{
+	if (Ar.IsLoading())
+	{
+		uint32 NumBytes = 0;
+		Ar.SerializeIntPacked(NumBytes);
+		const int64 TotalSize = Ar.TotalSize();
+		if (Ar.IsError() || NumBytes > MaxArchivedStateBytes || (TotalSize >= 0 && NumBytes > TotalSize - Ar.Tell()))
+		{
+			Ar.SetError();
+			State = FSelectorSaveState();
+			return Ar;
+		}
+		TArray<uint8, TInlineAllocator<256>> Bytes;
+		Bytes.SetNumUninitialized(NumBytes);
+		Ar.Serialize(Bytes.GetData(), NumBytes);
+		if (Ar.IsError() || !USelectorSaveUtils::DecodeSelectorSaveState(Bytes, State))
+		{
+			Ar.SetError();
+		}
+	}
+	else
+	{
+		TArray<uint8> Bytes;
+		USelectorSaveUtils::AppendEncodedSelectorSaveState(State, Bytes);
+		uint32 NumBytes = Bytes.Num();
+		Ar.SerializeIntPacked(NumBytes);
+		Ar.Serialize(Bytes.GetData(), NumBytes);
+	}
+	return Ar;
+}
+
+void USelectorSaveUtils::EncodeSelectorSaveState(const FSelectorSaveState& State, TArray<uint8>& OutBytes)
+{
+	OutBytes.Reset();
+	AppendEncodedSelectorSaveState(State, OutBytes);
+}
+
+bool USelectorSaveUtils::BPFunc_DecodeSelectorSaveState(const TArray<uint8>& Bytes, FSelectorSaveState& OutState)
+{
+	return DecodeSelectorSaveState(Bytes, OutState);
+}
+
+void USelectorSaveUtils::AppendEncodedSelectorSaveState(const FSelectorSaveState& State, TArray<uint8>& OutBytes)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixEncodeSelectorSaveStates);
+
+	FSaveWriter Writer{OutBytes};
+	EncodeState(State, Writer);
+}
+
+bool USelectorSaveUtils::DecodeSelectorSaveState(TArrayView<const uint8> Bytes, FSelectorSaveState& OutState)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixDecodeSelectorSaveStates);
+
+	OutState = FSelectorSaveState();
+	FSaveReader Reader{Bytes};
+	if (!DecodeState(Reader, OutState) || Reader.NumLeft() != 0)
+	{
+		OutState = FSelectorSaveState();
+		return false;
+	}
+	return true;
+}
+
+void USelectorSaveUtils::EncodeSelectorSaveStates(TArrayView<const FSelectorSaveState> States, TArray<uint8>& OutBytes, TArray<int32>& OutOffsets)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixEncodeSelectorSaveStates);
+
+	const int32 Num = States.Num();
+	OutBytes.Reset();
+	OutOffsets.Reset(Num + 1);
+	if (Num < ParallelBatchThreshold)
+	{
+		FSaveWriter Writer{OutBytes};
+		for (const FSelectorSaveState& State : States)
+		{
+			OutOffsets.Add(OutBytes.Num());
+			EncodeState(State, Writer);
+		}
+		OutOffsets.Add(OutBytes.Num());
+		return;
+	}
+
+	TArray<TArray<uint8>> StateBytes;
+	StateBytes.SetNum(Num);
+	ParallelFor(Num, [&States, &StateBytes](const int32 StateIdx)
+	{
+		FSaveWriter Writer{StateBytes[StateIdx]};
+		EncodeState(States[StateIdx], Writer);
+	});
+	int32 TotalBytes = 0;
+	for (const TArray<uint8>& Bytes : StateBytes)
+	{
+		OutOffsets.Add(TotalBytes);
+		TotalBytes += Bytes.Num();
+	}
+	OutOffsets.Add(TotalBytes);
+	OutBytes.SetNumUninitialized(TotalBytes);
+	ParallelFor(Num, [&StateBytes, &OutBytes, &OutOffsets](const int32 StateIdx)
+	{
+		FMemory::Memcpy(OutBytes.GetData() + OutOffsets[StateIdx], StateBytes[StateIdx].GetData(), StateBytes[StateIdx].Num());
+	});
+}
+
+int32 USelectorSaveUtils::DecodeSelectorSaveStates(TArrayView<const uint8> Bytes, TArrayView<const int32> Offsets, TArray<FSelectorSaveState>& OutStates)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixDecodeSelectorSaveStates);
+
+	const int32 Num = FMath::Max(Offsets.Num() - 1, 0);
+	OutStates.Reset();
+	OutStates.SetNum(Num);
+	for (int32 StateIdx = 0; StateIdx < Num; StateIdx++)
+	{
+		if (Offsets[StateIdx] < 0 || Offsets[StateIdx] > Offsets[StateIdx + 1] || Offsets[StateIdx + 1] > Bytes.Num())
+		{
+			return Num;
+		}
+	}
+
+	std::atomic<int32> NumInvalid(0);
+	ParallelFor(Num, [Bytes, Offsets, &OutStates, &NumInvalid](const int32 StateIdx)
+	{
+		FSaveReader Reader{Bytes.Slice(Offsets[StateIdx], Offsets[StateIdx + 1] - Offsets[StateIdx])};
+		if (!DecodeState(Reader, OutStates[StateIdx]) || Reader.NumLeft() != 0)
+		{
+			OutStates[StateIdx] = FSelectorSaveState();
+			NumInvalid.fetch_add(1, std::memory_order_relaxed);
+		}
+	}, Num < ParallelBatchThreshold ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+	return NumInvalid.load();
+}
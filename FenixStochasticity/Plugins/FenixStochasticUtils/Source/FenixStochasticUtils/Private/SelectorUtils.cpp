@@ -3,6 +3,9 @@
 
 #include "SelectorUtils.h"
 #include "CommonUtils.h"
+#include "FenixStochasticStats.h"
+#include "SelectorCallSiteUtils.h"
+#include "SelectorAuditLog.h"
 #include "Engine/DataTable.h"
 
 //URandomSelector* USelectorUtils::CreateRandomSelector(const FRandomSelectorConfig& Config)
@@ -10,7 +13,140 @@
 //	return nullptr;
 //}
 
+namespace
+{
+	/** Audit table id of a cooked distribution, using the one computed at cook time if there is one. */
+	uint32 GetAuditTableId(const FCookedSelectorDistribution& Distribution)
+	{
+		return Distribution.TableId != 0 ? static_cast<uint32>(Distribution.TableId) : FSelectorAuditLog::MakeTableId(Distribution.CumWeightsOrCumProbs);
+	}
+
+	/** Audit table id of WeightOrProbEntry's, hashed field by field to avoid the struct padding. */
+	uint32 MakeEntriesTableId(const TArray<FWeightOrProbEntry>& Entries)
+	{
+		uint32 Crc = 0;
+		for (const FWeightOrProbEntry& Entry : Entries)
+		{
+			Crc = FCrc::TypeCrc32(Entry.WeightOrProb, Crc);
+			Crc = FCrc::TypeCrc32(Entry.bIsProb, Crc);
+		}
+		return Crc;
+	}
+
+	/** Quantized thresholds up to this many are counted linearly rather than binary searched. */
+	constexpr int32 MaxLinearScanThresholds = 64;
+
+	/** Number of the first Num thresholds not above the random word, i.e. the selected index. Both paths are branchless. */
+	template <typename ThresholdType>
+	FORCEINLINE int32 CountThresholdsNotAbove(const ThresholdType* Data, const int32 Num, const ThresholdType RandomWord)
+	{
+		if (Num <= MaxLinearScanThresholds)
+		{
+			int32 Count = 0;
+			for (int32 Idx = 0; Idx < Num; Idx++)
+			{
+				Count += Data[Idx] <= RandomWord ? 1 : 0;
+			}
+			return Count;
+		}
+
+		const ThresholdType* First = Data;
+		int32 Len = Num;
+		while (Len > 1)
+		{
+			const int32 Half = Len / 2;
+			First = First[Half] <= RandomWord ? First + Half : First;
+			Len -= Half;
+		}
+		return static_cast<int32>(First - Data) + (*First <= RandomWord ? 1 : 0);
+	}
+
+	template <typename ThresholdType>
+	FORCEINLINE int32 CountThresholdsNotAbove(const TArray<ThresholdType>& Thresholds, const ThresholdType RandomWord)
+	{
+		return CountThresholdsNotAbove(Thresholds.GetData(), Thresholds.Num(), RandomWord);
+	}
+
+	/**
+	* Guide table bucket of a value in [0, RollRange]. Monotone in the value even with rounding, which is what makes the guided search exact:
+	* a cumulative in an earlier bucket than the roll is below the roll.
+	*/
+	FORCEINLINE int32 GetGuideBucket(const double Value, const double BucketScale, const int32 NumBuckets)
+	{
+		return static_cast<int32>(FMath::Min(Value * BucketScale, static_cast<double>(NumBuckets - 1)));
+	}
+
+	/** Roll range of a cooked distribution, which its guide table buckets split. */
+	double GetGuideRollRange(const FCookedSelectorDistribution& Distribution)
+	{
+		const TArray<double>& Cums = Distribution.CumWeightsOrCumProbs;
+		return Distribution.bIsProbs ? 1.0 : (Cums.Num() > 0 ? Cums.Last() : 0.0);
+	}
+
+	/** Number of the first Num cumulatives not above the roll, i.e. the same as the binary search, by a bucket jump and a forward scan. */
+	int32 CountCumulativesNotAboveWithGuide(const TArray<double>& Cums, const int32 Num, const TArray<int32>& GuideTable, const double RollRange, const double RandomRoll)
+	{
+		const int32 NumBuckets = GuideTable.Num();
+		int32 Count = FMath::Min(GuideTable[GetGuideBucket(RandomRoll, NumBuckets / RollRange, NumBuckets)], Num);
+		while (Count < Num && Cums[Count] <= RandomRoll)
+		{
+			Count++;
+		}
+		return Count;
+	}
+
+	/** Exact selection with integer cumulatives: the index whose ticket range holds a uniform integer below the total. */
+	template <typename CumTicketType>
+	int32 SelectWithCumTicketsImpl(const TArray<CumTicketType>& CumTickets, const FRandomStream* RandomStream)
+	{
+		const int32 Num = CumTickets.Num();
+		if (Num == 0 || CumTickets[Num - 1] <= 0)
+		{
+			return -1;
+		}
+
+		const uint64 Total = static_cast<uint64>(CumTickets[Num - 1]);
+		const uint64 Ticket = Total <= MAX_uint32
+			? UCommonUtils::RandBounded32MaybeWithStream(static_cast<uint32>(Total), RandomStream)
+			: UCommonUtils::RandBounded64MaybeWithStream(Total, RandomStream);
+		return CountThresholdsNotAbove(CumTickets, static_cast<CumTicketType>(Ticket));  // below Num as the ticket is below the total, zero ticket entries never counted up to
+	}
+
+	/** Audit table id of tickets or their cumulatives, an O(n) hash. */
+	template <typename CumTicketType>
+	uint32 MakeTicketsTableId(const TArray<CumTicketType>& CumTickets)
+	{
+		return FCrc::MemCrc32(CumTickets.GetData(), CumTickets.Num() * sizeof(CumTicketType));
+	}
+
+	/** SelectWithCumTickets for any of the integer cumulative types, with stats and auditing. */
+	template <typename CumTicketType>
+	int32 SelectWithCumTicketsAudited(const TArray<CumTicketType>& CumTickets, const FRandomStream* RandomStream, const uint32 AuditTableId)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_FenixSelectWithTickets);
+		INC_DWORD_STAT(STAT_FenixSelectWithTicketsCalls);
+		FENIX_REPORT_CALL_SITE_INPUT_SIZE(CumTickets.Num());
+
+		const int32 SeedBeforeRoll = FSelectorAuditLog::GetStreamSeed(RandomStream);
+		const int32 SelectedIndex = SelectWithCumTicketsImpl(CumTickets, RandomStream);
+		if (FSelectorAuditLog::IsEnabled())
+		{
+			FSelectorAuditLog::Record(AuditTableId != 0 ? AuditTableId : MakeTicketsTableId(CumTickets), SelectedIndex, SeedBeforeRoll);
+		}
+		return SelectedIndex;
+	}
+}
+
 void USelectorUtils::MakeCumulatives(const TArray<double>& Values, TArray<double>& OutCumulatives, double ValueLowerClamp)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixMakeCumulatives);
+	INC_DWORD_STAT(STAT_FenixCookCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Values.Num());
+
+	MakeCumulativesImpl(Values, OutCumulatives, ValueLowerClamp);
+}
+
+void USelectorUtils::MakeCumulativesImpl(const TArray<double>& Values, TArray<double>& OutCumulatives, const double ValueLowerClamp)
 {
 	const int32 Num = Values.Num();
 
@@ -25,6 +161,15 @@ void USelectorUtils::MakeCumulatives(const TArray<double>& Values, TArray<double
 }
 
 void USelectorUtils::MakeCumulativesWithCutoff(const TArray<double>& Values, TArray<double>& OutCumulatives, double ValueLowerClamp, double TotalCutoff)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixMakeCumulatives);
+	INC_DWORD_STAT(STAT_FenixCookCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Values.Num());
+
+	MakeCumulativesWithCutoffImpl(Values, OutCumulatives, ValueLowerClamp, TotalCutoff);
+}
+
+void USelectorUtils::MakeCumulativesWithCutoffImpl(const TArray<double>& Values, TArray<double>& OutCumulatives, const double ValueLowerClamp, const double TotalCutoff)
 {
 	int32 Num = Values.Num();
 
@@ -44,8 +189,12 @@ void USelectorUtils::MakeCumulativesWithCutoff(const TArray<double>& Values, TAr
 	}
 }
 
-void USelectorUtils::CookSelectorDistribution(const TArray<FWeightOrProbEntry>& Entries, FCookedSelectorDistribution& OutDistribution)
+void USelectorUtils::CookSelectorDistribution(const TArray<FWeightOrProbEntry>& Entries, FCookedSelectorDistribution& OutDistribution, const int32 NumGuideBuckets)
 {
+	SCOPE_CYCLE_COUNTER(STAT_FenixCookSelectorDistribution);
+	INC_DWORD_STAT(STAT_FenixCookCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Entries.Num());
+
 	const int32 Num = Entries.Num();
 
 	OutDistribution.CumWeightsOrCumProbs.SetNum(Num);
@@ -109,10 +258,486 @@ void USelectorUtils::CookSelectorDistribution(const TArray<FWeightOrProbEntry>&
 			OutDistribution.CumWeightsOrCumProbs[Idx] = SumWeight;
 		}
 	}
+
+	OutDistribution.TableId = static_cast<int32>(FSelectorAuditLog::MakeTableId(OutDistribution.CumWeightsOrCumProbs));
+	BuildGuideTable(OutDistribution, NumGuideBuckets);
+}
+
+void USelectorUtils::BuildGuideTable(FCookedSelectorDistribution& Distribution, const int32 NumBuckets)
+{
+	const TArray<double>& Cums = Distribution.CumWeightsOrCumProbs;
+	const int32 Num = Cums.Num();
+	const double RollRange = GetGuideRollRange(Distribution);
+	if (NumBuckets <= 0 || Num <= FCookedSmallSelectorDistribution::MaxEntries || !(RollRange > 0.0))
+	{
+		Distribution.GuideTable.Empty();
+		Distribution.GuideNumCums = 0;
+		Distribution.GuideRollRange = 0.0;
+		return;
+	}
+	Distribution.GuideNumCums = Num;
+	Distribution.GuideRollRange = RollRange;
+
+	// bucket b holds the number of cumulatives in the buckets before b, all of which are below any roll in b
+	const double BucketScale = NumBuckets / RollRange;
+	Distribution.GuideTable.SetNumUninitialized(NumBuckets);
+	int32 Count = 0;
+	for (int32 Bucket = 0; Bucket < NumBuckets; Bucket++)
+	{
+		while (Count < Num && GetGuideBucket(FMath::Max(Cums[Count], 0.0), BucketScale, NumBuckets) < Bucket)
+		{
+			Count++;
+		}
+		Distribution.GuideTable[Bucket] = Count;
+	}
+}
+
+void USelectorUtils::CookAliasTable(const TArray<double>& Weights, FCookedAliasTable& OutAliasTable)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixCookAliasTable);
+	INC_DWORD_STAT(STAT_FenixCookCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Weights.Num());
+
+	TArray<double> Masses;
+	Masses.SetNumUninitialized(Weights.Num());
+	for (int32 Idx = 0; Idx < Weights.Num(); Idx++)
+	{
+		Masses[Idx] = FMath::Max(Weights[Idx], 0.0);
+	}
+	CookAliasTableFromMasses(Masses, Weights.Num(), OutAliasTable);
+}
+
+void USelectorUtils::CookAliasTableFromDistribution(const FCookedSelectorDistribution& Distribution, FCookedAliasTable& OutAliasTable)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixCookAliasTable);
+	INC_DWORD_STAT(STAT_FenixCookCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Distribution.CumWeightsOrCumProbs.Num());
+
+	// Differentiate the cumulatives back into masses, the same way the cumulative selection reads them
+	const TArray<double>& Cums = Distribution.CumWeightsOrCumProbs;
+	const int32 Num = Cums.Num();
+	const double Cap = Distribution.bIsProbs ? 1.0 : TNumericLimits<double>::Max();
+	TArray<double> Masses;
+	Masses.SetNumUninitialized(Num);
+	double PrevCum = 0.0;
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		const double Cum = FMath::Clamp(Cums[Idx], PrevCum, FMath::Max(Cap, PrevCum));
+		Masses[Idx] = Cum - PrevCum;
+		PrevCum = Cum;
+	}
+	if (Distribution.bIsProbs && 1.0 - PrevCum >= 1e-6)  // rolling outside of the probabilities counts as failure, with the same tolerance as the cumulative probability selection
+	{
+		Masses.Add(1.0 - PrevCum);
+	}
+	CookAliasTableFromMasses(Masses, Num, OutAliasTable);
+}
+
+void USelectorUtils::CookQuantizedDistribution(const FCookedSelectorDistribution& Distribution, FCookedQuantizedDistribution& OutDistribution, const double MaxRelativeError)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixCookQuantizedDistribution);
+	INC_DWORD_STAT(STAT_FenixCookCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Distribution.CumWeightsOrCumProbs.Num());
+
+	OutDistribution = FCookedQuantizedDistribution();
+	OutDistribution.TableId = static_cast<int32>(GetAuditTableId(Distribution));
+
+	// Clamp the cumulatives the same way the cumulative selection reads them
+	const TArray<double>& Cums = Distribution.CumWeightsOrCumProbs;
+	const int32 Num = Cums.Num();
+	const double Cap = Distribution.bIsProbs ? 1.0 : TNumericLimits<double>::Max();
+	TArray<double> ClampedCums;
+	ClampedCums.SetNumUninitialized(Num);
+	double PrevCum = 0.0;
+	double MinPositiveMass = TNumericLimits<double>::Max();
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		const double Cum = FMath::Clamp(Cums[Idx], PrevCum, FMath::Max(Cap, PrevCum));
+		if (Cum > PrevCum)
+		{
+			MinPositiveMass = FMath::Min(MinPositiveMass, Cum - PrevCum);
+		}
+		ClampedCums[Idx] = Cum;
+		PrevCum = Cum;
+	}
+	const double Total = Distribution.bIsProbs ? 1.0 : PrevCum;
+	if (PrevCum <= 0.0)  // nothing selectable, every roll fails
+	{
+		return;
+	}
+
+	constexpr double TwoPow32 = 4294967296.0;
+	constexpr double TwoPow52 = 4503599627370496.0;
+	constexpr double TwoPow64 = 18446744073709551616.0;
+	const double MinPositiveProb = MinPositiveMass / Total;
+	OutDistribution.bUses64BitThresholds = 1.0 / (TwoPow32 * MinPositiveProb) > MaxRelativeError;
+	OutDistribution.RelativeErrorBound = 1.0 / ((OutDistribution.bUses64BitThresholds ? TwoPow52 : TwoPow32) * MinPositiveProb);
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		const double NormalizedCum = ClampedCums[Idx] / Total;
+		if (NormalizedCum >= 1.0)
+		{
+			OutDistribution.bCoversAll = true;
+			break;
+		}
+		if (OutDistribution.bUses64BitThresholds)
+		{
+			OutDistribution.Thresholds64.Add(static_cast<uint64>(NormalizedCum * TwoPow64));  // below 2^64, as the doubles below 1 have at most 53 bits
+		}
+		else
+		{
+			const uint64 Threshold = static_cast<uint64>(NormalizedCum * TwoPow32 + 0.5);
+			if (Threshold > MAX_uint32)
+			{
+				OutDistribution.bCoversAll = true;
+				break;
+			}
+			OutDistribution.Thresholds32.Add(static_cast<uint32>(Threshold));
+		}
+	}
+}
+
+void USelectorUtils::CookAliasTableFromMasses(const TArray<double>& Masses, const int32 NumEntries, FCookedAliasTable& OutAliasTable)
+{
+	const int32 NumColumns = Masses.Num();
+	double SumMass = 0.0;
+	for (const double Mass : Masses)
+	{
+		SumMass += Mass;
+	}
+
+	OutAliasTable.NumEntries = NumEntries;
+	OutAliasTable.TableId = 0;
+	if (NumColumns == 0 || SumMass <= 0.0)
+	{
+		OutAliasTable.Thresholds.Reset();
+		OutAliasTable.Aliases.Reset();
+		return;
+	}
+
+	// Vose's method: pair each underfull column with an overfull one donating the remaining height
+	OutAliasTable.Thresholds.SetNumUninitialized(NumColumns);
+	OutAliasTable.Aliases.SetNumUninitialized(NumColumns);
+	TArray<double> ScaledMasses;
+	ScaledMasses.SetNumUninitialized(NumColumns);
+	TArray<int32> Smalls;
+	TArray<int32> Larges;
+	Smalls.Reserve(NumColumns);
+	Larges.Reserve(NumColumns);
+	const double Scale = NumColumns / SumMass;
+	for (int32 Idx = 0; Idx < NumColumns; Idx++)
+	{
+		ScaledMasses[Idx] = Masses[Idx] * Scale;
+		(ScaledMasses[Idx] < 1.0 ? Smalls : Larges).Add(Idx);
+	}
+
+	int32 LastLarge = INDEX_NONE;
+	while (Smalls.Num() > 0 && Larges.Num() > 0)
+	{
+		const int32 Small = Smalls.Pop(false);
+		const int32 Large = Larges.Pop(false);
+		LastLarge = Large;
+		OutAliasTable.Thresholds[Small] = ScaledMasses[Small];
+		OutAliasTable.Aliases[Small] = Large;
+		ScaledMasses[Large] = (ScaledMasses[Large] + ScaledMasses[Small]) - 1.0;
+		(ScaledMasses[Large] < 1.0 ? Smalls : Larges).Add(Large);
+	}
+
+	// Leftovers are full up to rounding errors
+	for (const int32 Idx : Larges)
+	{
+		OutAliasTable.Thresholds[Idx] = 1.0;
+		OutAliasTable.Aliases[Idx] = Idx;
+	}
+	for (const int32 Idx : Smalls)
+	{
+		const bool bKeepSelf = ScaledMasses[Idx] > 0.0 || LastLarge == INDEX_NONE;  // never let a zero mass entry be selected
+		OutAliasTable.Thresholds[Idx] = bKeepSelf ? 1.0 : 0.0;
+		OutAliasTable.Aliases[Idx] = bKeepSelf ? Idx : LastLarge;
+	}
+	OutAliasTable.TableId = static_cast<int32>(FSelectorAuditLog::MakeTableId(OutAliasTable.Thresholds));
+}
+
+bool USelectorUtils::CookCategorySelector(const TArray<double>& ItemWeights, const TArray<int32>& ItemCategories, FCookedCategorySelector& OutSelector)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixCookCategorySelector);
+	INC_DWORD_STAT(STAT_FenixCookCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(ItemWeights.Num());
+
+	OutSelector = FCookedCategorySelector();
+	if (ItemWeights.Num() != ItemCategories.Num())
+	{
+		return false;
+	}
+
+	// categories only as many as the kept items need, dropped items may carry any id
+	const int32 NumItems = ItemWeights.Num();
+	int32 MaxCategory = INDEX_NONE;
+	for (int32 Idx = 0; Idx < NumItems; Idx++)
+	{
+		if (ItemCategories[Idx] >= 0 && ItemWeights[Idx] > 0.0)
+		{
+			MaxCategory = FMath::Max(MaxCategory, ItemCategories[Idx]);
+		}
+	}
+	if (MaxCategory >= FCookedCategorySelector::MaxCategories)
+	{
+		return false;
+	}
+	const int32 NumCategories = MaxCategory + 1;
+
+	// counting sort of the kept items by category, keeping their order within each category
+	OutSelector.CategoryStarts.SetNumZeroed(NumCategories + 1);
+	for (int32 Idx = 0; Idx < NumItems; Idx++)
+	{
+		if (ItemCategories[Idx] >= 0 && ItemWeights[Idx] > 0.0)
+		{
+			OutSelector.CategoryStarts[ItemCategories[Idx] + 1]++;
+		}
+	}
+	for (int32 Category = 0; Category < NumCategories; Category++)
+	{
+		OutSelector.CategoryStarts[Category + 1] += OutSelector.CategoryStarts[Category];
+	}
+	TArray<int32> NextSlots(OutSelector.CategoryStarts.GetData(), NumCategories);
+	OutSelector.ItemCumWeights.SetNumUninitialized(OutSelector.CategoryStarts[NumCategories]);
+	OutSelector.ItemIndices.SetNumUninitialized(OutSelector.CategoryStarts[NumCategories]);
+	for (int32 Idx = 0; Idx < NumItems; Idx++)
+	{
+		if (ItemCategories[Idx] >= 0 && ItemWeights[Idx] > 0.0)
+		{
+			const int32 Slot = NextSlots[ItemCategories[Idx]]++;
+			OutSelector.ItemCumWeights[Slot] = ItemWeights[Idx];
+			OutSelector.ItemIndices[Slot] = Idx;
+		}
+	}
+
+	OutSelector.CategoryWeights.SetNumUninitialized(NumCategories);
+	for (int32 Category = 0; Category < NumCategories; Category++)
+	{
+		double SumWeight = 0.0;
+		for (int32 Slot = OutSelector.CategoryStarts[Category]; Slot < OutSelector.CategoryStarts[Category + 1]; Slot++)
+		{
+			SumWeight += OutSelector.ItemCumWeights[Slot];
+			OutSelector.ItemCumWeights[Slot] = SumWeight;
+		}
+		OutSelector.CategoryWeights[Category] = SumWeight;
+	}
+
+	uint32 Crc = FSelectorAuditLog::MakeTableId(OutSelector.ItemCumWeights);
+	Crc = FCrc::MemCrc32(OutSelector.ItemIndices.GetData(), OutSelector.ItemIndices.Num() * sizeof(int32), Crc);
+	OutSelector.TableId = static_cast<int32>(FCrc::MemCrc32(OutSelector.CategoryStarts.GetData(), OutSelector.CategoryStarts.Num() * sizeof(int32), Crc));
+	return true;
+}
+
+void USelectorUtils::CookCompactDistribution(const FCookedSelectorDistribution& Distribution, FCookedCompactDistribution& OutDistribution)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixCookCompactDistribution);
+	INC_DWORD_STAT(STAT_FenixCookCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Distribution.CumWeightsOrCumProbs.Num());
+
+	OutDistribution = FCookedCompactDistribution();
+	OutDistribution.bIsProbs = Distribution.bIsProbs;
+	OutDistribution.TableId = static_cast<int32>(GetAuditTableId(Distribution));
+
+	// keep the entries with positive mass (clamped the same way as elsewhere), cumulating their masses afresh
+	const TArray<double>& Cums = Distribution.CumWeightsOrCumProbs;
+	const int32 Num = Cums.Num();
+	const double Cap = Distribution.bIsProbs ? 1.0 : TNumericLimits<double>::Max();
+	double PrevCum = 0.0;
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		const double Cum = FMath::Clamp(Cums[Idx], PrevCum, FMath::Max(Cap, PrevCum));
+		if (Cum > PrevCum)
+		{
+			OutDistribution.OriginalIndices.Add(Idx);
+			OutDistribution.NormalizedCums.Add(Cum);
+		}
+		PrevCum = Cum;
+	}
+	if (!(PrevCum > 0.0))
+	{
+		OutDistribution.OriginalIndices.Empty();
+		OutDistribution.NormalizedCums.Empty();
+		return;
+	}
+	OutDistribution.Total = PrevCum;
+	OutDistribution.InvTotal = 1.0 / PrevCum;
+
+	const bool bCoversAll = !Distribution.bIsProbs || 1.0 - PrevCum < 1e-6;  // the same tolerance as the cumulative probability selection
+	const double RollScale = Distribution.bIsProbs ? 1.0 : OutDistribution.InvTotal;
+	for (double& Cum : OutDistribution.NormalizedCums)
+	{
+		Cum *= RollScale;
+	}
+	if (bCoversAll)
+	{
+		OutDistribution.NormalizedCums.Last() = 1.0;  // so rolls in [0, 1) never fall beyond the last entry
+	}
+	OutDistribution.IndexBeyondLast = bCoversAll ? OutDistribution.OriginalIndices.Last() : INDEX_NONE;
+}
+
+void USelectorUtils::CookWeightedSearchTree(const FCookedSelectorDistribution& Distribution, FCookedWeightedSearchTree& OutTree)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixCookWeightedSearchTree);
+	INC_DWORD_STAT(STAT_FenixCookCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Distribution.CumWeightsOrCumProbs.Num());
+
+	OutTree = FCookedWeightedSearchTree();
+	const TArray<double>& Cums = Distribution.CumWeightsOrCumProbs;
+	const int32 Num = Cums.Num();
+	OutTree.NumEntries = Num;
+	OutTree.TableId = static_cast<int32>(GetAuditTableId(Distribution));
+
+	// leaves are the entries with positive mass (clamped the same way as elsewhere), plus the failure range of probabilities summing below 1
+	const double Cap = Distribution.bIsProbs ? 1.0 : TNumericLimits<double>::Max();
+	TArray<int32> LeafIndices;
+	TArray<double> LeafUppers;  // upper boundary of each leaf, the lower one being the upper one of the previous leaf
+	double PrevCum = 0.0;
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		const double Cum = FMath::Clamp(Cums[Idx], PrevCum, FMath::Max(Cap, PrevCum));
+		if (Cum > PrevCum)
+		{
+			LeafIndices.Add(Idx);
+			LeafUppers.Add(Cum);
+		}
+		PrevCum = Cum;
+	}
+	if (Distribution.bIsProbs && 1.0 - PrevCum >= 1e-6)  // the same tolerance as the cumulative probability selection
+	{
+		LeafIndices.Add(Num);
+		LeafUppers.Add(1.0);
+	}
+	const int32 NumLeaves = LeafIndices.Num();
+	OutTree.RollScale = Distribution.bIsProbs ? 1.0 : PrevCum;
+	if (NumLeaves == 0 || !(OutTree.RollScale > 0.0))
+	{
+		OutTree.RollScale = 0.0;
+		return;
+	}
+
+	// build depth first with an explicit stack, as skewed distributions make deep trees
+	struct FPendingRange
+	{
+		int32 FirstLeaf;
+		int32 LastLeaf;
+		int32 Slot;  // index in Children to point at this subtree, INDEX_NONE for the root
+		int32 Depth;
+	};
+	OutTree.Splits.Reserve(NumLeaves - 1);
+	OutTree.Children.Reserve(2 * (NumLeaves - 1));
+	double WeightedDepthSum = 0.0;
+	TArray<FPendingRange> Stack;
+	Stack.Push({0, NumLeaves - 1, INDEX_NONE, 0});
+	while (Stack.Num() > 0)
+	{
+		const FPendingRange Range = Stack.Pop(false);
+		if (Range.FirstLeaf == Range.LastLeaf)
+		{
+			(Range.Slot == INDEX_NONE ? OutTree.Root : OutTree.Children[Range.Slot]) = -1 - LeafIndices[Range.FirstLeaf];
+			const double Lower = Range.FirstLeaf > 0 ? LeafUppers[Range.FirstLeaf - 1] : 0.0;
+			WeightedDepthSum += (LeafUppers[Range.FirstLeaf] - Lower) * Range.Depth;
+			continue;
+		}
+
+		// split at the boundary closest to the middle of the range's mass: the first boundary at or above it, or the one before
+		const double Lower = Range.FirstLeaf > 0 ? LeafUppers[Range.FirstLeaf - 1] : 0.0;
+		const double Middle = 0.5 * (Lower + LeafUppers[Range.LastLeaf]);
+		int32 SearchStart = Range.FirstLeaf;
+		int32 SearchEnd = Range.LastLeaf - 1;  // boundaries between leaves FirstLeaf..LastLeaf are the uppers of FirstLeaf..LastLeaf - 1
+		while (SearchStart < SearchEnd)
+		{
+			const int32 Mid = (SearchStart + SearchEnd) / 2;
+			if (LeafUppers[Mid] < Middle)
+			{
+				SearchStart = Mid + 1;
+			}
+			else
+			{
+				SearchEnd = Mid;
+			}
+		}
+		int32 SplitLeaf = SearchStart;  // the last leaf of the first child
+		if (SplitLeaf > Range.FirstLeaf && Middle - LeafUppers[SplitLeaf - 1] < LeafUppers[SplitLeaf] - Middle)
+		{
+			SplitLeaf--;
+		}
+
+		const int32 Node = OutTree.Splits.Add(LeafUppers[SplitLeaf]);
+		OutTree.Children.AddUninitialized(2);
+		(Range.Slot == INDEX_NONE ? OutTree.Root : OutTree.Children[Range.Slot]) = Node;  // only after the add, which may reallocate the children
+		Stack.Push({SplitLeaf + 1, Range.LastLeaf, 2 * Node + 1, Range.Depth + 1});
+		Stack.Push({Range.FirstLeaf, SplitLeaf, 2 * Node, Range.Depth + 1});
+	}
+	OutTree.ExpectedComparisons = WeightedDepthSum / LeafUppers.Last();
+}
+
+bool USelectorUtils::CookSmallSelectorDistribution(const FCookedSelectorDistribution& Distribution, FCookedSmallSelectorDistribution& OutDistribution)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixCookSmallSelectorDistribution);
+	INC_DWORD_STAT(STAT_FenixCookCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Distribution.CumWeightsOrCumProbs.Num());
+
+	OutDistribution = FCookedSmallSelectorDistribution();
+	const TArray<double>& Cums = Distribution.CumWeightsOrCumProbs;
+	const int32 Num = Cums.Num();
+	if (Num > FCookedSmallSelectorDistribution::MaxEntries)
+	{
+		return false;
+	}
+
+	// clamp the same way the masses are read elsewhere, so the count below is over a non-decreasing array
+	const double Cap = Distribution.bIsProbs ? 1.0 : TNumericLimits<double>::Max();
+	double PrevCum = 0.0;
+	int32 LastPositiveIndex = INDEX_NONE;
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		const double Cum = FMath::Clamp(Cums[Idx], PrevCum, FMath::Max(Cap, PrevCum));
+		if (Cum > PrevCum)
+		{
+			LastPositiveIndex = Idx;
+		}
+		OutDistribution.CumWeightsOrCumProbs[Idx] = Cum;
+		PrevCum = Cum;
+	}
+
+	OutDistribution.NumEntries = Num;
+	OutDistribution.bIsProbs = Distribution.bIsProbs;
+	OutDistribution.RollScale = Distribution.bIsProbs ? 1.0 : PrevCum;
+	const bool bCoversAll = !Distribution.bIsProbs || 1.0 - PrevCum < 1e-6;  // the same tolerance as the cumulative probability selection
+	OutDistribution.IndexBeyondLast = bCoversAll ? LastPositiveIndex : INDEX_NONE;
+	OutDistribution.TableId = static_cast<int32>(GetAuditTableId(Distribution));
+	return true;
+}
+
+void USelectorUtils::MakeCumulativeTickets(const TArray<int64>& Tickets, TArray<int64>& OutCumTickets)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixMakeCumulatives);
+	INC_DWORD_STAT(STAT_FenixCookCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Tickets.Num());
+
+	MakeCumulativeTicketsImpl(Tickets, OutCumTickets);
+}
+
+void USelectorUtils::MakeCumulativeTicketsImpl(const TArray<int64>& Tickets, TArray<int64>& OutCumTickets)
+{
+	const int32 Num = Tickets.Num();
+	OutCumTickets.SetNumUninitialized(Num);
+	int64 SumTickets = 0;
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		const int64 Ticket = FMath::Max(Tickets[Idx], static_cast<int64>(0));
+		SumTickets = Ticket <= MAX_int64 - SumTickets ? SumTickets + Ticket : MAX_int64;
+		OutCumTickets[Idx] = SumTickets;
+	}
 }
 
 void USelectorUtils::GetWeightOrProbEntriesFromDataTable(const UDataTable* DataTable, TArray<FWeightOrProbEntry>& OutEntries, const FName WeightOrProbPropertyName, const FName IsProbPropertyName)
 {
+	SCOPE_CYCLE_COUNTER(STAT_FenixDataTableExtraction);
+	INC_DWORD_STAT(STAT_FenixDataTableExtractionCalls);
+
 	OutEntries.Empty();
 	if (DataTable && WeightOrProbPropertyName != NAME_None && IsProbPropertyName != NAME_None)
 	{
@@ -139,67 +764,293 @@ void USelectorUtils::GetWeightOrProbEntriesFromDataTable(const UDataTable* DataT
 	}
 }
 
-int32 USelectorUtils::BPFunc_SelectWithCumWeights(const TArray<double>& CumWeights)
+int32 USelectorUtils::BPFunc_SelectWithCumWeights(const TArray<double>& CumWeights)
+{
+	return SelectWithCumWeights(CumWeights);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithCumWeightsFromStream(const TArray<double>& CumWeights, const FRandomStream& RandomStream)
+{
+	return SelectWithCumWeights(CumWeights, &RandomStream);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithWeights(const TArray<double>& Weights)
+{
+	return SelectWithWeights(Weights);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithWeightsFromStream(const TArray<double>& Weights, const FRandomStream& RandomStream)
+{
+	return SelectWithWeights(Weights, &RandomStream);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithCumProbs(const TArray<double>& CumProbs)
+{
+	return SelectWithCumProbs(CumProbs);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithCumProbsFromStream(const TArray<double>& CumProbs, const FRandomStream& RandomStream)
+{
+	return SelectWithCumProbs(CumProbs, &RandomStream);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithProbs(const TArray<double>& Probs)
+{
+	return SelectWithProbs(Probs);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithProbsFromStream(const TArray<double>& Probs, const FRandomStream& RandomStream)
+{
+	return SelectWithProbs(Probs, &RandomStream);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithCookedDistribution(const FCookedSelectorDistribution& Distribution)
+{
+	return SelectWithCookedDistribution(Distribution);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithCookedDistributionFromStream(const FCookedSelectorDistribution& Distribution, const FRandomStream& RandomStream)
+{
+	return SelectWithCookedDistribution(Distribution, &RandomStream);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithWeightOrProbEntries(const TArray<FWeightOrProbEntry>& Entries)
+{
+	return SelectWithWeightOrProbEntries(Entries);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithWeightOrProbEntriesFromStream(const TArray<FWeightOrProbEntry>& Entries, const FRandomStream& RandomStream)
+{
+	return SelectWithWeightOrProbEntries(Entries, &RandomStream);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithAliasTable(const FCookedAliasTable& AliasTable)
+{
+	return SelectWithAliasTable(AliasTable);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithAliasTableFromStream(const FCookedAliasTable& AliasTable, const FRandomStream& RandomStream)
+{
+	return SelectWithAliasTable(AliasTable, &RandomStream);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithQuantizedDistribution(const FCookedQuantizedDistribution& Distribution)
+{
+	return SelectWithQuantizedDistribution(Distribution);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithQuantizedDistributionFromStream(const FCookedQuantizedDistribution& Distribution, const FRandomStream& RandomStream)
+{
+	return SelectWithQuantizedDistribution(Distribution, &RandomStream);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithCategorySelector(const FCookedCategorySelector& Selector, const TArray<double>& CategoryMultipliers, int32& OutCategoryIndex)
+{
+	return SelectWithCategorySelector(Selector, CategoryMultipliers, OutCategoryIndex);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithCategorySelectorFromStream(const FCookedCategorySelector& Selector, const TArray<double>& CategoryMultipliers, const FRandomStream& RandomStream, int32& OutCategoryIndex)
+{
+	return SelectWithCategorySelector(Selector, CategoryMultipliers, OutCategoryIndex, &RandomStream);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithCompactDistribution(const FCookedCompactDistribution& Distribution)
+{
+	return SelectWithCompactDistribution(Distribution);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithCompactDistributionFromStream(const FCookedCompactDistribution& Distribution, const FRandomStream& RandomStream)
+{
+	return SelectWithCompactDistribution(Distribution, &RandomStream);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithWeightedSearchTree(const FCookedWeightedSearchTree& Tree)
+{
+	return SelectWithWeightedSearchTree(Tree);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithWeightedSearchTreeFromStream(const FCookedWeightedSearchTree& Tree, const FRandomStream& RandomStream)
+{
+	return SelectWithWeightedSearchTree(Tree, &RandomStream);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithSmallDistribution(const FCookedSmallSelectorDistribution& Distribution)
+{
+	return SelectWithSmallDistribution(Distribution);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithSmallDistributionFromStream(const FCookedSmallSelectorDistribution& Distribution, const FRandomStream& RandomStream)
+{
+	return SelectWithSmallDistribution(Distribution, &RandomStream);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithCumTickets(const TArray<int64>& CumTickets)
+{
+	return SelectWithCumTickets(CumTickets);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithCumTicketsFromStream(const TArray<int64>& CumTickets, const FRandomStream& RandomStream)
+{
+	return SelectWithCumTickets(CumTickets, &RandomStream);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithTickets(const TArray<int64>& Tickets)
+{
+	return SelectWithTickets(Tickets);
+}
+
+int32 USelectorUtils::BPFunc_SelectWithTicketsFromStream(const TArray<int64>& Tickets, const FRandomStream& RandomStream)
 {
-	return SelectWithCumWeights(CumWeights);
+	return SelectWithTickets(Tickets, &RandomStream);
 }
 
-int32 USelectorUtils::BPFunc_SelectWithCumWeightsFromStream(const TArray<double>& CumWeights, const FRandomStream& RandomStream)
+void USelectorUtils::BPFunc_SampleCounts(const FCookedSelectorDistribution& Distribution, const int64 NumPulls, TArray<int64>& OutCounts, int64& OutNumFailures)
 {
-	return SelectWithCumWeights(CumWeights, &RandomStream);
+	OutNumFailures = SampleCounts(Distribution, NumPulls, OutCounts);
 }
 
-int32 USelectorUtils::BPFunc_SelectWithWeights(const TArray<double>& Weights)
+void USelectorUtils::BPFunc_SampleCountsFromStream(const FCookedSelectorDistribution& Distribution, const int64 NumPulls, const FRandomStream& RandomStream, TArray<int64>& OutCounts, int64& OutNumFailures)
 {
-	return SelectWithWeights(Weights);
+	OutNumFailures = SampleCounts(Distribution, NumPulls, OutCounts, &RandomStream);
 }
 
-int32 USelectorUtils::BPFunc_SelectWithWeightsFromStream(const TArray<double>& Weights, const FRandomStream& RandomStream)
+int32 USelectorUtils::DataTable_SelectRowWithWeights(const UDataTable* DataTable, const FName WeightPropertyName, FName& OutRowName, FTableRowBase& OutRow)
 {
-	return SelectWithWeights(Weights, &RandomStream);
+	// We should never hit these!  They're stubs to avoid NoExport on the class.  Call the Generic* equivalent instead
+	check(0);
+	return -1;
 }
 
-int32 USelectorUtils::BPFunc_SelectWithCumProbs(const TArray<double>& CumProbs)
+int32 USelectorUtils::DataTable_SelectRowWithWeightsFromStream(const UDataTable* DataTable, const FName WeightPropertyName, const FRandomStream& RandomStream, FName& OutRowName, FTableRowBase& OutRow)
 {
-	return SelectWithCumProbs(CumProbs);
+	// We should never hit these!  They're stubs to avoid NoExport on the class.  Call the Generic* equivalent instead
+	check(0);
+	return -1;
 }
 
-int32 USelectorUtils::BPFunc_SelectWithCumProbsFromStream(const TArray<double>& CumProbs, const FRandomStream& RandomStream)
+int32 USelectorUtils::DataTable_SelectRowWithProbs(const UDataTable* DataTable, const FName ProbPropertyName, FName& OutRowName, FTableRowBase& OutRow)
 {
-	return SelectWithCumProbs(CumProbs, &RandomStream);
+	// We should never hit these!  They're stubs to avoid NoExport on the class.  Call the Generic* equivalent instead
+	check(0);
+	return -1;
 }
 
-int32 USelectorUtils::BPFunc_SelectWithProbs(const TArray<double>& Probs)
+int32 USelectorUtils::DataTable_SelectRowWithProbsFromStream(const UDataTable* DataTable, const FName ProbPropertyName, const FRandomStream& RandomStream, FName& OutRowName, FTableRowBase& OutRow)
 {
-	return SelectWithProbs(Probs);
+	// We should never hit these!  They're stubs to avoid NoExport on the class.  Call the Generic* equivalent instead
+	check(0);
+	return -1;
 }
 
-int32 USelectorUtils::BPFunc_SelectWithProbsFromStream(const TArray<double>& Probs, const FRandomStream& RandomStream)
+int32 USelectorUtils::DataTable_SelectRowWithWeightOrProbEntries(const UDataTable* DataTable, const FName WeightOrProbPropertyName, const FName IsProbPropertyName, FName& OutRowName, FTableRowBase& OutRow)
 {
-	return SelectWithProbs(Probs, &RandomStream);
+	// We should never hit these!  They're stubs to avoid NoExport on the class.  Call the Generic* equivalent instead
+	check(0);
+	return -1;
 }
 
-int32 USelectorUtils::BPFunc_SelectWithCookedDistribution(const FCookedSelectorDistribution& Distribution)
+int32 USelectorUtils::DataTable_SelectRowWithWeightOrProbEntriesFromStream(const UDataTable* DataTable, const FName WeightOrProbPropertyName, const FName IsProbPropertyName, const FRandomStream& RandomStream, FName& OutRowName, FTableRowBase& OutRow)
 {
-	return SelectWithCookedDistribution(Distribution);
+	// We should never hit these!  They're stubs to avoid NoExport on the class.  Call the Generic* equivalent instead
+	check(0);
+	return -1;
 }
 
-int32 USelectorUtils::BPFunc_SelectWithCookedDistributionFromStream(const FCookedSelectorDistribution& Distribution, const FRandomStream& RandomStream)
+int32 USelectorUtils::Generic_DataTable_SelectRowWithWeights(const UDataTable* DataTable, const FName WeightPropertyName, const FRandomStream* RandomStream, FName& OutRowName, const FStructProperty* OutRowProperty, void* OutRowPtr)
 {
-	return SelectWithCookedDistribution(Distribution, &RandomStream);
+	TArray<double> Weights;
+	UCommonUtils::GetDataTableColumnAsFloats(DataTable, WeightPropertyName, Weights);
+	const int32 SelectedIndex = SelectWithWeights(Weights, RandomStream);
+	OutputSelectedDataTableRow(DataTable, SelectedIndex, OutRowName, OutRowProperty, OutRowPtr);
+	return SelectedIndex;
 }
 
-int32 USelectorUtils::BPFunc_SelectWithWeightOrProbEntries(const TArray<FWeightOrProbEntry>& Entries)
+int32 USelectorUtils::Generic_DataTable_SelectRowWithProbs(const UDataTable* DataTable, const FName ProbPropertyName, const FRandomStream* RandomStream, FName& OutRowName, const FStructProperty* OutRowProperty, void* OutRowPtr)
 {
-	return SelectWithWeightOrProbEntries(Entries);
+	TArray<double> Probs;
+	UCommonUtils::GetDataTableColumnAsFloats(DataTable, ProbPropertyName, Probs);
+	const int32 SelectedIndex = SelectWithProbs(Probs, RandomStream);
+	OutputSelectedDataTableRow(DataTable, SelectedIndex, OutRowName, OutRowProperty, OutRowPtr);
+	return SelectedIndex;
 }
 
-int32 USelectorUtils::BPFunc_SelectWithWeightOrProbEntriesFromStream(const TArray<FWeightOrProbEntry>& Entries, const FRandomStream& RandomStream)
+int32 USelectorUtils::Generic_DataTable_SelectRowWithWeightOrProbEntries(const UDataTable* DataTable, const FName WeightOrProbPropertyName, const FName IsProbPropertyName, const FRandomStream* RandomStream, FName& OutRowName, const FStructProperty* OutRowProperty, void* OutRowPtr)
 {
-	return SelectWithWeightOrProbEntries(Entries, &RandomStream);
+	TArray<FWeightOrProbEntry> Entries;
+	GetWeightOrProbEntriesFromDataTable(DataTable, Entries, WeightOrProbPropertyName, IsProbPropertyName);
+	const int32 SelectedIndex = SelectWithWeightOrProbEntries(Entries, RandomStream);
+	OutputSelectedDataTableRow(DataTable, SelectedIndex, OutRowName, OutRowProperty, OutRowPtr);
+	return SelectedIndex;
+}
+
+void USelectorUtils::OutputSelectedDataTableRow(const UDataTable* DataTable, const int32 SelectedIndex, FName& OutRowName, const FStructProperty* OutRowProperty, void* OutRowPtr)
+{
+	OutRowName = NAME_None;
+	if (!DataTable || SelectedIndex < 0)
+	{
+		return;
+	}
+
+	// Row map iteration order is the same as the column extraction order, i.e. the order of the valid slots of its sparse storage:
+	// without removed rows leaving holes the selected index is the slot itself, otherwise walk to it
+	const TMap<FName, uint8*>& RowMap = DataTable->GetRowMap();
+	const TPair<FName, uint8*>* SelectedRow = nullptr;
+	if (RowMap.GetMaxIndex() == RowMap.Num())
+	{
+		const FSetElementId RowId = FSetElementId::FromInteger(SelectedIndex);
+		SelectedRow = RowMap.IsValidId(RowId) ? &RowMap.Get(RowId) : nullptr;
+	}
+	else
+	{
+		int32 RowIdx = 0;
+		for (auto RowIt = RowMap.CreateConstIterator(); RowIt; ++RowIt, ++RowIdx)
+		{
+			if (RowIdx == SelectedIndex)
+			{
+				SelectedRow = &*RowIt;
+				break;
+			}
+		}
+	}
+	if (!SelectedRow)
+	{
+		return;
+	}
+
+	OutRowName = SelectedRow->Key;
+	const UScriptStruct* TableType = DataTable->GetRowStruct();
+	if (OutRowProperty && OutRowPtr && TableType && OutRowProperty->Struct != FTableRowBase::StaticStruct())
+	{
+		const UScriptStruct* OutputType = OutRowProperty->Struct;
+		const bool bCompatible = (OutputType == TableType) || (OutputType->IsChildOf(TableType) && FStructUtils::TheSameLayout(OutputType, TableType));
+		if (bCompatible)
+		{
+			TableType->CopyScriptStruct(OutRowPtr, SelectedRow->Value);
+		}
+		else
+		{
+			FFrame::KismetExecutionMessage(*FString::Printf(TEXT("Random Select: row type %s is incompatible with the row struct %s of %s."),
+				*OutputType->GetName(), *TableType->GetName(), *DataTable->GetPathName()), ELogVerbosity::Warning);
+		}
+	}
+}
+
+int32 USelectorUtils::SelectWithCumWeights(const TArray<double>& CumWeights, const FRandomStream* RandomStream, const uint32 AuditTableId)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixSelectWithCumWeights);
+	INC_DWORD_STAT(STAT_FenixSelectWithCumWeightsCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(CumWeights.Num());
+
+	const int32 SeedBeforeRoll = FSelectorAuditLog::GetStreamSeed(RandomStream);
+	const int32 SelectedIndex = SelectWithCumWeightsImpl(CumWeights, RandomStream);
+	if (FSelectorAuditLog::IsEnabled())
+	{
+		FSelectorAuditLog::Record(AuditTableId != 0 ? AuditTableId : FSelectorAuditLog::MakeTableId(CumWeights), SelectedIndex, SeedBeforeRoll);
+	}
+	return SelectedIndex;
 }
 
-int32 USelectorUtils::SelectWithCumWeights(const TArray<double>& CumWeights, const FRandomStream* RandomStream)
+int32 USelectorUtils::SelectWithCumWeightsImpl(const TArray<double>& CumWeights, const FRandomStream* RandomStream, const TArray<int32>* GuideTable)
 {
 	const int32 Num = CumWeights.Num();
 	if (Num == 0)
@@ -217,10 +1068,25 @@ int32 USelectorUtils::SelectWithCumWeights(const TArray<double>& CumWeights, con
 		return -1;
 	}
 
-	return SelectWithCumWeightsHelper(CumWeights, Num, SumWeight, RandomStream);
+	return SelectWithCumWeightsHelper(CumWeights, Num, SumWeight, RandomStream, GuideTable);
+}
+
+int32 USelectorUtils::SelectWithWeights(const TArray<double>& Weights, const FRandomStream* RandomStream, const uint32 AuditTableId)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixSelectWithWeights);
+	INC_DWORD_STAT(STAT_FenixSelectWithWeightsCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Weights.Num());
+
+	const int32 SeedBeforeRoll = FSelectorAuditLog::GetStreamSeed(RandomStream);
+	const int32 SelectedIndex = SelectWithWeightsImpl(Weights, RandomStream);
+	if (FSelectorAuditLog::IsEnabled())
+	{
+		FSelectorAuditLog::Record(AuditTableId != 0 ? AuditTableId : FSelectorAuditLog::MakeTableId(Weights), SelectedIndex, SeedBeforeRoll);
+	}
+	return SelectedIndex;
 }
 
-int32 USelectorUtils::SelectWithWeights(const TArray<double>& Weights, const FRandomStream* RandomStream)
+int32 USelectorUtils::SelectWithWeightsImpl(const TArray<double>& Weights, const FRandomStream* RandomStream)
 {
 	const int32 Num = Weights.Num();
 	if (Num == 0)
@@ -233,7 +1099,8 @@ int32 USelectorUtils::SelectWithWeights(const TArray<double>& Weights, const FRa
 	}
 
 	TArray<double> CumWeights;
-	MakeCumulatives(Weights, CumWeights);
+	MakeCumulativesImpl(Weights, CumWeights);
+	FENIX_STAT_TEMP_ALLOCATION(Num);
 
 	const double SumWeight = CumWeights[Num - 1];
 	if (SumWeight == 0.0)
@@ -244,7 +1111,22 @@ int32 USelectorUtils::SelectWithWeights(const TArray<double>& Weights, const FRa
 	return SelectWithCumWeightsHelper(CumWeights, Num, SumWeight, RandomStream);
 }
 
-int32 USelectorUtils::SelectWithCumProbs(const TArray<double>& CumProbs, const FRandomStream* RandomStream)
+int32 USelectorUtils::SelectWithCumProbs(const TArray<double>& CumProbs, const FRandomStream* RandomStream, const uint32 AuditTableId)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixSelectWithCumProbs);
+	INC_DWORD_STAT(STAT_FenixSelectWithCumProbsCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(CumProbs.Num());
+
+	const int32 SeedBeforeRoll = FSelectorAuditLog::GetStreamSeed(RandomStream);
+	const int32 SelectedIndex = SelectWithCumProbsImpl(CumProbs, RandomStream);
+	if (FSelectorAuditLog::IsEnabled())
+	{
+		FSelectorAuditLog::Record(AuditTableId != 0 ? AuditTableId : FSelectorAuditLog::MakeTableId(CumProbs), SelectedIndex, SeedBeforeRoll);
+	}
+	return SelectedIndex;
+}
+
+int32 USelectorUtils::SelectWithCumProbsImpl(const TArray<double>& CumProbs, const FRandomStream* RandomStream, const TArray<int32>* GuideTable)
 {
 	const int32 Num = CumProbs.Num();
 	if (Num == 0)
@@ -258,10 +1140,25 @@ int32 USelectorUtils::SelectWithCumProbs(const TArray<double>& CumProbs, const F
 		return -1;
 	}
 
-	return SelectWithCumProbsHelper(CumProbs, Num, RandomStream);
+	return SelectWithCumProbsHelper(CumProbs, Num, RandomStream, GuideTable);
+}
+
+int32 USelectorUtils::SelectWithProbs(const TArray<double>& Probs, const FRandomStream* RandomStream, const uint32 AuditTableId)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixSelectWithProbs);
+	INC_DWORD_STAT(STAT_FenixSelectWithProbsCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Probs.Num());
+
+	const int32 SeedBeforeRoll = FSelectorAuditLog::GetStreamSeed(RandomStream);
+	const int32 SelectedIndex = SelectWithProbsImpl(Probs, RandomStream);
+	if (FSelectorAuditLog::IsEnabled())
+	{
+		FSelectorAuditLog::Record(AuditTableId != 0 ? AuditTableId : FSelectorAuditLog::MakeTableId(Probs), SelectedIndex, SeedBeforeRoll);
+	}
+	return SelectedIndex;
 }
 
-int32 USelectorUtils::SelectWithProbs(const TArray<double>& Probs, const FRandomStream* RandomStream)
+int32 USelectorUtils::SelectWithProbsImpl(const TArray<double>& Probs, const FRandomStream* RandomStream)
 {
 	int32 Num = Probs.Num();
 	if (Num == 0)
@@ -270,7 +1167,8 @@ int32 USelectorUtils::SelectWithProbs(const TArray<double>& Probs, const FRandom
 	}
 
 	TArray<double> CumProbs;
-	MakeCumulativesWithCutoff(Probs, CumProbs); // can do cutoff here, as these are probabilities, and it's temporary use so there's no risk on changing the array size
+	MakeCumulativesWithCutoffImpl(Probs, CumProbs); // can do cutoff here, as these are probabilities, and it's temporary use so there's no risk on changing the array size
+	FENIX_STAT_TEMP_ALLOCATION(Num);
 	Num = CumProbs.Num(); // recompute as the array size could be cut off above
 	
 	const double SumProb = CumProbs[Num - 1];
@@ -284,14 +1182,48 @@ int32 USelectorUtils::SelectWithProbs(const TArray<double>& Probs, const FRandom
 
 int32 USelectorUtils::SelectWithCookedDistribution(const FCookedSelectorDistribution& Distribution, const FRandomStream* RandomStream)
 {
+	SCOPE_CYCLE_COUNTER(STAT_FenixSelectWithCookedDistribution);
+	INC_DWORD_STAT(STAT_FenixSelectWithCookedDistributionCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Distribution.CumWeightsOrCumProbs.Num());
+
+	const int32 SeedBeforeRoll = FSelectorAuditLog::GetStreamSeed(RandomStream);
+	const int32 SelectedIndex = SelectWithCookedDistributionImpl(Distribution, RandomStream);
+	if (FSelectorAuditLog::IsEnabled())
+	{
+		FSelectorAuditLog::Record(GetAuditTableId(Distribution), SelectedIndex, SeedBeforeRoll);
+	}
+	return SelectedIndex;
+}
+
+int32 USelectorUtils::SelectWithCookedDistributionImpl(const FCookedSelectorDistribution& Distribution, const FRandomStream* RandomStream)
+{
+	// a guide table built for other cumulatives would change which entry is selected, so a stale one is ignored
+	const bool bGuideValid = Distribution.GuideTable.Num() > 0 && Distribution.GuideNumCums == Distribution.CumWeightsOrCumProbs.Num()
+		&& Distribution.GuideRollRange == GetGuideRollRange(Distribution);
+	const TArray<int32>* GuideTable = bGuideValid ? &Distribution.GuideTable : nullptr;
 	if (Distribution.bIsProbs)
 	{
-		return SelectWithCumProbs(Distribution.CumWeightsOrCumProbs, RandomStream);
+		return SelectWithCumProbsImpl(Distribution.CumWeightsOrCumProbs, RandomStream, GuideTable);
+	}
+	return SelectWithCumWeightsImpl(Distribution.CumWeightsOrCumProbs, RandomStream, GuideTable);
+}
+
+int32 USelectorUtils::SelectWithWeightOrProbEntries(const TArray<FWeightOrProbEntry>& Entries, const FRandomStream* RandomStream, const uint32 AuditTableId)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixSelectWithWeightOrProbEntries);
+	INC_DWORD_STAT(STAT_FenixSelectWithWeightOrProbEntriesCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Entries.Num());
+
+	const int32 SeedBeforeRoll = FSelectorAuditLog::GetStreamSeed(RandomStream);
+	const int32 SelectedIndex = SelectWithWeightOrProbEntriesImpl(Entries, RandomStream);
+	if (FSelectorAuditLog::IsEnabled())
+	{
+		FSelectorAuditLog::Record(AuditTableId != 0 ? AuditTableId : MakeEntriesTableId(Entries), SelectedIndex, SeedBeforeRoll);
 	}
-	return SelectWithCumWeights(Distribution.CumWeightsOrCumProbs, RandomStream);
+	return SelectedIndex;
 }
 
-int32 USelectorUtils::SelectWithWeightOrProbEntries(const TArray<FWeightOrProbEntry>& Entries, const FRandomStream* RandomStream)
+int32 USelectorUtils::SelectWithWeightOrProbEntriesImpl(const TArray<FWeightOrProbEntry>& Entries, const FRandomStream* RandomStream)
 {
 	int32 Num = Entries.Num();
 	if (Num == 0)
@@ -324,6 +1256,7 @@ int32 USelectorUtils::SelectWithWeightOrProbEntries(const TArray<FWeightOrProbEn
 		SumWeight = 0.0;
 		TArray<double> CumWeights;
 		CumWeights.SetNum(Num);
+		FENIX_STAT_TEMP_ALLOCATION(Num);
 		for (int32 Idx = 0; Idx < Num; Idx++)
 		{
 			if (!Entries[Idx].bIsProb)
@@ -341,6 +1274,7 @@ int32 USelectorUtils::SelectWithWeightOrProbEntries(const TArray<FWeightOrProbEn
 		SumProb = 0.0;
 		TArray<double> CumProbs;
 		CumProbs.SetNum(Num);
+		FENIX_STAT_TEMP_ALLOCATION(Num);
 		for (int32 Idx = 0; Idx < Num; Idx++)
 		{
 			if (Entries[Idx].bIsProb)
@@ -363,6 +1297,7 @@ int32 USelectorUtils::SelectWithWeightOrProbEntries(const TArray<FWeightOrProbEn
 	SumWeight = 0.0;
 	TArray<double> CumWeights;
 	CumWeights.SetNum(Num);
+	FENIX_STAT_TEMP_ALLOCATION(Num);
 	for (int32 Idx = 0; Idx < Num; Idx++)
 	{
 		if (Entries[Idx].bIsProb)
@@ -378,10 +1313,413 @@ int32 USelectorUtils::SelectWithWeightOrProbEntries(const TArray<FWeightOrProbEn
 	return SelectWithCumWeightsHelper(CumWeights, Num, SumWeight, RandomStream);
 }
 
-int32 USelectorUtils::SelectWithCumWeightsHelper(const TArray<double>& CumWeights, const int32 Num, const double SumWeight, const FRandomStream* RandomStream)
+int32 USelectorUtils::SelectWithAliasTable(const FCookedAliasTable& AliasTable, const FRandomStream* RandomStream)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixSelectWithAliasTable);
+	INC_DWORD_STAT(STAT_FenixSelectWithAliasTableCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(AliasTable.Thresholds.Num());
+
+	if (AliasTable.Thresholds.Num() == 0 || AliasTable.Thresholds.Num() != AliasTable.Aliases.Num())
+	{
+		return -1;
+	}
+
+	const int32 SeedBeforeRoll = FSelectorAuditLog::GetStreamSeed(RandomStream);
+	const int32 SelectedIndex = SelectWithAliasTableUnchecked(AliasTable, RandomStream);
+	if (FSelectorAuditLog::IsEnabled())
+	{
+		FSelectorAuditLog::Record(AliasTable.TableId != 0 ? static_cast<uint32>(AliasTable.TableId) : FSelectorAuditLog::MakeTableId(AliasTable.Thresholds), SelectedIndex, SeedBeforeRoll);
+	}
+	return SelectedIndex;
+}
+
+int32 USelectorUtils::SelectWithQuantizedDistribution(const FCookedQuantizedDistribution& Distribution, const FRandomStream* RandomStream)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixSelectWithQuantizedDistribution);
+	INC_DWORD_STAT(STAT_FenixSelectWithQuantizedDistributionCalls);
+	const int32 NumThresholds = Distribution.bUses64BitThresholds ? Distribution.Thresholds64.Num() : Distribution.Thresholds32.Num();
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(NumThresholds);
+
+	const int32 SeedBeforeRoll = FSelectorAuditLog::GetStreamSeed(RandomStream);
+	const int32 Count = Distribution.bUses64BitThresholds
+		? CountThresholdsNotAbove(Distribution.Thresholds64, UCommonUtils::Rand64MaybeWithStream(RandomStream))
+		: CountThresholdsNotAbove(Distribution.Thresholds32, UCommonUtils::RandBitsMaybeWithStream(RandomStream));
+	const int32 SelectedIndex = Count < NumThresholds || Distribution.bCoversAll ? Count : -1;  // beyond the last threshold: the entry reaching the total, or failure
+	if (FSelectorAuditLog::IsEnabled())
+	{
+		FSelectorAuditLog::Record(static_cast<uint32>(Distribution.TableId), SelectedIndex, SeedBeforeRoll);
+	}
+	return SelectedIndex;
+}
+
+int32 USelectorUtils::SelectWithCategorySelector(const FCookedCategorySelector& Selector, const TArray<double>& CategoryMultipliers, int32& OutCategoryIndex, const FRandomStream* RandomStream)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixSelectWithCategorySelector);
+	INC_DWORD_STAT(STAT_FenixSelectWithCategorySelectorCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Selector.ItemCumWeights.Num());
+
+	const int32 SeedBeforeRoll = FSelectorAuditLog::GetStreamSeed(RandomStream);
+	OutCategoryIndex = INDEX_NONE;
+	int32 SelectedIndex = INDEX_NONE;
+	const int32 NumCategories = Selector.CategoryWeights.Num();
+	if (NumCategories > 0 && Selector.CategoryStarts.Num() == NumCategories + 1 && Selector.ItemCumWeights.Num() == Selector.CategoryStarts[NumCategories])
+	{
+		// boosted category weights, computed on the fly rather than cooked
+		TArray<double, TInlineAllocator<16>> CumCategoryWeights;
+		CumCategoryWeights.SetNumUninitialized(NumCategories);
+		double SumWeight = 0.0;
+		for (int32 Category = 0; Category < NumCategories; Category++)
+		{
+			const double Multiplier = CategoryMultipliers.IsValidIndex(Category)
+				? (FMath::IsNaN(CategoryMultipliers[Category]) ? 0.0 : FMath::Clamp(CategoryMultipliers[Category], 0.0, FCookedCategorySelector::MaxCategoryMultiplier))
+				: 1.0;
+			SumWeight += Selector.CategoryWeights[Category] * Multiplier;
+			CumCategoryWeights[Category] = SumWeight;
+		}
+
+		if (SumWeight > 0.0 && FMath::IsFinite(SumWeight))  // huge item weights may still overflow once boosted
+		{
+			const double CategoryRoll = UCommonUtils::FRandRangeMaybeWithStream(0.0, SumWeight, RandomStream);
+			int32 Category = CountThresholdsNotAbove(CumCategoryWeights.GetData(), NumCategories, CategoryRoll);
+			if (Category == NumCategories)  // rolled the total exactly: the last category with positive weight
+			{
+				Category--;
+				while (Category > 0 && CumCategoryWeights[Category] == CumCategoryWeights[Category - 1])
+				{
+					Category--;
+				}
+			}
+
+			// items with non-positive weights are dropped when cooking, so a category with positive boosted weight has positive items
+			const int32 Start = Selector.CategoryStarts[Category];
+			const int32 End = Selector.CategoryStarts[Category + 1];
+			const double ItemRoll = UCommonUtils::FRandRangeMaybeWithStream(0.0, Selector.CategoryWeights[Category], RandomStream);
+			const int32 Slot = UCommonUtils::BinarySearchForInsertionInSegment(ItemRoll, Selector.ItemCumWeights, Start, End - 1);  // the last item also takes a roll of the total exactly
+			OutCategoryIndex = Category;
+			SelectedIndex = Selector.ItemIndices[Slot];
+		}
+	}
+	if (FSelectorAuditLog::IsEnabled())
+	{
+		FSelectorAuditLog::Record(static_cast<uint32>(Selector.TableId), SelectedIndex, SeedBeforeRoll);
+	}
+	return SelectedIndex;
+}
+
+int32 USelectorUtils::SelectWithCompactDistribution(const FCookedCompactDistribution& Distribution, const FRandomStream* RandomStream)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixSelectWithCompactDistribution);
+	INC_DWORD_STAT(STAT_FenixSelectWithCompactDistributionCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Distribution.NormalizedCums.Num());
+
+	const int32 SeedBeforeRoll = FSelectorAuditLog::GetStreamSeed(RandomStream);
+	const double RandomRoll = UCommonUtils::FRandMaybeWithStream(RandomStream);
+	const int32 Count = CountThresholdsNotAbove(Distribution.NormalizedCums, RandomRoll);
+	const int32 SelectedIndex = Count < Distribution.OriginalIndices.Num() ? Distribution.OriginalIndices[Count] : Distribution.IndexBeyondLast;  // beyond the kept entries: failure (or an empty table)
+	if (FSelectorAuditLog::IsEnabled())
+	{
+		FSelectorAuditLog::Record(static_cast<uint32>(Distribution.TableId), SelectedIndex, SeedBeforeRoll);
+	}
+	return SelectedIndex;
+}
+
+int32 USelectorUtils::SelectWithWeightedSearchTree(const FCookedWeightedSearchTree& Tree, const FRandomStream* RandomStream)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixSelectWithWeightedSearchTree);
+	INC_DWORD_STAT(STAT_FenixSelectWithWeightedSearchTreeCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Tree.NumEntries);
+
+	const int32 SeedBeforeRoll = FSelectorAuditLog::GetStreamSeed(RandomStream);
+	int32 SelectedIndex = INDEX_NONE;
+	if (Tree.RollScale > 0.0 && Tree.Root < Tree.Splits.Num() && Tree.Children.Num() == 2 * Tree.Splits.Num())
+	{
+		const double RandomRoll = UCommonUtils::FRandRangeMaybeWithStream(0.0, Tree.RollScale, RandomStream);
+		int32 Node = Tree.Root;
+		while (Node >= 0)
+		{
+			Node = Tree.Children[2 * Node + (RandomRoll < Tree.Splits[Node] ? 0 : 1)];
+		}
+		const int32 Leaf = -1 - Node;
+		SelectedIndex = Leaf < Tree.NumEntries ? Leaf : INDEX_NONE;
+	}
+	if (FSelectorAuditLog::IsEnabled())
+	{
+		FSelectorAuditLog::Record(static_cast<uint32>(Tree.TableId), SelectedIndex, SeedBeforeRoll);
+	}
+	return SelectedIndex;
+}
+
+int32 USelectorUtils::SelectWithSmallDistribution(const FCookedSmallSelectorDistribution& Distribution, const FRandomStream* RandomStream)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixSelectWithSmallDistribution);
+	INC_DWORD_STAT(STAT_FenixSelectWithSmallDistributionCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Distribution.NumEntries);
+
+	const int32 SeedBeforeRoll = FSelectorAuditLog::GetStreamSeed(RandomStream);
+	int32 SelectedIndex = INDEX_NONE;
+	if (Distribution.RollScale > 0.0)
+	{
+		const double RandomRoll = UCommonUtils::FRandMaybeWithStream(RandomStream) * Distribution.RollScale;
+		int32 Count = 0;
+		for (int32 Slot = 0; Slot < FCookedSmallSelectorDistribution::MaxEntries; Slot++)  // fixed trip count over the padded slots, vectorized into a few compares and a sum
+		{
+			Count += Distribution.CumWeightsOrCumProbs[Slot] <= RandomRoll ? 1 : 0;
+		}
+		SelectedIndex = Count < Distribution.NumEntries ? Count : Distribution.IndexBeyondLast;
+	}
+	if (FSelectorAuditLog::IsEnabled())
+	{
+		FSelectorAuditLog::Record(static_cast<uint32>(Distribution.TableId), SelectedIndex, SeedBeforeRoll);
+	}
+	return SelectedIndex;
+}
+
+int32 USelectorUtils::SelectWithCumTickets(const TArray<int64>& CumTickets, const FRandomStream* RandomStream, const uint32 AuditTableId)
+{
+	return SelectWithCumTicketsAudited(CumTickets, RandomStream, AuditTableId);
+}
+
+int32 USelectorUtils::SelectWithCumTickets(const TArray<uint32>& CumTickets, const FRandomStream* RandomStream, const uint32 AuditTableId)
+{
+	return SelectWithCumTicketsAudited(CumTickets, RandomStream, AuditTableId);
+}
+
+int32 USelectorUtils::SelectWithCumTickets(const TArray<uint64>& CumTickets, const FRandomStream* RandomStream, const uint32 AuditTableId)
+{
+	return SelectWithCumTicketsAudited(CumTickets, RandomStream, AuditTableId);
+}
+
+int32 USelectorUtils::SelectWithTickets(const TArray<int64>& Tickets, const FRandomStream* RandomStream, const uint32 AuditTableId)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixSelectWithTickets);
+	INC_DWORD_STAT(STAT_FenixSelectWithTicketsCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Tickets.Num());
+
+	TArray<int64> CumTickets;
+	MakeCumulativeTicketsImpl(Tickets, CumTickets);
+	FENIX_STAT_TEMP_ALLOCATION(Tickets.Num());
+
+	const int32 SeedBeforeRoll = FSelectorAuditLog::GetStreamSeed(RandomStream);
+	const int32 SelectedIndex = SelectWithCumTicketsImpl(CumTickets, RandomStream);
+	if (FSelectorAuditLog::IsEnabled())
+	{
+		FSelectorAuditLog::Record(AuditTableId != 0 ? AuditTableId : MakeTicketsTableId(Tickets), SelectedIndex, SeedBeforeRoll);
+	}
+	return SelectedIndex;
+}
+
+int64 USelectorUtils::SampleCounts(const FCookedSelectorDistribution& Distribution, const int64 NumPulls, TArray<int64>& OutCounts, const FRandomStream* RandomStream)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixSampleCounts);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Distribution.CumWeightsOrCumProbs.Num());
+
+	// Differentiate the cumulatives back into masses, the same way the cumulative selection reads them
+	const TArray<double>& Cums = Distribution.CumWeightsOrCumProbs;
+	const int32 Num = Cums.Num();
+	const double Cap = Distribution.bIsProbs ? 1.0 : TNumericLimits<double>::Max();
+	OutCounts.SetNumZeroed(Num);
+	TArray<double> MassesLeft;  // suffix sums, so the conditional probabilities carry no accumulated subtraction errors
+	MassesLeft.SetNumUninitialized(Num + 1);
+	double PrevCum = 0.0;
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		const double Cum = FMath::Clamp(Cums[Idx], PrevCum, FMath::Max(Cap, PrevCum));
+		MassesLeft[Idx] = Cum - PrevCum;
+		PrevCum = Cum;
+	}
+	MassesLeft[Num] = Distribution.bIsProbs && 1.0 - PrevCum >= 1e-6 ? 1.0 - PrevCum : 0.0;  // rolling outside of the probabilities counts as failure, with the same tolerance as the cumulative probability selection
+	for (int32 Idx = Num - 1; Idx >= 0; Idx--)
+	{
+		MassesLeft[Idx] += MassesLeft[Idx + 1];
+	}
+	if (NumPulls <= 0 || MassesLeft[0] <= 0.0)
+	{
+		return FMath::Max(NumPulls, static_cast<int64>(0));
+	}
+
+	int64 PullsLeft = NumPulls;
+	for (int32 Idx = 0; Idx < Num && PullsLeft > 0; Idx++)
+	{
+		const double Mass = MassesLeft[Idx] - MassesLeft[Idx + 1];
+		const int64 Count = MassesLeft[Idx + 1] > 0.0 ? SampleBinomial(PullsLeft, Mass / MassesLeft[Idx], RandomStream) : PullsLeft;
+		OutCounts[Idx] = Count;
+		PullsLeft -= Count;
+	}
+	return PullsLeft;
+}
+
+int64 USelectorUtils::SampleBinomial(const int64 NumTrials, const double Prob, const FRandomStream* RandomStream)
+{
+	if (NumTrials <= 0 || Prob <= 0.0)
+	{
+		return 0;
+	}
+	if (Prob >= 1.0)
+	{
+		return NumTrials;
+	}
+
+	const bool bFlipped = Prob > 0.5;  // both methods want the smaller probability
+	const double SmallProb = bFlipped ? 1.0 - Prob : Prob;
+	const int64 Successes = NumTrials * SmallProb < 30.0 ? SampleBinomialInversion(NumTrials, SmallProb, RandomStream) : SampleBinomialBTPE(NumTrials, SmallProb, RandomStream);
+	return bFlipped ? NumTrials - Successes : Successes;
+}
+
+int64 USelectorUtils::SampleBinomialInversion(const int64 NumTrials, const double Prob, const FRandomStream* RandomStream)
+{
+	// walk the probability mass function from 0, restarting beyond a bound far in the tail
+	const double N = static_cast<double>(NumTrials);
+	const double Q = 1.0 - Prob;
+	const double ProbOfZero = FMath::Exp(N * FMath::Loge(Q));
+	const double Mean = N * Prob;
+	const double Bound = FMath::Min(N, Mean + 10.0 * FMath::Sqrt(Mean * Q + 1.0));
+	int64 Successes = 0;
+	double ProbOfSuccesses = ProbOfZero;
+	double U = UCommonUtils::DRandMaybeWithStream(RandomStream);
+	while (U > ProbOfSuccesses)
+	{
+		Successes++;
+		if (Successes > Bound)
+		{
+			Successes = 0;
+			ProbOfSuccesses = ProbOfZero;
+			U = UCommonUtils::DRandMaybeWithStream(RandomStream);
+		}
+		else
+		{
+			U -= ProbOfSuccesses;
+			ProbOfSuccesses = (N - Successes + 1.0) * Prob * ProbOfSuccesses / (Successes * Q);
+		}
+	}
+	return Successes;
+}
+
+int64 USelectorUtils::SampleBinomialBTPE(const int64 NumTrials, const double Prob, const FRandomStream* RandomStream)
+{
+	// Kachitvichyanukul and Schmeiser's triangle, parallelogram and exponential tails hat, with squeezes before the exact test
+	const double N = static_cast<double>(NumTrials);
+	const double R = Prob;
+	const double Q = 1.0 - R;
+	const double NRQ = N * R * Q;
+	const double FM = N * R + R;
+	const double M = FMath::FloorToDouble(FM);
+	const double P1 = FMath::FloorToDouble(2.195 * FMath::Sqrt(NRQ) - 4.6 * Q) + 0.5;
+	const double XM = M + 0.5;
+	const double XL = XM - P1;
+	const double XR = XM + P1;
+	const double C = 0.134 + 20.5 / (15.3 + M);
+	double A = (FM - XL) / (FM - XL * R);
+	const double LambdaL = A * (1.0 + 0.5 * A);
+	A = (XR - FM) / (XR * Q);
+	const double LambdaR = A * (1.0 + 0.5 * A);
+	const double P2 = P1 * (1.0 + 2.0 * C);
+	const double P3 = P2 + C / LambdaL;
+	const double P4 = P3 + C / LambdaR;
+
+	for (;;)
+	{
+		const double U = UCommonUtils::DRandMaybeWithStream(RandomStream) * P4;
+		double V = 1.0 - UCommonUtils::DRandMaybeWithStream(RandomStream);  // (0, 1] for the logarithms
+		double Y;
+		if (U <= P1)  // triangle, accepted right away
+		{
+			return static_cast<int64>(FMath::FloorToDouble(XM - P1 * V + U));
+		}
+		if (U <= P2)  // parallelograms
+		{
+			const double X = XL + (U - P1) / C;
+			V = V * C + 1.0 - FMath::Abs(M - X + 0.5) / P1;
+			if (V > 1.0)
+			{
+				continue;
+			}
+			Y = FMath::FloorToDouble(X);
+		}
+		else if (U <= P3)  // left exponential tail
+		{
+			Y = FMath::FloorToDouble(XL + FMath::Loge(V) / LambdaL);
+			if (Y < 0.0)
+			{
+				continue;
+			}
+			V = V * (U - P2) * LambdaL;
+		}
+		else  // right exponential tail
+		{
+			Y = FMath::FloorToDouble(XR - FMath::Loge(V) / LambdaR);
+			if (Y > N)
+			{
+				continue;
+			}
+			V = V * (U - P3) * LambdaR;
+		}
+
+		const double K = FMath::Abs(Y - M);
+		if (K <= 20.0 || K >= 0.5 * NRQ - 1.0)  // close to the mode, evaluate the ratio of the probabilities recursively
+		{
+			const double S = R / Q;
+			const double AS = S * (N + 1.0);
+			double F = 1.0;
+			if (M < Y)
+			{
+				for (double I = M + 1.0; I <= Y; I += 1.0)
+				{
+					F *= AS / I - S;
+				}
+			}
+			else if (M > Y)
+			{
+				for (double I = Y + 1.0; I <= M; I += 1.0)
+				{
+					F /= AS / I - S;
+				}
+			}
+			if (V <= F)
+			{
+				return static_cast<int64>(Y);
+			}
+			continue;
+		}
+
+		// squeeze with the normal approximation of the log ratio, then the exact test with Stirling's formula
+		const double Rho = (K / NRQ) * ((K * (K / 3.0 + 0.625) + 1.0 / 6.0) / NRQ + 0.5);
+		const double T = -K * K / (2.0 * NRQ);
+		const double LogV = FMath::Loge(V);
+		if (LogV < T - Rho)
+		{
+			return static_cast<int64>(Y);
+		}
+		if (LogV > T + Rho)
+		{
+			continue;
+		}
+
+		const double X1 = Y + 1.0;
+		const double F1 = M + 1.0;
+		const double Z = N + 1.0 - M;
+		const double W = N - Y + 1.0;
+		const auto StirlingCorrection = [](const double Value)
+		{
+			const double Squared = Value * Value;
+			return (13860.0 - (462.0 - (132.0 - (99.0 - 140.0 / Squared) / Squared) / Squared) / Squared) / Value / 166320.0;
+		};
+		const double Bound = XM * FMath::Loge(F1 / X1) + (N - M + 0.5) * FMath::Loge(Z / W) + (Y - M) * FMath::Loge(W * R / (X1 * Q))
+			+ StirlingCorrection(F1) + StirlingCorrection(Z) + StirlingCorrection(X1) + StirlingCorrection(W);
+		if (LogV <= Bound)
+		{
+			return static_cast<int64>(Y);
+		}
+	}
+}
+
+int32 USelectorUtils::SelectWithCumWeightsHelper(const TArray<double>& CumWeights, const int32 Num, const double SumWeight, const FRandomStream* RandomStream, const TArray<int32>* GuideTable)
 {
 	const double RandomRoll = UCommonUtils::FRandRangeMaybeWithStream(0.0, SumWeight, RandomStream);
-	int32 SelectedIndex = UCommonUtils::BinarySearchForInsertionInSegment(RandomRoll, CumWeights, 0, Num - 1);
+	int32 SelectedIndex = Num <= FCookedSmallSelectorDistribution::MaxEntries
+		? CountThresholdsNotAbove(CumWeights.GetData(), Num - 1, RandomRoll)  // small tables: the branchless count beats the binary search, with the same result
+		: GuideTable
+		? CountCumulativesNotAboveWithGuide(CumWeights, Num - 1, *GuideTable, SumWeight, RandomRoll)
+		: UCommonUtils::BinarySearchForInsertionInSegment(RandomRoll, CumWeights, 0, Num - 1);
 
 	// guard against rare cases where it rolls exactly sum weight and one or more elements at the end are with zero weights
 	if (SelectedIndex == Num - 1)
@@ -395,10 +1733,14 @@ int32 USelectorUtils::SelectWithCumWeightsHelper(const TArray<double>& CumWeight
 	return SelectedIndex;
 }
 
-int32 USelectorUtils::SelectWithCumProbsHelper(const TArray<double>& CumProbs, const int32 Num, const FRandomStream* RandomStream)
+int32 USelectorUtils::SelectWithCumProbsHelper(const TArray<double>& CumProbs, const int32 Num, const FRandomStream* RandomStream, const TArray<int32>* GuideTable)
 {
 	const double RandomRoll = UCommonUtils::FRandMaybeWithStream(RandomStream);
-	int32 SelectedIndex = UCommonUtils::BinarySearchForInsertionInSegment(RandomRoll, CumProbs, 0, Num);  // here Num is included to accommodate the case where total prob being not enough
+	int32 SelectedIndex = Num <= FCookedSmallSelectorDistribution::MaxEntries  // here Num is included to accommodate the case where total prob being not enough
+		? CountThresholdsNotAbove(CumProbs.GetData(), Num, RandomRoll)  // small tables: the branchless count beats the binary search, with the same result
+		: GuideTable
+		? CountCumulativesNotAboveWithGuide(CumProbs, Num, *GuideTable, 1.0, RandomRoll)
+		: UCommonUtils::BinarySearchForInsertionInSegment(RandomRoll, CumProbs, 0, Num);
 
 	if (SelectedIndex == Num)
 	{
@@ -0,0 +1,193 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+
+#include "SharedCookedDistribution.h"
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+	/** Threads reading at once beyond this many share a counter instead, which holds back all freeing while non-zero. */
+	constexpr int32 MaxReaderSlots = 256;
+
+	/** Reader epochs shared by all the shared distributions. A slot holds the epoch announced by the reading thread owning it, 0 when not reading. */
+	struct FReaderEpochs
+	{
+		std::atomic<uint64> Epoch{1};
+		std::atomic<uint64> Slots[MaxReaderSlots] = {};
+		std::atomic<bool> SlotsTaken[MaxReaderSlots] = {};
+		std::atomic<int32> NumUnslottedReaders{0};
+
+		int32 ClaimSlot()
+		{
+			for (int32 SlotIdx = 0; SlotIdx < MaxReaderSlots; SlotIdx++)
+			{
+				bool bExpected = false;
+				if (!SlotsTaken[SlotIdx].load(std::memory_order_relaxed) && SlotsTaken[SlotIdx].compare_exchange_strong(bExpected, true))
+				{
+					return SlotIdx;
+				}
+			}
+			return INDEX_NONE;
+		}
+
+		/** Oldest epoch announced by a thread still reading, 0 if any unslotted thread is reading and MAX_uint64 if none is. */
+		uint64 GetOldestReaderEpoch() const
+		{
+			if (NumUnslottedReaders.load() > 0)
+			{
+				return 0;
+			}
+			uint64 OldestEpoch = MAX_uint64;
+			for (const std::atomic<uint64>& Slot : Slots)
+			{
+				const uint64 SlotEpoch = Slot.load();
+				OldestEpoch = SlotEpoch != 0 ? FMath::Min(OldestEpoch, SlotEpoch) : OldestEpoch;
+			}
+			return OldestEpoch;
+		}
+	};
+
+	FReaderEpochs& GetReaderEpochs()
+	{
+		static FReaderEpochs ReaderEpochs;
+		return ReaderEpochs;
+	}
+
+	/** Reader slot of the current thread, claimed by its first read and released when the thread exits. */
+	struct FLocalReaderSlot
+	{
+		int32 SlotIdx = INDEX_NONE;
+		int32 Depth = 0;
+
+		~FLocalReaderSlot()
+		{
+			if (SlotIdx != INDEX_NONE)
+			{
+				GetReaderEpochs().SlotsTaken[SlotIdx].store(false, std::memory_order_release);
+			}
+		}
+	};
+
+	thread_local FLocalReaderSlot LocalReaderSlot;
+}
+
+TSharedRef<FSharedCookedDistribution, ESPMode::ThreadSafe> FSharedCookedDistribution::Create(const FCookedSelectorDistribution& InDistribution)
+{
+	TSharedRef<FSharedCookedDistribution, ESPMode::ThreadSafe> Shared = MakeShareable(new FSharedCookedDistribution(InDistribution));
+	TWeakPtr<FSharedCookedDistribution, ESPMode::ThreadSafe> WeakShared = Shared;
+	Shared->TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakShared](float DeltaTime)
+	{
+		const TSharedPtr<FSharedCookedDistribution, ESPMode::ThreadSafe> PinnedShared = WeakShared.Pin();
+		return PinnedShared ? PinnedShared->OnTick(DeltaTime) : false;
+	}));
+	return Shared;
+}
+
+FSharedCookedDistribution::FSharedCookedDistribution(const FCookedSelectorDistribution& InDistribution)
+{
+	TSharedPtr<FVersion, ESPMode::ThreadSafe> Version = MakeShared<FVersion, ESPMode::ThreadSafe>();
+	Version->Distribution = InDistribution;
+	Version->VersionNumber = 1;
+	CurrentVersion = Version;
+	Current.store(Version.Get(), std::memory_order_release);
+}
+
+FSharedCookedDistribution::~FSharedCookedDistribution()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+}
+
+int32 FSharedCookedDistribution::Select(const FRandomStream* RandomStream) const
+{
+	return Read([RandomStream](const FVersion& Version) { return USelectorUtils::SelectWithCookedDistribution(Version.Distribution, RandomStream); });
+}
+
+void FSharedCookedDistribution::EnterRead()
+{
+	FLocalReaderSlot& Local = LocalReaderSlot;
+	if (Local.Depth++ > 0)
+	{
+		return;
+	}
+
+	// announced before loading the version (both sequentially consistent), so a reclaimer scanning after the announcement sees it,
+	// and one scanning before it has swapped out whatever it frees before this thread loads anything
+	FReaderEpochs& ReaderEpochs = GetReaderEpochs();
+	if (Local.SlotIdx == INDEX_NONE)
+	{
+		Local.SlotIdx = ReaderEpochs.ClaimSlot();
+	}
+	if (Local.SlotIdx != INDEX_NONE)
+	{
+		ReaderEpochs.Slots[Local.SlotIdx].store(ReaderEpochs.Epoch.load());
+	}
+	else
+	{
+		ReaderEpochs.NumUnslottedReaders.fetch_add(1);
+	}
+}
+
+void FSharedCookedDistribution::ExitRead()
+{
+	FLocalReaderSlot& Local = LocalReaderSlot;
+	if (--Local.Depth > 0)
+	{
+		return;
+	}
+
+	FReaderEpochs& ReaderEpochs = GetReaderEpochs();
+	if (Local.SlotIdx != INDEX_NONE)
+	{
+		ReaderEpochs.Slots[Local.SlotIdx].store(0, std::memory_order_release);
+	}
+	else
+	{
+		ReaderEpochs.NumUnslottedReaders.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+TSharedRef<const FSharedCookedDistribution::FVersion, ESPMode::ThreadSafe> FSharedCookedDistribution::Pin() const
+{
+	FScopeLock ScopeLock(&PublishLock);
+	return CurrentVersion.ToSharedRef();
+}
+
+uint32 FSharedCookedDistribution::Publish(const FCookedSelectorDistribution& NewDistribution)
+{
+	// copy the distribution outside of the lock, only the swap is serialized between publishers
+	TSharedPtr<FVersion, ESPMode::ThreadSafe> Version = MakeShared<FVersion, ESPMode::ThreadSafe>();
+	Version->Distribution = NewDistribution;
+
+	FScopeLock ScopeLock(&PublishLock);
+	Version->VersionNumber = CurrentVersion->VersionNumber + 1;
+	Current.store(Version.Get());
+
+	FRetiredVersion& Retired = RetiredVersions.AddDefaulted_GetRef();
+	Retired.Version = MoveTemp(CurrentVersion);
+	Retired.RetireEpoch = GetReaderEpochs().Epoch.fetch_add(1);  // after the swap, so only readers announcing up to it may hold the old version
+	CurrentVersion = MoveTemp(Version);
+	return CurrentVersion->VersionNumber;
+}
+
+int32 FSharedCookedDistribution::GetNumRetiredVersions() const
+{
+	FScopeLock ScopeLock(&PublishLock);
+	return RetiredVersions.Num();
+}
+
+bool FSharedCookedDistribution::OnTick(float DeltaTime)
+{
+	TArray<TSharedPtr<const FVersion, ESPMode::ThreadSafe>> FreedVersions;  // released outside of the lock
+	{
+		FScopeLock ScopeLock(&PublishLock);
+		const uint64 OldestReaderEpoch = GetReaderEpochs().GetOldestReaderEpoch();
+		int32 NumFreed = 0;
+		while (NumFreed < RetiredVersions.Num() && RetiredVersions[NumFreed].RetireEpoch < OldestReaderEpoch)  // retired in epoch order
+		{
+			FreedVersions.Add(MoveTemp(RetiredVersions[NumFreed].Version));
+			NumFreed++;
+		}
+		RetiredVersions.RemoveAt(0, NumFreed, false);
+	}
+	return true;
+}
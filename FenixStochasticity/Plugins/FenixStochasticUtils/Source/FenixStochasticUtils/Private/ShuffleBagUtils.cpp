@@ -0,0 +1,248 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+
+#include "ShuffleBagUtils.h"
+#include "CommonUtils.h"
+#include "FenixStochasticStats.h"
+#include "SelectorCallSiteUtils.h"
+#include "SelectorAuditLog.h"
+#include "Algo/Sort.h"
+
+bool UShuffleBagUtils::CookShuffleBag(const FCookedSelectorDistribution& Distribution, const int64 DeckSize, FSelectorShuffleBag& OutBag)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixCookShuffleBag);
+	INC_DWORD_STAT(STAT_FenixCookCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Distribution.CumWeightsOrCumProbs.Num());
+
+	OutBag = FSelectorShuffleBag();
+
+	// Differentiate the cumulatives back into masses, the same way the cumulative selection reads them
+	const TArray<double>& Cums = Distribution.CumWeightsOrCumProbs;
+	const int32 Num = Cums.Num();
+	const double Cap = Distribution.bIsProbs ? 1.0 : TNumericLimits<double>::Max();
+	TArray<double> Masses;
+	Masses.SetNumUninitialized(Num + 1);
+	double PrevCum = 0.0;
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		const double Cum = FMath::Clamp(Cums[Idx], PrevCum, FMath::Max(Cap, PrevCum));
+		Masses[Idx] = Cum - PrevCum;
+		PrevCum = Cum;
+	}
+	Masses[Num] = Distribution.bIsProbs && 1.0 - PrevCum >= 1e-6 ? 1.0 - PrevCum : 0.0;  // rolling outside of the probabilities counts as failure, with the same tolerance as the cumulative probability selection
+	const double TotalMass = PrevCum + Masses[Num];
+	if (DeckSize <= 0 || PrevCum <= 0.0)
+	{
+		return false;
+	}
+
+	// largest remainder method: floor the quotas, then give the cards left to the largest fractional parts (lower index first on ties)
+	TArray<int64> Counts;
+	Counts.SetNumUninitialized(Num + 1);
+	TArray<TPair<double, int32>> Fractions;
+	Fractions.Reserve(Num + 1);
+	int64 NumAssigned = 0;
+	for (int32 Idx = 0; Idx <= Num; Idx++)
+	{
+		const double Quota = static_cast<double>(DeckSize) * (Masses[Idx] / TotalMass);
+		const double Floor = FMath::FloorToDouble(Quota);
+		Counts[Idx] = static_cast<int64>(Floor);
+		NumAssigned += Counts[Idx];
+		if (Masses[Idx] > 0.0)
+		{
+			Fractions.Emplace(Quota - Floor, Idx);
+		}
+	}
+	Algo::Sort(Fractions, [](const TPair<double, int32>& A, const TPair<double, int32>& B)
+	{
+		return A.Key > B.Key || (A.Key == B.Key && A.Value < B.Value);
+	});
+	for (int32 FractionIdx = 0; NumAssigned < DeckSize && Fractions.Num() > 0; FractionIdx = (FractionIdx + 1) % Fractions.Num())
+	{
+		Counts[Fractions[FractionIdx].Value]++;
+		NumAssigned++;
+	}
+
+	OutBag.DeckCounts = MoveTemp(Counts);
+	OutBag.NumEntries = Num;
+	OutBag.TableId = Distribution.TableId != 0 ? Distribution.TableId : static_cast<int32>(FSelectorAuditLog::MakeTableId(Cums));
+	RefillShuffleBag(OutBag);
+	OutBag.NumRefills = 0;
+	return true;
+}
+
+bool UShuffleBagUtils::CookShuffleBagFromCounts(const TArray<int64>& Counts, FSelectorShuffleBag& OutBag)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixCookShuffleBag);
+	INC_DWORD_STAT(STAT_FenixCookCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Counts.Num());
+
+	OutBag = FSelectorShuffleBag();
+	OutBag.DeckCounts.Reserve(Counts.Num() + 1);
+	TArray<double> TableValues;  // for the audit table id
+	TableValues.Reserve(Counts.Num());
+	for (const int64 Count : Counts)
+	{
+		OutBag.DeckCounts.Add(FMath::Max(Count, static_cast<int64>(0)));
+		TableValues.Add(static_cast<double>(OutBag.DeckCounts.Last()));
+	}
+	OutBag.DeckCounts.Add(0);  // no failure cards
+	OutBag.NumEntries = Counts.Num();
+	OutBag.TableId = static_cast<int32>(FSelectorAuditLog::MakeTableId(TableValues));
+	RefillShuffleBag(OutBag);
+	OutBag.NumRefills = 0;
+	return OutBag.DeckSize > 0;
+}
+
+void UShuffleBagUtils::RefillShuffleBag(FSelectorShuffleBag& Bag)
+{
+	BuildRemainingTree(Bag.DeckCounts, Bag.RemainingTree);
+	Bag.DeckSize = 0;
+	for (const int64 Count : Bag.DeckCounts)
+	{
+		Bag.DeckSize += Count;
+	}
+	Bag.NumRemaining = Bag.DeckSize;
+	Bag.NumRefills++;
+}
+
+FSelectorShuffleBagSnapshot UShuffleBagUtils::SnapshotShuffleBag(const FSelectorShuffleBag& Bag)
+{
+	FSelectorShuffleBagSnapshot Snapshot;
+	Snapshot.DeckCounts = Bag.DeckCounts;
+	Snapshot.NumRefills = Bag.NumRefills;
+	Snapshot.TableId = Bag.TableId;
+
+	// undo the tree building in O(entries), from the last node to the first
+	Snapshot.RemainingCounts = Bag.RemainingTree;
+	TArray<int64>& Counts = Snapshot.RemainingCounts;
+	const int32 Num = Counts.Num();
+	for (int32 Node = Num; Node >= 1; Node--)
+	{
+		const int32 Parent = Node + (Node & -Node);
+		if (Parent <= Num)
+		{
+			Counts[Parent - 1] -= Counts[Node - 1];
+		}
+	}
+	return Snapshot;
+}
+
+bool UShuffleBagUtils::RestoreShuffleBag(const FSelectorShuffleBagSnapshot& Snapshot, FSelectorShuffleBag& OutBag)
+{
+	const int32 Num = Snapshot.DeckCounts.Num();
+	if (Num == 0 || Snapshot.RemainingCounts.Num() != Num)
+	{
+		return false;
+	}
+	int64 DeckSize = 0;
+	int64 NumRemaining = 0;
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		if (Snapshot.DeckCounts[Idx] < 0 || Snapshot.RemainingCounts[Idx] < 0 || Snapshot.RemainingCounts[Idx] > Snapshot.DeckCounts[Idx])
+		{
+			return false;
+		}
+		DeckSize += Snapshot.DeckCounts[Idx];
+		NumRemaining += Snapshot.RemainingCounts[Idx];
+	}
+
+	OutBag.DeckCounts = Snapshot.DeckCounts;
+	BuildRemainingTree(Snapshot.RemainingCounts, OutBag.RemainingTree);
+	OutBag.DeckSize = DeckSize;
+	OutBag.NumRemaining = NumRemaining;
+	OutBag.NumEntries = Num - 1;
+	OutBag.NumRefills = Snapshot.NumRefills;
+	OutBag.TableId = Snapshot.TableId;
+	return true;
+}
+
+int64 UShuffleBagUtils::GetShuffleBagRemainingCount(const FSelectorShuffleBag& Bag, const int32 Index)
+{
+	const TArray<int64>& Tree = Bag.RemainingTree;
+	if (!Tree.IsValidIndex(Index))
+	{
+		return 0;
+	}
+
+	// prefix sum up to Index minus the one before it
+	int64 Count = 0;
+	for (int32 Node = Index + 1; Node > 0; Node -= Node & -Node)
+	{
+		Count += Tree[Node - 1];
+	}
+	for (int32 Node = Index; Node > 0; Node -= Node & -Node)
+	{
+		Count -= Tree[Node - 1];
+	}
+	return Count;
+}
+
+int32 UShuffleBagUtils::BPFunc_DrawFromShuffleBag(FSelectorShuffleBag& Bag)
+{
+	return DrawFromShuffleBag(Bag);
+}
+
+int32 UShuffleBagUtils::BPFunc_DrawFromShuffleBagFromStream(FSelectorShuffleBag& Bag, const FRandomStream& RandomStream)
+{
+	return DrawFromShuffleBag(Bag, &RandomStream);
+}
+
+int32 UShuffleBagUtils::DrawFromShuffleBag(FSelectorShuffleBag& Bag, const FRandomStream* RandomStream)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixDrawFromShuffleBag);
+	INC_DWORD_STAT(STAT_FenixDrawFromShuffleBagCalls);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Bag.RemainingTree.Num());
+
+	if (Bag.NumRemaining <= 0)
+	{
+		if (Bag.DeckSize <= 0)
+		{
+			return -1;
+		}
+		RefillShuffleBag(Bag);
+	}
+
+	const int32 SeedBeforeRoll = FSelectorAuditLog::GetStreamSeed(RandomStream);
+	int64 Card = static_cast<int64>(UCommonUtils::RandBounded64MaybeWithStream(static_cast<uint64>(Bag.NumRemaining), RandomStream));
+
+	// descend the Fenwick tree to the entry whose prefix count exceeds the card, decrementing the nodes on the way back up
+	TArray<int64>& Tree = Bag.RemainingTree;
+	const int32 Num = Tree.Num();
+	int32 Position = 0;
+	for (int32 Step = static_cast<int32>(FMath::RoundUpToPowerOfTwo(static_cast<uint32>(Num) + 1) >> 1); Step > 0; Step >>= 1)
+	{
+		const int32 Next = Position + Step;
+		if (Next <= Num && Tree[Next - 1] <= Card)
+		{
+			Position = Next;
+			Card -= Tree[Next - 1];
+		}
+	}
+	for (int32 Node = Position + 1; Node <= Num; Node += Node & -Node)
+	{
+		Tree[Node - 1]--;
+	}
+	Bag.NumRemaining--;
+
+	const int32 SelectedIndex = Position < Bag.NumEntries ? Position : -1;
+	if (FSelectorAuditLog::IsEnabled())
+	{
+		FSelectorAuditLog::Record(static_cast<uint32>(Bag.TableId), SelectedIndex, SeedBeforeRoll);
+	}
+	return SelectedIndex;
+}
+
+void UShuffleBagUtils::BuildRemainingTree(const TArray<int64>& Counts, TArray<int64>& OutTree)
+{
+	OutTree = Counts;
+	const int32 Num = OutTree.Num();
+	for (int32 Node = 1; Node <= Num; Node++)
+	{
+		const int32 Parent = Node + (Node & -Node);
+		if (Parent <= Num)
+		{
+			OutTree[Parent - 1] += OutTree[Node - 1];
+		}
+	}
+}
@@ -0,0 +1,205 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+
+#include "ShuffleUtils.h"
+#include "FenixStochasticStats.h"
+#include "SelectorCallSiteUtils.h"
+#include "Algo/Sort.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	/** Arrays at least this large are sorted in parallel. */
+	constexpr int32 ParallelSortThreshold = 16384;
+
+	/** Parallel chunks of the sort, a power of two so the merge rounds pair them up evenly. */
+	constexpr int32 NumParallelSortChunks = 16;
+
+	struct FWeightedShuffleKey
+	{
+		double Key;
+		int32 Index;
+	};
+
+	/** Descending keys, ties by index so the order does not depend on the sort. */
+	FORCEINLINE bool IsKeyBefore(const FWeightedShuffleKey& A, const FWeightedShuffleKey& B)
+	{
+		return A.Key > B.Key || (A.Key == B.Key && A.Index < B.Index);
+	}
+
+	/** Sort chunks in parallel, then merge pairs of sorted runs in parallel rounds. */
+	void SortKeys(TArray<FWeightedShuffleKey>& Keys)
+	{
+		const int32 Num = Keys.Num();
+		if (Num < ParallelSortThreshold)
+		{
+			Algo::Sort(Keys, IsKeyBefore);
+			return;
+		}
+
+		const int32 ChunkSize = FMath::DivideAndRoundUp(Num, NumParallelSortChunks);
+		ParallelFor(NumParallelSortChunks, [&Keys, ChunkSize, Num](const int32 ChunkIdx)
+		{
+			const int32 Start = FMath::Min(ChunkIdx * ChunkSize, Num);
+			const int32 End = FMath::Min(Start + ChunkSize, Num);
+			Algo::Sort(MakeArrayView(Keys.GetData() + Start, End - Start), IsKeyBefore);
+		});
+
+		TArray<FWeightedShuffleKey> Buffer;
+		Buffer.SetNumUninitialized(Num);
+		FWeightedShuffleKey* Source = Keys.GetData();
+		FWeightedShuffleKey* Dest = Buffer.GetData();
+		for (int32 RunSize = ChunkSize; RunSize < Num; RunSize *= 2)
+		{
+			const int32 NumPairs = FMath::DivideAndRoundUp(Num, 2 * RunSize);
+			ParallelFor(NumPairs, [Source, Dest, RunSize, Num](const int32 PairIdx)
+			{
+				const int32 Start = PairIdx * 2 * RunSize;
+				const int32 Mid = FMath::Min(Start + RunSize, Num);
+				const int32 End = FMath::Min(Start + 2 * RunSize, Num);
+				int32 Left = Start;
+				int32 Right = Mid;
+				int32 Out = Start;
+				while (Left < Mid && Right < End)
+				{
+					Dest[Out++] = IsKeyBefore(Source[Right], Source[Left]) ? Source[Right++] : Source[Left++];
+				}
+				while (Left < Mid)
+				{
+					Dest[Out++] = Source[Left++];
+				}
+				while (Right < End)
+				{
+					Dest[Out++] = Source[Right++];
+				}
+			});
+			Swap(Source, Dest);
+		}
+		if (Source != Keys.GetData())
+		{
+			Keys = MoveTemp(Buffer);
+		}
+	}
+}
+
+void UShuffleUtils::Array_Shuffle(const TArray<int32>& TargetArray)
+{
+	// We should never hit these!  They're stubs to avoid NoExport on the class.  Call the Generic* equivalent instead
+	check(0);
+}
+
+void UShuffleUtils::Array_ShuffleFromStream(const TArray<int32>& TargetArray, const FRandomStream& RandomStream)
+{
+	// We should never hit these!  They're stubs to avoid NoExport on the class.  Call the Generic* equivalent instead
+	check(0);
+}
+
+void UShuffleUtils::Array_WeightedShuffle(const TArray<int32>& TargetArray, const TArray<double>& Weights)
+{
+	// We should never hit these!  They're stubs to avoid NoExport on the class.  Call the Generic* equivalent instead
+	check(0);
+}
+
+void UShuffleUtils::Array_WeightedShuffleFromStream(const TArray<int32>& TargetArray, const TArray<double>& Weights, const FRandomStream& RandomStream)
+{
+	// We should never hit these!  They're stubs to avoid NoExport on the class.  Call the Generic* equivalent instead
+	check(0);
+}
+
+void UShuffleUtils::BPFunc_WeightedShuffleIndices(const TArray<double>& Weights, TArray<int32>& OutIndices)
+{
+	WeightedShuffleIndices(Weights, OutIndices);
+}
+
+void UShuffleUtils::BPFunc_WeightedShuffleIndicesFromStream(const TArray<double>& Weights, const FRandomStream& RandomStream, TArray<int32>& OutIndices)
+{
+	WeightedShuffleIndices(Weights, OutIndices, &RandomStream);
+}
+
+void UShuffleUtils::GenericArray_Shuffle(void* TargetArray, const FArrayProperty* ArrayProperty, const FRandomStream* RandomStream)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixShuffle);
+
+	if (!TargetArray)
+	{
+		return;
+	}
+	FScriptArrayHelper ArrayHelper(ArrayProperty, TargetArray);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(ArrayHelper.Num());
+	ShuffleWithSwap(ArrayHelper.Num(), [&ArrayHelper](const int32 IndexA, const int32 IndexB) { ArrayHelper.SwapValues(IndexA, IndexB); }, RandomStream);
+}
+
+void UShuffleUtils::GenericArray_WeightedShuffle(void* TargetArray, const FArrayProperty* ArrayProperty, const TArray<double>& Weights, const FRandomStream* RandomStream)
+{
+	if (!TargetArray)
+	{
+		return;
+	}
+	FScriptArrayHelper ArrayHelper(ArrayProperty, TargetArray);
+	const int32 Num = ArrayHelper.Num();
+	if (Weights.Num() != Num)
+	{
+		FFrame::KismetExecutionMessage(*FString::Printf(TEXT("Weighted Shuffle: %d weights for %d elements, the array is left as is."), Weights.Num(), Num), ELogVerbosity::Warning);
+		return;
+	}
+
+	TArray<int32> Order;
+	WeightedShuffleIndices(Weights, Order, RandomStream);
+
+	// apply the permutation with swaps, tracking where each original element currently is
+	TArray<int32> OriginalAt;  // original index of the element at each position
+	TArray<int32> PositionOf;  // current position of each original element
+	OriginalAt.SetNumUninitialized(Num);
+	PositionOf.SetNumUninitialized(Num);
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		OriginalAt[Idx] = Idx;
+		PositionOf[Idx] = Idx;
+	}
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		const int32 From = PositionOf[Order[Idx]];
+		if (From != Idx)
+		{
+			ArrayHelper.SwapValues(Idx, From);
+			const int32 Displaced = OriginalAt[Idx];
+			OriginalAt[From] = Displaced;
+			PositionOf[Displaced] = From;
+			OriginalAt[Idx] = Order[Idx];
+			PositionOf[Order[Idx]] = Idx;
+		}
+	}
+}
+
+void UShuffleUtils::WeightedShuffleIndices(const TArray<double>& Weights, TArray<int32>& OutIndices, const FRandomStream* RandomStream)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FenixWeightedShuffle);
+	FENIX_REPORT_CALL_SITE_INPUT_SIZE(Weights.Num());
+
+	// keys are drawn sequentially so the stream gives the same order regardless of the parallel sort
+	const int32 Num = Weights.Num();
+	TArray<FWeightedShuffleKey> Keys;
+	Keys.Reserve(Num);
+	TArray<int32> NonPositiveIndices;
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		if (Weights[Idx] > 0.0)
+		{
+			const double U = 1.0 - UCommonUtils::DRandMaybeWithStream(RandomStream);  // (0, 1] for the logarithm
+			Keys.Add({FMath::Loge(U) / Weights[Idx], Idx});  // same order as U^(1 / Weight), without the underflow of small weights
+		}
+		else
+		{
+			NonPositiveIndices.Add(Idx);
+		}
+	}
+	SortKeys(Keys);
+	Shuffle(MakeArrayView(NonPositiveIndices), RandomStream);
+
+	OutIndices.Reset(Num);
+	for (const FWeightedShuffleKey& Key : Keys)
+	{
+		OutIndices.Add(Key.Index);
+	}
+	OutIndices.Append(NonPositiveIndices);
+}
@@ -0,0 +1,62 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "SelectorUtils.h"
+
+#include "AsyncCookSelectorInput.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnSelectorInputCooked, const FCookedSelectorDistribution&, CookedDistribution, const FCookedAliasTable&, AliasTable);
+
+/** Kind of input cooked by UAsyncCookSelectorInput. */
+enum class ESelectorCookInputType : uint8
+{
+	Weights,
+	Probs,
+	WeightOrProbEntries,
+};
+
+/**
+* Async variant of the Cook Selector Input node for large inputs: the input is copied, then cooked on a task worker (optionally with an alias table too),
+* and On Completed fires on the game thread with the result, so the calling frame only pays for the copy.
+*/
+UCLASS()
+class FENIXSTOCHASTICUTILS_API UAsyncCookSelectorInput : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	/** Fired on the game thread with the cooked distribution, and the alias table if asked for (empty otherwise). */
+	UPROPERTY(BlueprintAssignable)
+	FOnSelectorInputCooked OnCompleted;
+
+	/** Cook weights (negative ones regarded as zeros) into a distribution on a worker thread. */
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject", DisplayName = "Cook Weights Async"), Category = "Fenix|SelectorUtils|SelectionPreprocessing")
+	static UAsyncCookSelectorInput* CookWeightsAsync(UObject* WorldContextObject, const TArray<double>& Weights, const bool bBuildAliasTable = false);
+
+	/** Cook probabilities (negative ones regarded as zeros) into a distribution on a worker thread. */
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject", DisplayName = "Cook Probs Async"), Category = "Fenix|SelectorUtils|SelectionPreprocessing")
+	static UAsyncCookSelectorInput* CookProbsAsync(UObject* WorldContextObject, const TArray<double>& Probs, const bool bBuildAliasTable = false);
+
+	/** Cook WeightOrProbEntry's into a distribution on a worker thread, the same as Cook Selector Distribution. */
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject", DisplayName = "Cook WeightOrProb Entries Async"), Category = "Fenix|SelectorUtils|SelectionPreprocessing")
+	static UAsyncCookSelectorInput* CookWeightOrProbEntriesAsync(UObject* WorldContextObject, const TArray<FWeightOrProbEntry>& Entries, const bool bBuildAliasTable = false);
+
+	virtual void Activate() override;
+
+private:
+	static UAsyncCookSelectorInput* CreateAction(UObject* WorldContextObject, const ESelectorCookInputType InInputType, const bool bInBuildAliasTable);
+
+	/** Cook on the worker thread. */
+	static void Cook(const ESelectorCookInputType InputType, const TArray<double>& Values, const TArray<FWeightOrProbEntry>& Entries, const bool bBuildAliasTable,
+		FCookedSelectorDistribution& OutDistribution, FCookedAliasTable& OutAliasTable);
+
+	ESelectorCookInputType InputType = ESelectorCookInputType::Weights;
+	bool bBuildAliasTable = false;
+
+	/** Copied input, moved to the worker on activation. */
+	TArray<double> Values;
+	TArray<FWeightOrProbEntry> Entries;
+};
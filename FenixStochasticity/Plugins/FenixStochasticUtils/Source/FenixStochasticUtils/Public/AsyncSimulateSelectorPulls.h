@@ -0,0 +1,69 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "SelectorUtils.h"
+#include <atomic>
+
+#include "AsyncSimulateSelectorPulls.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnSelectorPullsProgress, int64, NumPullsDone, float, Progress);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnSelectorPullsSimulated, const TArray<int64>&, Counts, int64, NumFailures);
+
+/**
+* Simulate many selections from a cooked distribution on worker threads (e.g. for a drop rate preview), reporting progress and the final count of each index.
+* Pulls are drawn from an alias table in batches, each batch with its own stream seeded from Seed and the batch index, so the counts only depend on Seed.
+*/
+UCLASS()
+class FENIXSTOCHASTICUTILS_API UAsyncSimulateSelectorPulls : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	/** Fired on the game thread about every percent of the pulls. */
+	UPROPERTY(BlueprintAssignable)
+	FOnSelectorPullsProgress OnProgress;
+
+	/** Fired on the game thread with one count per entry and the number of pulls selecting nothing (probabilities summing below 1). */
+	UPROPERTY(BlueprintAssignable)
+	FOnSelectorPullsSimulated OnCompleted;
+
+	/** Simulate NumPulls selections with given CookedSelectorDistribution on worker threads. */
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject", DisplayName = "Simulate Selector Pulls Async"), Category = "Fenix|SelectorUtils|Statistics")
+	static UAsyncSimulateSelectorPulls* SimulateSelectorPullsAsync(UObject* WorldContextObject, const FCookedSelectorDistribution& Distribution, const int64 NumPulls, const int32 Seed = 0);
+
+	/** Stop the simulation, On Completed is not fired. */
+	UFUNCTION(BlueprintCallable, Category = "Fenix|SelectorUtils|Statistics")
+	void Cancel();
+
+	virtual void Activate() override;
+
+private:
+	/** State shared with the workers, outliving the action if it gets destroyed first. */
+	struct FSimulation
+	{
+		FCookedAliasTable AliasTable;
+		int64 NumPulls = 0;
+		int32 Seed = 0;
+
+		std::atomic<int64> NumPullsDone{0};
+		std::atomic<bool> bCancelled{false};
+
+		FCriticalSection CountsLock;
+		TArray<int64> Counts;
+		int64 NumFailures = 0;
+	};
+
+	/** Pulls per batch, a batch being the unit of work and of progress. */
+	static constexpr int64 PullsPerBatch = 1 << 20;
+
+	/** Run a batch on the worker, returning the pulls done. */
+	static int64 RunBatch(FSimulation& Simulation, const int64 BatchIdx);
+
+	void ReportProgress(const int64 NumPullsDone);
+
+	TSharedPtr<FSimulation, ESPMode::ThreadSafe> Simulation;
+	int64 LastReportedPulls = 0;
+};
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "Kismet/KismetArrayLibrary.h"
+#include "Kismet/BlueprintMapLibrary.h"
 
 #include "CommonUtils.generated.h"
 
@@ -63,6 +64,50 @@ public:
 		InnerProp->DestroyValue(StorageSpace);
 	}
 
+	/** Outputs both the keys and the values of a map in one call (as opposed to Map_Keys followed by Map_Values). */
+	UFUNCTION(BlueprintCallable, CustomThunk, meta = (MapParam = "TargetMap", MapKeyParam = "Keys", MapValueParam = "Values", BlueprintInternalUseOnly = "true", BlueprintThreadSafe), Category = "Fenix|CommonUtils|Map")
+	static void Map_KeysAndValues(const TMap<int32, int32>& TargetMap, TArray<int32>& Keys, TArray<int32>& Values);
+	DECLARE_FUNCTION(execMap_KeysAndValues)
+	{
+		Stack.MostRecentProperty = nullptr;
+		Stack.StepCompiledIn<FMapProperty>(NULL);
+		void* MapAddr = Stack.MostRecentPropertyAddress;
+		FMapProperty* MapProperty = CastField<FMapProperty>(Stack.MostRecentProperty);
+		if (!MapProperty)
+		{
+			Stack.bArrayContextFailed = true;
+			return;
+		}
+
+		Stack.MostRecentProperty = nullptr;
+		Stack.StepCompiledIn<FArrayProperty>(NULL);
+		void* KeysArrayAddr = Stack.MostRecentPropertyAddress;
+		FArrayProperty* KeysArrayProperty = CastField<FArrayProperty>(Stack.MostRecentProperty);
+		if (!KeysArrayProperty)
+		{
+			Stack.bArrayContextFailed = true;
+			return;
+		}
+
+		Stack.MostRecentProperty = nullptr;
+		Stack.StepCompiledIn<FArrayProperty>(NULL);
+		void* ValuesArrayAddr = Stack.MostRecentPropertyAddress;
+		FArrayProperty* ValuesArrayProperty = CastField<FArrayProperty>(Stack.MostRecentProperty);
+		if (!ValuesArrayProperty)
+		{
+			Stack.bArrayContextFailed = true;
+			return;
+		}
+
+		P_FINISH;
+		P_NATIVE_BEGIN;
+		GenericMap_KeysAndValues(MapAddr, MapProperty, KeysArrayAddr, KeysArrayProperty, ValuesArrayAddr, ValuesArrayProperty);
+		P_NATIVE_END;
+	}
+
+	/** Native implementation of Map_KeysAndValues. */
+	static void GenericMap_KeysAndValues(const void* TargetMap, const FMapProperty* MapProperty, const void* KeysArray, const FArrayProperty* KeysArrayProperty, const void* ValuesArray, const FArrayProperty* ValuesArrayProperty);
+
 	/** Get data table column as a floating point value array. */
 	UFUNCTION(BlueprintCallable, Category = "Fenix|CommonUtils|DataTable")
 	static void GetDataTableColumnAsFloats(const UDataTable* DataTable, const FName PropertyName, TArray<double>& OutValues);
@@ -99,6 +144,85 @@ public:
 		return RandomStream ? RandomStream->FRand() : FMath::FRand();
 	}
 
+	/** RandHelper logic (uniform integer in [0, Max)), but using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream. */
+	static FORCEINLINE int32 RandHelperMaybeWithStream(const int32 Max, const FRandomStream* RandomStream = nullptr)
+	{
+		return RandomStream ? RandomStream->RandHelper(Max) : FMath::RandHelper(Max);
+	}
+
+	/** Uniform 32 random bits, using a random stream if the optional input RandomStream is not nullptr (FMath::Rand only gives 15 bits on some platforms). Threadsafe only when using a stream. */
+	static FORCEINLINE uint32 RandBitsMaybeWithStream(const FRandomStream* RandomStream = nullptr)
+	{
+		return RandomStream ? RandomStream->GetUnsignedInt() : (static_cast<uint32>(FMath::Rand()) << 30) ^ (static_cast<uint32>(FMath::Rand()) << 15) ^ static_cast<uint32>(FMath::Rand());
+	}
+
+	/** Uniform 64 random bits, using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream. */
+	static FORCEINLINE uint64 Rand64MaybeWithStream(const FRandomStream* RandomStream = nullptr)
+	{
+		const uint64 High = RandBitsMaybeWithStream(RandomStream);
+		return (High << 32) | RandBitsMaybeWithStream(RandomStream);
+	}
+
+	/** Full 128 bit product of two 64 bit integers: returns the low half and outputs the high half. */
+	static FORCEINLINE uint64 Multiply64To128(const uint64 A, const uint64 B, uint64& OutHigh)
+	{
+#if defined(__SIZEOF_INT128__)
+		const unsigned __int128 Product = static_cast<unsigned __int128>(A) * B;
+		OutHigh = static_cast<uint64>(Product >> 64);
+		return static_cast<uint64>(Product);
+#else
+		const uint64 ALow = A & 0xFFFFFFFFull;
+		const uint64 AHigh = A >> 32;
+		const uint64 BLow = B & 0xFFFFFFFFull;
+		const uint64 BHigh = B >> 32;
+		const uint64 LowLow = ALow * BLow;
+		const uint64 LowHigh = ALow * BHigh;
+		const uint64 HighLow = AHigh * BLow;
+		const uint64 Cross = (LowLow >> 32) + (LowHigh & 0xFFFFFFFFull) + HighLow;  // cannot overflow
+		OutHigh = AHigh * BHigh + (LowHigh >> 32) + (Cross >> 32);
+		return (Cross << 32) | (LowLow & 0xFFFFFFFFull);
+#endif
+	}
+
+	/** Uniform integer in [0, Bound) with Lemire's multiply and reject method (a division only on the rare possibly biased draws). Bound must be positive. Threadsafe only when using a stream. */
+	static FORCEINLINE uint32 RandBounded32MaybeWithStream(const uint32 Bound, const FRandomStream* RandomStream = nullptr)
+	{
+		uint64 Product = static_cast<uint64>(RandBitsMaybeWithStream(RandomStream)) * Bound;
+		if (static_cast<uint32>(Product) < Bound)
+		{
+			const uint32 Threshold = (0 - Bound) % Bound;
+			while (static_cast<uint32>(Product) < Threshold)
+			{
+				Product = static_cast<uint64>(RandBitsMaybeWithStream(RandomStream)) * Bound;
+			}
+		}
+		return static_cast<uint32>(Product >> 32);
+	}
+
+	/** Uniform integer in [0, Bound) for 64 bit bounds with Lemire's multiply and reject method (a division only on the rare possibly biased draws). Threadsafe only when using a stream. */
+	static FORCEINLINE uint64 RandBounded64MaybeWithStream(const uint64 Bound, const FRandomStream* RandomStream = nullptr)
+	{
+		uint64 High;
+		uint64 Low = Multiply64To128(Rand64MaybeWithStream(RandomStream), Bound, High);
+		if (Low < Bound)
+		{
+			const uint64 Threshold = (0 - Bound) % Bound;
+			while (Low < Threshold)
+			{
+				Low = Multiply64To128(Rand64MaybeWithStream(RandomStream), Bound, High);
+			}
+		}
+		return High;
+	}
+
+	/** Uniform double in [0, 1) with 53 random bits (FRand only has 23), using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream. */
+	static FORCEINLINE double DRandMaybeWithStream(const FRandomStream* RandomStream = nullptr)
+	{
+		const uint64 High = RandBitsMaybeWithStream(RandomStream) >> 5;
+		const uint64 Low = RandBitsMaybeWithStream(RandomStream) >> 6;
+		return static_cast<double>((High << 26) | Low) * (1.0 / 9007199254740992.0);
+	}
+
 	/** FRandRange logic, but using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream. */
 	static FORCEINLINE float FRandRangeMaybeWithStream(const float InMin, const float InMax, const FRandomStream* RandomStream = nullptr)
 	{
@@ -0,0 +1,86 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+
+#include "ContinuousSamplerUtils.generated.h"
+
+/**
+* Continuous random variates: normal and exponential with the Ziggurat method (Marsaglia and Tsang, 128 and 256 layers),
+* gamma with Marsaglia and Tsang's squeeze method, then beta and log-normal built on them.
+* Non-positive scale or shape parameters never give NaN: the normal gives its mean, the log-normal exp(Mu), and the others 0.
+*/
+UCLASS(meta = (BlueprintThreadSafe))
+class FENIXSTOCHASTICUTILS_API UContinuousSamplerUtils : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+#pragma region Blueprint only APIs (for C++ direct usage better use ones in the later section)
+	/** Sample a normal (Gaussian) variate. Not thread safe. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Normal", NotBlueprintThreadSafe), Category = "Fenix|ContinuousSamplerUtils")
+	static double BPFunc_SampleNormal(const double Mean = 0.0, const double StdDev = 1.0);
+
+	/** Sample a normal (Gaussian) variate with a random stream. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Normal From Stream"), Category = "Fenix|ContinuousSamplerUtils")
+	static double BPFunc_SampleNormalFromStream(const FRandomStream& RandomStream, const double Mean = 0.0, const double StdDev = 1.0);
+
+	/** Sample an exponential variate with a rate (inverse of the mean). Not thread safe. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Exponential", NotBlueprintThreadSafe), Category = "Fenix|ContinuousSamplerUtils")
+	static double BPFunc_SampleExponential(const double Rate = 1.0);
+
+	/** Sample an exponential variate with a rate (inverse of the mean) with a random stream. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Exponential From Stream"), Category = "Fenix|ContinuousSamplerUtils")
+	static double BPFunc_SampleExponentialFromStream(const FRandomStream& RandomStream, const double Rate = 1.0);
+
+	/** Sample a gamma variate with a shape and a scale (mean being Shape * Scale). Not thread safe. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Gamma", NotBlueprintThreadSafe), Category = "Fenix|ContinuousSamplerUtils")
+	static double BPFunc_SampleGamma(const double Shape = 1.0, const double Scale = 1.0);
+
+	/** Sample a gamma variate with a shape and a scale (mean being Shape * Scale) with a random stream. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Gamma From Stream"), Category = "Fenix|ContinuousSamplerUtils")
+	static double BPFunc_SampleGammaFromStream(const FRandomStream& RandomStream, const double Shape = 1.0, const double Scale = 1.0);
+
+	/** Sample a beta variate in [0, 1] (mean being Alpha / (Alpha + Beta)). Not thread safe. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Beta", NotBlueprintThreadSafe), Category = "Fenix|ContinuousSamplerUtils")
+	static double BPFunc_SampleBeta(const double Alpha = 1.0, const double Beta = 1.0);
+
+	/** Sample a beta variate in [0, 1] (mean being Alpha / (Alpha + Beta)) with a random stream. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Beta From Stream"), Category = "Fenix|ContinuousSamplerUtils")
+	static double BPFunc_SampleBetaFromStream(const FRandomStream& RandomStream, const double Alpha = 1.0, const double Beta = 1.0);
+
+	/** Sample a log-normal variate, whose logarithm is normal with Mu and Sigma. Not thread safe. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Log Normal", NotBlueprintThreadSafe), Category = "Fenix|ContinuousSamplerUtils")
+	static double BPFunc_SampleLogNormal(const double Mu = 0.0, const double Sigma = 1.0);
+
+	/** Sample a log-normal variate, whose logarithm is normal with Mu and Sigma, with a random stream. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Log Normal From Stream"), Category = "Fenix|ContinuousSamplerUtils")
+	static double BPFunc_SampleLogNormalFromStream(const FRandomStream& RandomStream, const double Mu = 0.0, const double Sigma = 1.0);
+#pragma endregion
+
+#pragma region C++ only APIs
+	/**
+	* Single variates. Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	*/
+	static double SampleStandardNormal(const FRandomStream* RandomStream = nullptr);
+	static double SampleStandardExponential(const FRandomStream* RandomStream = nullptr);
+	static double SampleNormal(const double Mean, const double StdDev, const FRandomStream* RandomStream = nullptr);
+	static double SampleExponential(const double Rate, const FRandomStream* RandomStream = nullptr);
+	static double SampleGamma(const double Shape, const double Scale, const FRandomStream* RandomStream = nullptr);
+	static double SampleBeta(const double Alpha, const double Beta, const FRandomStream* RandomStream = nullptr);
+	static double SampleLogNormal(const double Mu, const double Sigma, const FRandomStream* RandomStream = nullptr);
+
+	/**
+	* Batch fills. The stream (or the global random state) only seeds a set of lanes generated in lockstep, advancing it by a few draws regardless of the batch size,
+	* so uniform bits are produced for all the lanes at once (vectorized by the compiler) and the Ziggurat fast path is evaluated per lane without branches.
+	* Results are reproducible with the same stream seed, but differ from repeated single samples. Threadsafe only when using a stream.
+	*/
+	static void FillNormal(TArrayView<double> OutValues, const double Mean, const double StdDev, const FRandomStream* RandomStream = nullptr);
+	static void FillExponential(TArrayView<double> OutValues, const double Rate, const FRandomStream* RandomStream = nullptr);
+	static void FillGamma(TArrayView<double> OutValues, const double Shape, const double Scale, const FRandomStream* RandomStream = nullptr);
+	static void FillBeta(TArrayView<double> OutValues, const double Alpha, const double Beta, const FRandomStream* RandomStream = nullptr);
+	static void FillLogNormal(TArrayView<double> OutValues, const double Mu, const double Sigma, const FRandomStream* RandomStream = nullptr);
+#pragma endregion
+};
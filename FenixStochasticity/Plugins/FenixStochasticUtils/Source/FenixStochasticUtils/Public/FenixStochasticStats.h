@@ -0,0 +1,88 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+/**
+* Stat group for the stochastic utils, shown with "stat FenixStochastic" in builds with stats enabled.
+* Cycle counters measure time per selection/cook path, dword counters are per-frame call/allocation counts.
+*/
+DECLARE_STATS_GROUP(TEXT("FenixStochastic"), STATGROUP_FenixStochastic, STATCAT_Advanced);
+
+// Selection paths
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Select With Cum Weights"), STAT_FenixSelectWithCumWeights, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Select With Weights"), STAT_FenixSelectWithWeights, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Select With Cum Probs"), STAT_FenixSelectWithCumProbs, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Select With Probs"), STAT_FenixSelectWithProbs, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Select With Cooked Distribution"), STAT_FenixSelectWithCookedDistribution, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Select With WeightOrProb Entries"), STAT_FenixSelectWithWeightOrProbEntries, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("DataTable Input Extraction"), STAT_FenixDataTableExtraction, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Map Input Extraction"), STAT_FenixMapExtraction, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Select With Alias Table"), STAT_FenixSelectWithAliasTable, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Sample Surface Points"), STAT_FenixSampleSurfacePoints, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Poisson Disk Sampling"), STAT_FenixPoissonDiskSampling, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Sample Density Map"), STAT_FenixSampleDensityMap, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Fill Continuous Values"), STAT_FenixFillContinuousValues, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Sample Counts"), STAT_FenixSampleCounts, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Shuffle"), STAT_FenixShuffle, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Weighted Shuffle"), STAT_FenixWeightedShuffle, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Draw From Shuffle Bag"), STAT_FenixDrawFromShuffleBag, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Select With Quantized Distribution"), STAT_FenixSelectWithQuantizedDistribution, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Select With Tickets"), STAT_FenixSelectWithTickets, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Select With Small Distribution"), STAT_FenixSelectWithSmallDistribution, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Select With Weighted Search Tree"), STAT_FenixSelectWithWeightedSearchTree, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Select With Compact Distribution"), STAT_FenixSelectWithCompactDistribution, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Select With Category Selector"), STAT_FenixSelectWithCategorySelector, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+
+// Cooking
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Make Cumulatives"), STAT_FenixMakeCumulatives, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cook Selector Distribution"), STAT_FenixCookSelectorDistribution, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cook Alias Table"), STAT_FenixCookAliasTable, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cook Surface Sampler"), STAT_FenixCookSurfaceSampler, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cook Density Map Sampler"), STAT_FenixCookDensityMapSampler, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cook Shuffle Bag"), STAT_FenixCookShuffleBag, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cook Quantized Distribution"), STAT_FenixCookQuantizedDistribution, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cook Small Selector Distribution"), STAT_FenixCookSmallSelectorDistribution, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cook Weighted Search Tree"), STAT_FenixCookWeightedSearchTree, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cook Compact Distribution"), STAT_FenixCookCompactDistribution, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cook Category Selector"), STAT_FenixCookCategorySelector, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+
+// Save state encoding
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Encode Selector Save States"), STAT_FenixEncodeSelectorSaveStates, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Decode Selector Save States"), STAT_FenixDecodeSelectorSaveStates, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+
+// Per-frame call counts
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Select With Cum Weights Calls"), STAT_FenixSelectWithCumWeightsCalls, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Select With Weights Calls"), STAT_FenixSelectWithWeightsCalls, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Select With Cum Probs Calls"), STAT_FenixSelectWithCumProbsCalls, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Select With Probs Calls"), STAT_FenixSelectWithProbsCalls, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Select With Cooked Distribution Calls"), STAT_FenixSelectWithCookedDistributionCalls, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Select With WeightOrProb Entries Calls"), STAT_FenixSelectWithWeightOrProbEntriesCalls, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("DataTable Extraction Calls"), STAT_FenixDataTableExtractionCalls, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Map Extraction Calls"), STAT_FenixMapExtractionCalls, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Select With Alias Table Calls"), STAT_FenixSelectWithAliasTableCalls, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sampled Surface Points"), STAT_FenixSampledSurfacePoints, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sampled Density Map Points"), STAT_FenixSampledDensityMapPoints, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Filled Continuous Values"), STAT_FenixFilledContinuousValues, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Draw From Shuffle Bag Calls"), STAT_FenixDrawFromShuffleBagCalls, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Select With Quantized Distribution Calls"), STAT_FenixSelectWithQuantizedDistributionCalls, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Select With Tickets Calls"), STAT_FenixSelectWithTicketsCalls, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Select With Small Distribution Calls"), STAT_FenixSelectWithSmallDistributionCalls, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Select With Weighted Search Tree Calls"), STAT_FenixSelectWithWeightedSearchTreeCalls, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Select With Compact Distribution Calls"), STAT_FenixSelectWithCompactDistributionCalls, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Select With Category Selector Calls"), STAT_FenixSelectWithCategorySelectorCalls, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cook Calls"), STAT_FenixCookCalls, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+
+// Temporary allocations made by the uncooked selection paths
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Temp Allocations"), STAT_FenixTempAllocations, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Temp Allocated Bytes"), STAT_FenixTempAllocatedBytes, STATGROUP_FenixStochastic, FENIXSTOCHASTICUTILS_API);
+
+/** Record one temporary cumulative array allocation of Num doubles. */
+#define FENIX_STAT_TEMP_ALLOCATION(Num) \
+	do \
+	{ \
+		INC_DWORD_STAT(STAT_FenixTempAllocations); \
+		INC_DWORD_STAT_BY(STAT_FenixTempAllocatedBytes, (Num) * sizeof(double)); \
+	} while (0)
@@ -0,0 +1,327 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "SelectorUtils.h"
+
+#include "PositionSamplerUtils.generated.h"
+
+class UStaticMesh;
+class UTexture2D;
+class ANavigationData;
+
+/**
+* A triangle surface cooked for uniform random point sampling: triangles are selected by area with an alias table,
+* then a point is sampled uniformly within the triangle, so each point costs O(1) regardless of the triangle count.
+*/
+USTRUCT(BlueprintType)
+struct FENIXSTOCHASTICUTILS_API FCookedSurfaceSampler
+{
+	GENERATED_BODY()
+
+	/** Three vectors per triangle: the first vertex, then the two edges from it. */
+	UPROPERTY()
+	TArray<FVector> TriangleVectors;
+
+	/** Area weighted alias table over the triangles. */
+	UPROPERTY()
+	FCookedAliasTable AreaAliasTable;
+
+	/** Total surface area. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	double TotalArea = 0.0;
+
+	int32 GetNumTriangles() const { return TriangleVectors.Num() / 3; }
+};
+
+/**
+* A 2D density map (texture or float grid) cooked for importance sampling: a row is selected by the row totals (marginal),
+* then a texel within the row (conditional), then the point is jittered uniformly within the texel.
+* With cumulative tables a sample costs O(log SizeX + log SizeY), with alias tables O(1) but partial updates rebuild whole rows.
+*/
+USTRUCT(BlueprintType)
+struct FENIXSTOCHASTICUTILS_API FCookedDensityMapSampler
+{
+	GENERATED_BODY()
+
+	/** Densities as cooked (negatives clamped to 0), row major. Kept for partial updates. */
+	UPROPERTY()
+	TArray<float> Densities;
+
+	/** Total density of each row. */
+	UPROPERTY()
+	TArray<double> RowTotals;
+
+	/** Cumulative densities within each row, row major. Empty with alias tables. */
+	UPROPERTY()
+	TArray<double> RowCumDensities;
+
+	/** Cumulative row totals. Empty with alias tables. */
+	UPROPERTY()
+	TArray<double> MarginalCumDensities;
+
+	/** Alias table of each row. Empty with cumulative tables. */
+	UPROPERTY()
+	TArray<FCookedAliasTable> RowAliasTables;
+
+	/** Alias table over the row totals. Empty with cumulative tables. */
+	UPROPERTY()
+	FCookedAliasTable MarginalAliasTable;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 SizeX = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 SizeY = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	bool bUseAliasTables = false;
+
+	/** Sum of all the densities, nothing can be sampled if not positive. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	double TotalDensity = 0.0;
+};
+
+/**
+* Densities over the XY extent of a sampled region, on a SizeX by SizeY grid (row major, bilinearly interpolated).
+*/
+USTRUCT(BlueprintType)
+struct FENIXSTOCHASTICUTILS_API FPoissonDiskDensityMap
+{
+	GENERATED_BODY()
+
+	/** Densities in [0, 1]: 1 spaces points by MinDistance, towards 0 by up to MaxDistance, 0 (or less) allows no points. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<float> Densities;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 SizeX = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 SizeY = 0;
+
+	bool IsValid() const { return SizeX > 0 && SizeY > 0 && Densities.Num() == SizeX * SizeY; }
+
+	/** Bilinearly interpolated density at normalized coordinates in [0, 1]. */
+	double GetDensity(const double U, const double V) const;
+};
+
+/**
+* Settings of Poisson disk sampling (Bridson's algorithm on a background grid).
+*/
+USTRUCT(BlueprintType)
+struct FENIXSTOCHASTICUTILS_API FPoissonDiskSettings
+{
+	GENERATED_BODY()
+
+	/** Minimum distance between points (where the density is 1, or everywhere without density). */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	double MinDistance = 100.0;
+
+	/** Minimum distance between points where the density approaches 0. Only used with density. Neighbor search cost grows with (MaxDistance / MinDistance)^Dimension. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	double MaxDistance = 300.0;
+
+	/** Number of candidates tried around an active point before retiring it, and of failed tries for new seed points before finishing. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 MaxAttempts = 30;
+
+	/**
+	* Edge length of the tiles generated in parallel, 0 or less for no tiling. Enlarged to clear the largest distance if too small.
+	* Tiles are processed in 4 (2D) or 8 (3D) phases of non-adjacent tiles, each tile with its own stream derived from the seed, so the result does not depend on scheduling.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	double TileSize = 0.0;
+};
+
+/**
+ * Random position sampling: uniform on surfaces (triangle lists, static meshes, navmesh polygons), and Poisson disk in regions.
+ */
+UCLASS(meta = (BlueprintThreadSafe))
+class FENIXSTOCHASTICUTILS_API UPositionSamplerUtils : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+#pragma region Blueprint and C++ APIs
+	/**
+	* Cook a triangle list (3 indices per triangle into Vertices) for uniform surface sampling. Degenerated triangles are never sampled.
+	* Returns false if there is no triangle with positive area.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Fenix|PositionSamplerUtils|SamplingPreprocessing")
+	static bool CookSurfaceSamplerFromTriangles(const TArray<FVector>& Vertices, const TArray<int32>& Indices, FCookedSurfaceSampler& OutSampler);
+
+	/**
+	* Cook a LOD of a static mesh for uniform surface sampling, with vertices transformed (e.g. by the component transform).
+	* Outside of the editor, it requires the mesh to allow CPU access to keep its vertex and index data. Returns false if there is no data.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (AdvancedDisplay = 1), Category = "Fenix|PositionSamplerUtils|SamplingPreprocessing")
+	static bool CookSurfaceSamplerFromStaticMesh(const UStaticMesh* StaticMesh, FCookedSurfaceSampler& OutSampler, const FTransform& Transform, const int32 LODIndex = 0);
+
+	/**
+	* Cook the navmesh polygons of the default navigation data of the world for uniform sampling of navigable positions.
+	* Only the polygons with centers inside Bounds are taken if Bounds is valid. Requires a Recast navmesh. Returns false if there is no polygon.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (WorldContext = "WorldContextObject", NotBlueprintThreadSafe), Category = "Fenix|PositionSamplerUtils|SamplingPreprocessing")
+	static bool CookSurfaceSamplerFromNavMesh(const UObject* WorldContextObject, FCookedSurfaceSampler& OutSampler, const FBox& Bounds);
+
+	/** Cook the polygons of given navigation data (must be a Recast navmesh), see CookSurfaceSamplerFromNavMesh. */
+	static bool CookSurfaceSamplerFromNavData(const ANavigationData* NavData, FCookedSurfaceSampler& OutSampler, const FBox& Bounds);
+
+	/**
+	* Cook a SizeX by SizeY grid of densities (row major, negatives taken as 0) for importance sampling.
+	* Alias tables sample in O(1), cumulative tables in O(log SizeX + log SizeY) with cheaper partial updates. Returns false if the total density is not positive.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (AdvancedDisplay = 4), Category = "Fenix|PositionSamplerUtils|SamplingPreprocessing")
+	static bool CookDensityMapSampler(const TArray<float>& Densities, const int32 SizeX, const int32 SizeY, FCookedDensityMapSampler& OutSampler, const bool bUseAliasTables = false);
+
+	/**
+	* Cook a channel (0 to 3 for R, G, B, A) of the top mip of a texture for importance sampling, see CookDensityMapSampler.
+	* Requires an uncompressed format (e.g. Grayscale, HDR or VectorDisplacementmap compression settings) with its CPU data loaded. Returns false otherwise.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (AdvancedDisplay = 2), Category = "Fenix|PositionSamplerUtils|SamplingPreprocessing")
+	static bool CookDensityMapSamplerFromTexture(UTexture2D* Texture, FCookedDensityMapSampler& OutSampler, const int32 ChannelIndex = 0, const bool bUseAliasTables = false);
+
+	/**
+	* Replace the densities of a rectangle of texels (RegionSizeX by RegionSizeY, row major) starting at (MinX, MinY), e.g. a painted tile.
+	* Only the touched rows and the marginal table are rebuilt. Returns false (leaving the sampler untouched) if the rectangle is out of the map or the sizes mismatch.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Fenix|PositionSamplerUtils|SamplingPreprocessing")
+	static bool UpdateDensityMapSamplerRegion(UPARAM(ref) FCookedDensityMapSampler& Sampler, const int32 MinX, const int32 MinY, const int32 RegionSizeX, const int32 RegionSizeY, const TArray<float>& RegionDensities);
+
+	/**
+	* Poisson disk sampling in a 2D region: points at least MinDistance apart, in O(N) with a background grid (Bridson's algorithm).
+	* The density map (optional) covers the region and scales the spacing between MinDistance and MaxDistance.
+	* Reproducible with the same stream seed (the stream is not advanced).
+	*/
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "DensityMap"), Category = "Fenix|PositionSamplerUtils|PoissonDisk")
+	static void SamplePoissonDisk2D(const FBox2D& Region, const FPoissonDiskSettings& Settings, const FRandomStream& RandomStream, const FPoissonDiskDensityMap& DensityMap, TArray<FVector2D>& OutPoints);
+
+	/**
+	* Poisson disk sampling in a 3D region: points at least MinDistance apart, in O(N) with a background grid (Bridson's algorithm).
+	* The density map (optional) covers the XY extent of the region and scales the spacing between MinDistance and MaxDistance.
+	* Reproducible with the same stream seed (the stream is not advanced).
+	*/
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "DensityMap"), Category = "Fenix|PositionSamplerUtils|PoissonDisk")
+	static void SamplePoissonDisk3D(const FBox& Region, const FPoissonDiskSettings& Settings, const FRandomStream& RandomStream, const FPoissonDiskDensityMap& DensityMap, TArray<FVector>& OutPoints);
+#pragma endregion
+
+#pragma region Blueprint only APIs (for C++ direct usage better use ones in the later section)
+	/** Sample a uniformly distributed point on the surface, also outputting the normal of the triangle it is on. Returns false if the sampler is empty. Not thread safe. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Surface Point", NotBlueprintThreadSafe), Category = "Fenix|PositionSamplerUtils|Sampling")
+	static bool BPFunc_SampleSurfacePoint(const FCookedSurfaceSampler& Sampler, FVector& OutPoint, FVector& OutNormal);
+
+	/** Sample a uniformly distributed point on the surface with a random stream, also outputting the normal of the triangle it is on. Returns false if the sampler is empty. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Surface Point From Stream"), Category = "Fenix|PositionSamplerUtils|Sampling")
+	static bool BPFunc_SampleSurfacePointFromStream(const FCookedSurfaceSampler& Sampler, const FRandomStream& RandomStream, FVector& OutPoint, FVector& OutNormal);
+
+	/** Sample a batch of uniformly distributed points on the surface. Outputs nothing if the sampler is empty. Not thread safe. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Surface Points", NotBlueprintThreadSafe), Category = "Fenix|PositionSamplerUtils|Sampling")
+	static void BPFunc_SampleSurfacePoints(const FCookedSurfaceSampler& Sampler, const int32 NumPoints, TArray<FVector>& OutPoints);
+
+	/** Sample a batch of uniformly distributed points on the surface with a random stream. Outputs nothing if the sampler is empty. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Surface Points From Stream"), Category = "Fenix|PositionSamplerUtils|Sampling")
+	static void BPFunc_SampleSurfacePointsFromStream(const FCookedSurfaceSampler& Sampler, const int32 NumPoints, const FRandomStream& RandomStream, TArray<FVector>& OutPoints);
+
+	/** Sample a point in Region (X along the map columns, Y along the rows) by the density map. Returns false if the sampler is empty. Not thread safe. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Density Map", NotBlueprintThreadSafe), Category = "Fenix|PositionSamplerUtils|Sampling")
+	static bool BPFunc_SampleDensityMap(const FCookedDensityMapSampler& Sampler, const FBox2D& Region, FVector2D& OutPoint);
+
+	/** Sample a point in Region (X along the map columns, Y along the rows) by the density map with a random stream. Returns false if the sampler is empty. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Density Map From Stream"), Category = "Fenix|PositionSamplerUtils|Sampling")
+	static bool BPFunc_SampleDensityMapFromStream(const FCookedDensityMapSampler& Sampler, const FBox2D& Region, const FRandomStream& RandomStream, FVector2D& OutPoint);
+
+	/** Sample a batch of points in Region by the density map. Outputs nothing if the sampler is empty. Not thread safe. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Density Map Points", NotBlueprintThreadSafe), Category = "Fenix|PositionSamplerUtils|Sampling")
+	static void BPFunc_SampleDensityMapPoints(const FCookedDensityMapSampler& Sampler, const FBox2D& Region, const int32 NumPoints, TArray<FVector2D>& OutPoints);
+
+	/** Sample a batch of points in Region by the density map with a random stream. Outputs nothing if the sampler is empty. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Density Map Points From Stream"), Category = "Fenix|PositionSamplerUtils|Sampling")
+	static void BPFunc_SampleDensityMapPointsFromStream(const FCookedDensityMapSampler& Sampler, const FBox2D& Region, const int32 NumPoints, const FRandomStream& RandomStream, TArray<FVector2D>& OutPoints);
+#pragma endregion
+
+#pragma region C++ only APIs
+	/**
+	* Sample a uniformly distributed point on the surface, optionally outputting the normal of the triangle it is on. Returns false if the sampler is empty.
+	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	*/
+	static bool SampleSurfacePoint(const FCookedSurfaceSampler& Sampler, FVector& OutPoint, FVector* OutNormal = nullptr, const FRandomStream* RandomStream = nullptr);
+
+	/**
+	* Sample a batch of uniformly distributed points on the surface (appended to OutPoints). Appends nothing if the sampler is empty.
+	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	*/
+	static void SampleSurfacePoints(const FCookedSurfaceSampler& Sampler, const int32 NumPoints, TArray<FVector>& OutPoints, const FRandomStream* RandomStream = nullptr);
+
+	/**
+	* Sample normalized coordinates in [0, 1)^2 by the density map (U along the columns, V along the rows), jittered within the selected texel.
+	* Returns false if the sampler is empty. Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	*/
+	static bool SampleDensityMap(const FCookedDensityMapSampler& Sampler, FVector2D& OutUV, const FRandomStream* RandomStream = nullptr);
+
+	/**
+	* Sample a batch of points in Region by the density map (appended to OutPoints). Appends nothing if the sampler is empty.
+	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	*/
+	static void SampleDensityMapPoints(const FCookedDensityMapSampler& Sampler, const FBox2D& Region, const int32 NumPoints, TArray<FVector2D>& OutPoints, const FRandomStream* RandomStream = nullptr);
+
+	/**
+	* Poisson disk sampling in a box, in 2D (on the XY plane at Region.Min.Z) or 3D. Output points are ordered by tile.
+	* Density (optional) is in [0, 1] and scales the spacing between MinDistance and MaxDistance, 0 (or less) allows no points.
+	* Reproducible with the same seed (the current seed of the stream, which is not advanced).
+	*/
+	static void SamplePoissonDisk(const FBox& Region, const bool bIs2D, const FPoissonDiskSettings& Settings, const FRandomStream& RandomStream, TArray<FVector>& OutPoints, TFunction<double(const FVector&)> DensityFunction = nullptr);
+#pragma endregion
+
+private:
+	/** Shared by the cooking functions: fill the triangle vectors and areas of one triangle. */
+	static void AddTriangle(TArray<FVector>& TriangleVectors, TArray<double>& Areas, const FVector& A, const FVector& B, const FVector& C);
+
+	/** Shared by the cooking functions: cook the alias table over the areas. */
+	static bool FinishCooking(TArray<double>& Areas, FCookedSurfaceSampler& OutSampler);
+
+	/** Shared by the density map cooking and updates: rebuild the conditional table of a row from its densities. */
+	static void CookDensityMapRow(FCookedDensityMapSampler& Sampler, const int32 Row);
+
+	/** Shared by the density map cooking and updates: rebuild the marginal table from the row totals. */
+	static bool CookDensityMapMarginal(FCookedDensityMapSampler& Sampler);
+
+	/** Select a texel and jitter within it, the sampler must not be empty. */
+	static FORCEINLINE FVector2D SampleDensityMapUnchecked(const FCookedDensityMapSampler& Sampler, const FRandomStream* RandomStream)
+	{
+		int32 Row;
+		int32 Column;
+		if (Sampler.bUseAliasTables)
+		{
+			Row = USelectorUtils::SelectWithAliasTableUnchecked(Sampler.MarginalAliasTable, RandomStream);
+			Column = USelectorUtils::SelectWithAliasTableUnchecked(Sampler.RowAliasTables[Row], RandomStream);
+		}
+		else
+		{
+			// searching up to the last entry (excluded) clamps rolls at rounding edges to it
+			const double RowRoll = UCommonUtils::FRandMaybeWithStream(RandomStream) * Sampler.TotalDensity;
+			Row = UCommonUtils::BinarySearchForInsertionInSegment(RowRoll, Sampler.MarginalCumDensities, 0, Sampler.SizeY - 1);
+			const int32 RowStart = Row * Sampler.SizeX;
+			const double ColumnRoll = UCommonUtils::FRandMaybeWithStream(RandomStream) * Sampler.RowTotals[Row];
+			Column = UCommonUtils::BinarySearchForInsertionInSegment(ColumnRoll, Sampler.RowCumDensities, RowStart, RowStart + Sampler.SizeX - 1) - RowStart;
+		}
+		return FVector2D(
+			(Column + UCommonUtils::FRandMaybeWithStream(RandomStream)) / Sampler.SizeX,
+			(Row + UCommonUtils::FRandMaybeWithStream(RandomStream)) / Sampler.SizeY);
+	}
+
+	/** Uniform point in a triangle, folding the unit square onto the triangle. */
+	static FORCEINLINE FVector SampleInTriangle(const FVector& A, const FVector& AB, const FVector& AC, const FRandomStream* RandomStream)
+	{
+		double U = UCommonUtils::FRandMaybeWithStream(RandomStream);
+		double V = UCommonUtils::FRandMaybeWithStream(RandomStream);
+		if (U + V > 1.0)
+		{
+			U = 1.0 - U;
+			V = 1.0 - V;
+		}
+		return A + U * AB + V * AC;
+	}
+};
@@ -0,0 +1,74 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+* One selection recorded by the audit log.
+*/
+struct FENIXSTOCHASTICUTILS_API FSelectorAuditRecord
+{
+	/** Time of the selection, in platform cycles (converted to seconds by the reader). */
+	uint64 Timestamp = 0;
+
+	/** Content based identifier of the table selected from (see FSelectorAuditLog::MakeTableId). */
+	uint32 TableId = 0;
+
+	/** The selected index (-1 if nothing was selected). */
+	int32 SelectedIndex = INDEX_NONE;
+
+	/**
+	* Seed of the random stream before the roll, replaying the roll when set back into the stream.
+	* 0 if the global random number generator was used, whose state is not observable: such rolls cannot be replayed, use a stream where that matters.
+	*/
+	int32 StreamSeed = 0;
+
+	/** Id of the thread doing the selection. */
+	uint32 ThreadId = 0;
+};
+
+/**
+* Optional audit sink recording every selection made by the selector functions, e.g. for proving the published rates.
+* Selections are pushed into a per-thread lock-free ring buffer (single producer, single consumer),
+* and a background thread drains them into a compact binary file, in column-wise blocks compressed with Zlib.
+* When disabled the cost on the selection path is a single relaxed atomic load.
+* Use console command "Fenix.Selector.Audit.Start <File>" / "Fenix.Selector.Audit.Stop" to record,
+* and "Fenix.Selector.Audit.ExportCsv <File> <CsvFile>" to read a recorded file back.
+*/
+class FENIXSTOCHASTICUTILS_API FSelectorAuditLog
+{
+public:
+	/** Start recording into the file (overwritten if it exists). Returns false if already recording or the file cannot be opened. */
+	static bool Start(const FString& FilePath);
+
+	/** Stop recording, flushing everything recorded so far. */
+	static void Stop();
+
+	static FORCEINLINE bool IsEnabled()
+	{
+		return bEnabled.load(std::memory_order_relaxed);
+	}
+
+	/** The seed to record for a selection with the random stream, read before rolling. Only reads the stream when recording. 0 (not replayable) without a stream. */
+	static FORCEINLINE int32 GetStreamSeed(const FRandomStream* RandomStream)
+	{
+		return RandomStream && IsEnabled() ? RandomStream->GetCurrentSeed() : 0;
+	}
+
+	/** Record a selection made on the current thread. Never blocks unless the ring buffer of the thread is full. */
+	static void Record(const uint32 TableId, const int32 SelectedIndex, const int32 StreamSeed);
+
+	/** Content based identifier of a table of weights/probabilities (or their cumulatives). */
+	static uint32 MakeTableId(const TArray<double>& Values);
+
+	/** Read all the records of a file written by the audit log, in time order per block. Returns false if the file is invalid. */
+	static bool ReadFile(const FString& FilePath, TArray<FSelectorAuditRecord>& OutRecords);
+
+	/** Convert a file written by the audit log into CSV, with timestamps in UTC. */
+	static bool ExportCsv(const FString& FilePath, const FString& CsvFilePath);
+
+private:
+	static std::atomic<bool> bEnabled;
+};
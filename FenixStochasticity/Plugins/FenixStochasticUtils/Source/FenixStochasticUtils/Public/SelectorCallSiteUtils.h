@@ -0,0 +1,99 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+
+#include "SelectorCallSiteUtils.generated.h"
+
+/** Whether per-call-site attribution of selector nodes is compiled in. Disabled in shipping by default. */
+#ifndef FENIX_WITH_CALL_SITE_TRACKING
+#define FENIX_WITH_CALL_SITE_TRACKING !UE_BUILD_SHIPPING
+#endif
+
+#if FENIX_WITH_CALL_SITE_TRACKING
+#define FENIX_REPORT_CALL_SITE_INPUT_SIZE(Num) FSelectorCallSiteRegistry::ReportInputSize(Num)
+#else
+#define FENIX_REPORT_CALL_SITE_INPUT_SIZE(Num)
+#endif
+
+/**
+* Accumulated statistics of one Blueprint selector call site.
+*/
+struct FENIXSTOCHASTICUTILS_API FSelectorCallSiteStats
+{
+	/** Number of executions. */
+	uint64 NumCalls = 0;
+
+	/** Total time between begin and end of the call site, in cycles. */
+	uint64 TotalCycles = 0;
+
+	/** Sum of the input sizes (table sizes) seen by the selection or cooking functions. */
+	uint64 TotalInputSize = 0;
+
+	/** Largest input size seen. */
+	int32 MaxInputSize = 0;
+
+	/** Platform time in seconds of the first and the latest execution. */
+	double FirstCallTime = 0.0;
+	double LastCallTime = 0.0;
+
+	/** Calls per second over the tracked period. */
+	double GetCallsPerSecond() const;
+
+	/** Accumulate the stats of the same call site recorded elsewhere (e.g. on another thread). */
+	void Merge(const FSelectorCallSiteStats& Other);
+
+	/** Average input size multiplied by calls per second, i.e. the amount of table entries processed per second. */
+	double GetScore() const;
+};
+
+/**
+* Registry attributing selection cost to the Blueprint nodes (call sites) it comes from.
+* The Random Select and Cook Selector Input nodes wrap their expansion in Begin/End calls carrying a stable call site name,
+* and the selection/cooking functions report their input sizes to the call site active on the current thread.
+* Each thread accumulates into its own stats, guarded by a lock of its own that only dumping and resetting contend for,
+* so parallel selections do not serialize on the tracking; they are merged when read.
+* Use console command "Fenix.Selector.DumpCallSites [TopN]" to list the top offenders, "Fenix.Selector.ResetCallSites" to reset.
+*/
+class FENIXSTOCHASTICUTILS_API FSelectorCallSiteRegistry
+{
+public:
+	static FSelectorCallSiteRegistry& Get();
+
+	/** Start attributing work on the current thread to the call site. */
+	void BeginCallSite(const FName CallSite);
+
+	/** Stop attributing work on the current thread and record the execution. */
+	void EndCallSite();
+
+	/** Report the input size of the work done on the current thread, ignored if there is no active call site. */
+	static void ReportInputSize(const int32 InputSize);
+
+	/** Get a copy of all the stats, sorted by descending score. */
+	void GetSortedStats(TArray<TPair<FName, FSelectorCallSiteStats>>& OutStats) const;
+
+	void Reset();
+
+	/** Print the top call sites (all if TopN is not positive). */
+	void Dump(FOutputDevice& Ar, const int32 TopN) const;
+};
+
+/**
+* Blueprint entry points for the call site tracking, only meant to be spawned by custom nodes during expansion.
+*/
+UCLASS(meta = (BlueprintThreadSafe))
+class FENIXSTOCHASTICUTILS_API USelectorCallSiteUtils : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	/** Start attributing selection work to the call site. No-op when call site tracking is compiled out. */
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true"), Category = "Fenix|SelectorUtils|Profiling")
+	static void BeginSelectorCallSite(const FName CallSite);
+
+	/** Stop attributing selection work to the active call site. No-op when call site tracking is compiled out. */
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true"), Category = "Fenix|SelectorUtils|Profiling")
+	static void EndSelectorCallSite();
+};
@@ -0,0 +1,72 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "SelectorUtils.h"
+
+#include "SelectorNetPrediction.generated.h"
+
+/**
+* Counter based random state shared by the server and the clients: roll number Counter is made from (Seed, Counter) alone,
+* so a client holding the same state reproduces the server's rolls without replicating their results.
+* Net serialized as the raw seed and a packed counter, 5 to 9 bytes.
+*/
+USTRUCT(BlueprintType)
+struct FENIXSTOCHASTICUTILS_API FSelectorNetRandomState
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 Seed = 0;
+
+	/** Prediction key of the next roll. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 Counter = 0;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	/** The random stream of a roll, deterministic on every platform. */
+	FRandomStream MakeStream(const int32 PredictionKey) const;
+};
+
+template<>
+struct TStructOpsTypeTraits<FSelectorNetRandomState> : public TStructOpsTypeTraitsBase2<FSelectorNetRandomState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+/**
+* Client predicted selection: the server replicates a FSelectorNetRandomState once (or seeds both sides), then both call Select With Net Random State
+* in the same order, or a client predicts a given roll with its prediction key. Not for secrets: clients know every future roll.
+*/
+UCLASS(meta = (BlueprintThreadSafe))
+class FENIXSTOCHASTICUTILS_API USelectorNetPredictionUtils : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+#pragma region Blueprint and C++ APIs
+	/** Make a random state from a seed, the counter starting at zero. */
+	UFUNCTION(BlueprintPure, Category = "Fenix|SelectorNetPrediction")
+	static FSelectorNetRandomState MakeNetRandomState(const int32 Seed);
+
+	/**
+	* Select index with given CookedSelectorDistribution for the next roll of the state, negative returning value means failure.
+	* Advances the counter and outputs the prediction key of the roll. Threadsafe only when the state is not shared.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Fenix|SelectorNetPrediction|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 SelectWithNetRandomState(const FCookedSelectorDistribution& Distribution, UPARAM(ref) FSelectorNetRandomState& State, int32& OutPredictionKey);
+
+	/**
+	* Select index with given CookedSelectorDistribution for the roll of the prediction key, negative returning value means failure.
+	* Gives the same result as the server's Select With Net Random State for that key, whatever the current counter, and does not change the state.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Fenix|SelectorNetPrediction|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 PredictSelectionWithNetRandomState(const FCookedSelectorDistribution& Distribution, const FSelectorNetRandomState& State, const int32 PredictionKey);
+#pragma endregion
+};
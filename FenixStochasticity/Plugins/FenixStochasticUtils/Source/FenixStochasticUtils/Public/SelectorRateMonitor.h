@@ -0,0 +1,112 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "SelectorUtils.h"
+#include <atomic>
+
+/** Goodness-of-fit test used by the rate monitor. */
+enum class ESelectorRateTest : uint8
+{
+	ChiSquare,
+	GTest,
+};
+
+/**
+* Result of one goodness-of-fit test of the observed outcomes against the cooked distribution.
+*/
+struct FENIXSTOCHASTICUTILS_API FSelectorRateTestResult
+{
+	/** Chi-square or G statistic. */
+	double Statistic = 0.0;
+
+	/** Probability of a statistic at least this large if the outcomes did follow the distribution. Zero if an impossible outcome was observed. */
+	double PValue = 1.0;
+
+	int32 DegreesOfFreedom = 0;
+
+	/** Number of selections in the tested window. */
+	uint64 NumSamples = 0;
+
+	/** The outcome contributing the most to the statistic (-1 for "nothing selected" with probabilities summing below 1). */
+	int32 WorstIndex = INDEX_NONE;
+
+	/** Observed and expected frequencies of the worst outcome within the window. */
+	double ObservedFrequency = 0.0;
+	double ExpectedFrequency = 0.0;
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnSelectorRateDrift, const FSelectorRateTestResult&);
+
+/**
+* Streaming monitor raising an alarm when the outcomes selected from a cooked distribution drift from it (e.g. after a bad config push).
+* Recording a selection is O(1): an increment of a relaxed atomic counter in the shard of the calling thread, so any thread can record.
+* Every CheckInterval seconds the core ticker launches a test on a worker thread over the selections since the last tested window,
+* once it has at least MinSamples of them. When the p-value falls below the significance level, OnDriftDetected is broadcast on the game thread.
+* The monitored distribution is fixed; create a new monitor for a re-cooked distribution.
+*/
+class FENIXSTOCHASTICUTILS_API FSelectorRateMonitor : public TSharedFromThis<FSelectorRateMonitor, ESPMode::ThreadSafe>
+{
+public:
+	static TSharedRef<FSelectorRateMonitor, ESPMode::ThreadSafe> Create(const FCookedSelectorDistribution& InDistribution,
+		const double InSignificanceLevel = 1e-6, const float InCheckInterval = 10.0f, const uint64 InMinSamples = 1000, const ESelectorRateTest InTest = ESelectorRateTest::GTest);
+
+	~FSelectorRateMonitor();
+
+	/** Record a selected index (-1 for nothing selected). Thread safe. */
+	void RecordSelection(const int32 SelectedIndex);
+
+	/** Select with the monitored distribution and record the outcome. */
+	int32 Select(const FRandomStream* RandomStream = nullptr);
+
+	/** Run the test synchronously on the current window (counts are not consumed). */
+	FSelectorRateTestResult RunTestNow() const;
+
+	/** Start a new window from the current counts. */
+	void ResetWindow();
+
+	const FCookedSelectorDistribution& GetDistribution() const { return Distribution; }
+
+	/** Broadcast on the game thread when the drift is significant. */
+	FOnSelectorRateDrift OnDriftDetected;
+
+	/** Regularized upper incomplete gamma function Q(A, X), the survival function of the chi-square distribution being Q(K / 2, X / 2). */
+	static double RegularizedUpperGamma(const double A, const double X);
+
+private:
+	FSelectorRateMonitor(const FCookedSelectorDistribution& InDistribution, const double InSignificanceLevel, const float InCheckInterval, const uint64 InMinSamples, const ESelectorRateTest InTest);
+
+	bool OnTick(float DeltaTime);
+
+	/** Sum the counts of all the shards. */
+	void SnapshotCounts(TArray<uint64>& OutCounts) const;
+
+	/** Test the counts of the window against the expected probabilities. */
+	FSelectorRateTestResult RunTest(const TArray<uint64>& WindowCounts) const;
+
+	static constexpr int32 NumShards = 8;
+
+	FCookedSelectorDistribution Distribution;
+
+	/** Expected probability of each index, plus one last entry for nothing selected. */
+	TArray<double> ExpectedProbs;
+
+	double SignificanceLevel;
+	float CheckInterval;
+	uint64 MinSamples;
+	ESelectorRateTest Test;
+
+	/** Counters of each shard, every shard padded to whole cache lines. Same layout as ExpectedProbs within a shard. */
+	TUniquePtr<std::atomic<uint64>[]> ShardCounts;
+	int32 ShardStride = 0;
+
+	/** Counts at the start of the current window. Only touched by the worker running the test (or ResetWindow). */
+	TArray<uint64> WindowStartCounts;
+	mutable FCriticalSection WindowLock;
+
+	std::atomic<bool> bTestInFlight{false};
+
+	FTSTicker::FDelegateHandle TickerHandle;
+};
@@ -0,0 +1,66 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SelectorUtils.h"
+#include "SharedCookedDistribution.h"
+#include <atomic>
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnSelectorRatesReloaded, bool /* bSucceeded */, const FString& /* Error */);
+
+/**
+* Reloads drop rates at runtime from a CSV or JSON file (e.g. downloaded by live-ops) into shared cooked distributions, without hitching the game thread:
+* the file is read, parsed in a single pass and cooked on a background task, then the tables are published one after another, readers never waiting
+* (see FSharedCookedDistribution). Either all the tables of a file are published or none, so a broken file leaves the previous rates in use.
+* Each table swaps atomically, but not all of them together: during a reload, rolls on several tables may see some at the old rates and some at the new.
+*
+* CSV: a header row naming the columns, "WeightOrProb" required, "IsProb" and "Table" optional, others (e.g. row names) ignored.
+* Quoted fields are supported; a quote left open rejects the file.
+* JSON: an object of table names to arrays of entries, or a single array for the default table. An entry is either {"WeightOrProb": 5, "IsProb": false} or a plain number (a weight).
+* Rows without a table go to DefaultTableName. Tables not registered are ignored, registered tables absent from the file are left as is.
+*/
+class FENIXSTOCHASTICUTILS_API FSelectorRateReloader : public TSharedFromThis<FSelectorRateReloader, ESPMode::ThreadSafe>
+{
+public:
+	static TSharedRef<FSelectorRateReloader, ESPMode::ThreadSafe> Create();
+
+	/** Table of the rows that do not name one. */
+	static const FName DefaultTableName;
+
+	/** Publish the rates of TableName in the file to Table. Thread safe. */
+	void RegisterTable(const FName TableName, const TSharedRef<FSharedCookedDistribution, ESPMode::ThreadSafe>& Table);
+
+	void UnregisterTable(const FName TableName);
+
+	/**
+	* Start reloading from a .csv or .json file on a background task. Returns false if a reload is already in flight.
+	* OnReloaded is broadcast on the game thread when done.
+	*/
+	bool ReloadFromFile(const FString& FilePath);
+
+	bool IsReloading() const { return bReloading.load(); }
+
+	/** Number of successful reloads. */
+	uint32 GetNumReloads() const { return NumReloads.load(); }
+
+	/** Broadcast on the game thread after each reload. */
+	FOnSelectorRatesReloaded OnReloaded;
+
+	/** Parse a rate file (by its extension) into the entries of each table. Thread safe. */
+	static bool ParseRateFile(const FString& FilePath, TMap<FName, TArray<FWeightOrProbEntry>>& OutTableEntries, FString& OutError);
+	static bool ParseRatesCsv(const FString& Text, TMap<FName, TArray<FWeightOrProbEntry>>& OutTableEntries, FString& OutError);
+	static bool ParseRatesJson(const FString& Text, TMap<FName, TArray<FWeightOrProbEntry>>& OutTableEntries, FString& OutError);
+
+private:
+	FSelectorRateReloader() = default;
+
+	/** Parse, cook and publish. Runs on the background task. */
+	bool RunReload(const FString& FilePath, FString& OutError);
+
+	TMap<FName, TSharedRef<FSharedCookedDistribution, ESPMode::ThreadSafe>> Tables;
+	mutable FCriticalSection TablesLock;
+
+	std::atomic<bool> bReloading{false};
+	std::atomic<uint32> NumReloads{0};
+};
@@ -0,0 +1,88 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "SelectorUtils.h"
+#include "SelectorNetPrediction.h"
+#include "ShuffleBagUtils.h"
+
+#include "SelectorSaveUtils.generated.h"
+
+/**
+* Persistent selector state of one owner (e.g. a player): a random stream, a net random state, a shuffle bag, dynamic weights and pity counters.
+* Fields left at their defaults cost nothing in the encoded bytes.
+*/
+USTRUCT(BlueprintType)
+struct FENIXSTOCHASTICUTILS_API FSelectorSaveState
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FRandomStream Stream;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FSelectorNetRandomState NetRandomState;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FSelectorShuffleBagSnapshot ShuffleBag;
+
+	/** Dynamic weights or probabilities, as cooked. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FCookedSelectorDistribution Distribution;
+
+	/** Game defined counters, e.g. pulls since the last rare per banner. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<int64> PityCounters;
+};
+
+/** Serialize as the encoded bytes prefixed by their packed size. Sets the archive error when loading invalid bytes. */
+FENIXSTOCHASTICUTILS_API FArchive& operator<<(FArchive& Ar, FSelectorSaveState& State);
+
+/**
+* Compact versioned binary encoding of selector save states: a version and a mask of the non-default fields, then the fields with
+* counts and counters as varints (zigzag for signed ones), seeds as 4 raw bytes and weights as 8 raw bytes.
+* Bag remaining counts are stored as cards drawn, mostly zero or small. Decoding never allocates more than the bytes can hold.
+*/
+UCLASS(meta = (BlueprintThreadSafe))
+class FENIXSTOCHASTICUTILS_API USelectorSaveUtils : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	/** Current version of the encoding. Older versions are decoded, newer ones are rejected. */
+	static constexpr uint32 SaveVersion = 2;  // 2: guide table bucket count of the distribution
+
+#pragma region Blueprint and C++ APIs
+	/** Encode a save state into bytes. */
+	UFUNCTION(BlueprintCallable, Category = "Fenix|SelectorSaveUtils")
+	static void EncodeSelectorSaveState(const FSelectorSaveState& State, TArray<uint8>& OutBytes);
+#pragma endregion
+
+#pragma region Blueprint only APIs (for C++ direct usage better use ones in the later section)
+	/** Decode a save state from bytes. Returns false (with a default state) if the bytes are invalid or from a newer version. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Decode Selector Save State"), Category = "Fenix|SelectorSaveUtils")
+	static bool BPFunc_DecodeSelectorSaveState(const TArray<uint8>& Bytes, FSelectorSaveState& OutState);
+#pragma endregion
+
+#pragma region C++ only APIs
+	/** Append the encoded bytes of a save state. */
+	static void AppendEncodedSelectorSaveState(const FSelectorSaveState& State, TArray<uint8>& OutBytes);
+
+	/** Decode a save state from bytes. Returns false (with a default state) if the bytes are invalid or from a newer version. */
+	static bool DecodeSelectorSaveState(TArrayView<const uint8> Bytes, FSelectorSaveState& OutState);
+
+	/**
+	* Encode save states back to back for the backend, OutOffsets getting the start of each state plus the end of the last one.
+	* Large batches are encoded in parallel.
+	*/
+	static void EncodeSelectorSaveStates(TArrayView<const FSelectorSaveState> States, TArray<uint8>& OutBytes, TArray<int32>& OutOffsets);
+
+	/**
+	* Decode save states encoded back to back, Offsets as output by EncodeSelectorSaveStates. Large batches are decoded in parallel.
+	* Invalid states are left default. Returns the number of invalid states (all of them if the offsets are invalid).
+	*/
+	static int32 DecodeSelectorSaveStates(TArrayView<const uint8> Bytes, TArrayView<const int32> Offsets, TArray<FSelectorSaveState>& OutStates);
+#pragma endregion
+};
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Engine/Classes/Engine/DataTable.h"
+#include "CommonUtils.h"
 
 #include "SelectorUtils.generated.h"
 
@@ -50,13 +51,260 @@ struct FENIXSTOCHASTICUTILS_API FCookedSelectorDistribution
 {
 	GENERATED_BODY()
 
-	/** Weight or probability array. */
+	/** Weight or probability array. Edits outside of cooking leave TableId and GuideTable stale: the guide table is then ignored, re-cook to refresh both. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	TArray<double> CumWeightsOrCumProbs = { 1.0 };
 
 	/** Whether it records probabilities (as opposed to weights). */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	bool bIsProbs = false;
+
+	/** Content based identifier of the table, computed when cooking (zero if not cooked). Used for identifying the table in the selection audit log. */
+	UPROPERTY(VisibleAnywhere, AdvancedDisplay)
+	int32 TableId = 0;
+
+	/**
+	* Optional guide table (Chen and Asau) for expected O(1) search: the roll range is split into equal buckets, each holding the number of cumulatives
+	* in the buckets before it, so a selection jumps to its bucket and scans forward. Empty if not built. Needs rebuilding when the cumulatives change,
+	* and ignored by selection when the entry count or roll range it was built for no longer match.
+	*/
+	UPROPERTY(VisibleAnywhere, AdvancedDisplay)
+	TArray<int32> GuideTable;
+
+	/** Number of cumulatives the guide table was built for. */
+	UPROPERTY(VisibleAnywhere, AdvancedDisplay)
+	int32 GuideNumCums = 0;
+
+	/** Roll range (total weight, or 1.0 for probabilities) the guide table was built for. */
+	UPROPERTY(VisibleAnywhere, AdvancedDisplay)
+	double GuideRollRange = 0.0;
+};
+
+/**
+* An alias table (Walker/Vose) for O(1) selection: roll a column uniformly, then keep it with its threshold probability or take its alias.
+* Columns beyond NumEntries represent the "nothing selected" probability mass (probabilities adding up to less than 1.0).
+*/
+USTRUCT(BlueprintType)
+struct FENIXSTOCHASTICUTILS_API FCookedAliasTable
+{
+	GENERATED_BODY()
+
+	/** Probability of keeping each column (as opposed to taking its alias). */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TArray<double> Thresholds;
+
+	/** Alias of each column. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TArray<int32> Aliases;
+
+	/** Number of selectable entries. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 NumEntries = 0;
+
+	/** Content based identifier of the table, computed when cooking. Used for identifying the table in the selection audit log. */
+	UPROPERTY(VisibleAnywhere, AdvancedDisplay)
+	int32 TableId = 0;
+};
+
+/**
+* A distribution cooked into integer thresholds compared directly against a raw random word, without converting it to a floating point roll.
+* Threshold i is round(Cum_i / Total * 2^32) and entry i is selected when Threshold_(i-1) <= R < Threshold_i for a uniform 32 bit R.
+* Quantization error: each selection probability is off by at most 2^-32, so an entry of probability P is off by a relative 2^-32 / P at most.
+* When that would exceed the allowed error for some positive entry, 64 bit thresholds against a 64 bit word are used instead,
+* off by at most 2^-52 (the precision of the cooked doubles).
+*/
+USTRUCT(BlueprintType)
+struct FENIXSTOCHASTICUTILS_API FCookedQuantizedDistribution
+{
+	GENERATED_BODY()
+
+	/** Thresholds of the entries before the first one reaching the total (all of them if the probabilities sum below 1), when using 32 bit thresholds. */
+	UPROPERTY()
+	TArray<uint32> Thresholds32;
+
+	/** Same as Thresholds32, when using 64 bit thresholds. */
+	UPROPERTY()
+	TArray<uint64> Thresholds64;
+
+	/** Whether the thresholds reach the total, the last rolls selecting the entry after the stored thresholds. Otherwise those rolls count as failure. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	bool bCoversAll = false;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	bool bUses64BitThresholds = false;
+
+	/** Bound of the relative error of the smallest positive entry. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	double RelativeErrorBound = 0.0;
+
+	/** Content based identifier of the table, taken from the cooked distribution. Used for identifying the table in the selection audit log. */
+	UPROPERTY(VisibleAnywhere, AdvancedDisplay)
+	int32 TableId = 0;
+};
+
+/**
+* A two-level selector: a category (e.g. a rarity tier) is selected first, then an item within it.
+* The category weights can be scaled per call (e.g. by a luck stat or an event boost) without re-cooking the items:
+* a selection costs O(categories) for the boosted category roll plus O(log items) within the category.
+* With all multipliers at 1.0 it selects with the same probabilities as the flat item weights.
+*/
+USTRUCT(BlueprintType)
+struct FENIXSTOCHASTICUTILS_API FCookedCategorySelector
+{
+	GENERATED_BODY()
+
+	/** Category ids of kept items must be below this, so a stray id cannot allocate huge arrays. */
+	static constexpr int32 MaxCategories = 1 << 16;
+
+	/** Category multipliers are clamped to at most this (NaN being 0.0), keeping the boosted weights finite. */
+	static constexpr double MaxCategoryMultiplier = 1.0e9;
+
+	/** Cumulative weights of the items with positive weight, grouped by category, restarting from zero in each category. */
+	UPROPERTY()
+	TArray<double> ItemCumWeights;
+
+	/** Original index of each item in ItemCumWeights. */
+	UPROPERTY()
+	TArray<int32> ItemIndices;
+
+	/** Start of each category in the items, plus the end of the last one. */
+	UPROPERTY()
+	TArray<int32> CategoryStarts;
+
+	/** Base weight of each category, the total of its items. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TArray<double> CategoryWeights;
+
+	/** Content based identifier of the table, computed when cooking. Used for identifying the table in the selection audit log. */
+	UPROPERTY(VisibleAnywhere, AdvancedDisplay)
+	int32 TableId = 0;
+};
+
+/**
+* A cooked distribution with the zero (and negative) entries dropped, for generated tables with many placeholder rows.
+* The cumulatives of the kept entries are normalized by the roll range, so a uniform roll in [0, 1) is compared directly,
+* and every count of cumulatives not above the roll lands on a positive entry: no trailing zero walk and no per call total checks.
+*/
+USTRUCT(BlueprintType)
+struct FENIXSTOCHASTICUTILS_API FCookedCompactDistribution
+{
+	GENERATED_BODY()
+
+	/** Normalized cumulatives of the kept entries, the last being exactly 1.0 unless probabilities sum below 1 (rolls beyond counting as failure). */
+	UPROPERTY()
+	TArray<double> NormalizedCums;
+
+	/** Index in the original entries of each kept entry. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TArray<int32> OriginalIndices;
+
+	/** Original index selected when the roll is not below the last cumulative (the global roll can be exactly 1.0): the last kept entry if they cover all the rolls, or -1 for failure. */
+	UPROPERTY()
+	int32 IndexBeyondLast = INDEX_NONE;
+
+	/** Total weight or probability of the kept entries. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	double Total = 0.0;
+
+	/** Inverse of Total (zero if Total is zero), e.g. for turning an entry's mass into its probability. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	double InvTotal = 0.0;
+
+	/** Whether it records probabilities (as opposed to weights). */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	bool bIsProbs = false;
+
+	/** Content based identifier of the table, taken from the cooked distribution. Used for identifying the table in the selection audit log. */
+	UPROPERTY(VisibleAnywhere, AdvancedDisplay)
+	int32 TableId = 0;
+};
+
+/**
+* A search tree over the cumulative boundaries split by probability mass rather than by count (Mehlhorn's bisection rule), for heavily skewed distributions:
+* each node splits its roll range at the boundary closest to the middle of its mass, so an entry of probability P sits at depth about -log2(P).
+* Expected comparisons are at most the entropy of the distribution plus 2, instead of log2 of the number of entries.
+* Selects exactly the same as the cumulative selection for the same roll.
+*/
+USTRUCT(BlueprintType)
+struct FENIXSTOCHASTICUTILS_API FCookedWeightedSearchTree
+{
+	GENERATED_BODY()
+
+	/** Boundary of each node: rolls below it go to the first child, the others to the second. */
+	UPROPERTY()
+	TArray<double> Splits;
+
+	/** Two children per node: a node index if non-negative, otherwise leaf -1 - EntryIndex (NumEntries standing for failure). */
+	UPROPERTY()
+	TArray<int32> Children;
+
+	/** Root, encoded the same as the children. */
+	UPROPERTY()
+	int32 Root = -1;
+
+	/** Scale of the roll: the total weight, or 1.0 for probabilities. Zero if nothing can be selected. */
+	UPROPERTY()
+	double RollScale = 0.0;
+
+	/** Number of selectable entries. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 NumEntries = 0;
+
+	/** Expected number of comparisons per selection, to compare against log2 of the number of entries. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	double ExpectedComparisons = 0.0;
+
+	/** Content based identifier of the table, taken from the cooked distribution. Used for identifying the table in the selection audit log. */
+	UPROPERTY(VisibleAnywhere, AdvancedDisplay)
+	int32 TableId = 0;
+};
+
+/**
+* A cooked distribution of at most MaxEntries entries stored inline (no heap allocation), for the many tables with only a few entries.
+* Selected by a branchless compare-and-count over all the slots with a fixed trip count, which the compiler unrolls and vectorizes.
+* Unused slots hold the largest double so they are never counted, and no trailing zero walk is needed.
+* Made by Cook Small Selector Distribution, or by the Cook Selector Input node with Cook Small enabled. A plain CookedSelectorDistribution keeps its heap array,
+* and its selection only switches to the same count over the array on small tables.
+*/
+USTRUCT(BlueprintType)
+struct FENIXSTOCHASTICUTILS_API FCookedSmallSelectorDistribution
+{
+	GENERATED_BODY()
+
+	static constexpr int32 MaxEntries = 16;
+
+	/** Cumulative weights or probabilities (probabilities capped at 1.0), then padding. */
+	UPROPERTY(VisibleAnywhere)
+	double CumWeightsOrCumProbs[16];
+
+	/** Scale of the roll: the total weight, or 1.0 for probabilities. Zero if nothing can be selected. */
+	UPROPERTY()
+	double RollScale = 0.0;
+
+	/** Index selected when the roll is not below the last cumulative (e.g. rolling the total weight exactly): the last entry with positive mass, or -1 for failure. */
+	UPROPERTY()
+	int32 IndexBeyondLast = INDEX_NONE;
+
+	/** Number of entries. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 NumEntries = 0;
+
+	/** Whether it records probabilities (as opposed to weights). */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	bool bIsProbs = false;
+
+	/** Content based identifier of the table, taken from the cooked distribution. Used for identifying the table in the selection audit log. */
+	UPROPERTY(VisibleAnywhere, AdvancedDisplay)
+	int32 TableId = 0;
+
+	FCookedSmallSelectorDistribution()
+	{
+		static_assert(UE_ARRAY_COUNT(CumWeightsOrCumProbs) == MaxEntries, "Slot count must match MaxEntries.");
+		for (double& Cum : CumWeightsOrCumProbs)
+		{
+			Cum = TNumericLimits<double>::Max();
+		}
+	}
 };
 
 /**
@@ -92,9 +340,69 @@ public:
 	* Probabilities entries get their portion first then the remaining probabilities (if any) are considered for weight entries.
 	* The result is represented as probabilities if there are no weight entries or the total from probability entries adds up to no less than 1.0, otherwise reprenented as weights.
 	* Best used on cases where the WeightOrProbEntry's do not change. Needs remake when they get changed.
+	* Parameter NumGuideBuckets builds a guide table of that many buckets (see Build Guide Table) if positive.
 	*/
+	UFUNCTION(BlueprintCallable, meta = (AdvancedDisplay = 2), Category = "Fenix|SelectorUtils|SelectionPreprocessing")
+	static void CookSelectorDistribution(const TArray<FWeightOrProbEntry>& Entries, FCookedSelectorDistribution& OutDistribution, const int32 NumGuideBuckets = 0);
+
+	/**
+	* Build the guide table of a CookedSelectorDistribution, for expected O(1) selection while keeping the cumulative form (e.g. for prefix statistics).
+	* With as many buckets as entries, a selection scans about one cumulative after the bucket jump. Zero buckets removes the guide table.
+	* Tables of up to 16 entries are scanned directly and get no guide table.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Fenix|SelectorUtils|SelectionPreprocessing")
+	static void BuildGuideTable(UPARAM(ref) FCookedSelectorDistribution& Distribution, const int32 NumBuckets);
+
+	/**
+	* Make an alias table from weights (negative ones regarded as zeros), for O(1) selection regardless of the number of entries.
+	* Best used on cases where the weights do not change, since cooking is O(N).
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Fenix|SelectorUtils|SelectionPreprocessing")
+	static void CookAliasTable(const TArray<double>& Weights, FCookedAliasTable& OutAliasTable);
+
+	/** Make an alias table from a CookedSelectorDistribution, selecting the same as the distribution does (including failures of probabilities adding up to less than 1.0). */
 	UFUNCTION(BlueprintCallable, Category = "Fenix|SelectorUtils|SelectionPreprocessing")
-	static void CookSelectorDistribution(const TArray<FWeightOrProbEntry>& Entries, FCookedSelectorDistribution& OutDistribution);
+	static void CookAliasTableFromDistribution(const FCookedSelectorDistribution& Distribution, FCookedAliasTable& OutAliasTable);
+
+	/**
+	* Make a quantized distribution from a CookedSelectorDistribution, selecting the same up to the quantization error (see FCookedQuantizedDistribution).
+	* Uses 32 bit thresholds (half the memory of the cumulatives) unless the relative error of some positive entry would exceed MaxRelativeError.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (AdvancedDisplay = 2), Category = "Fenix|SelectorUtils|SelectionPreprocessing")
+	static void CookQuantizedDistribution(const FCookedSelectorDistribution& Distribution, FCookedQuantizedDistribution& OutDistribution, const double MaxRelativeError = 1e-4);
+
+	/**
+	* Compute the cumulation of integer tickets (integer weights, negative ones regarded as zeros), for exact selection with Select With Cum Tickets.
+	* The total is clamped at the largest int64 in the unlikely case of overflowing.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Fenix|SelectorUtils|SelectionPreprocessing")
+	static void MakeCumulativeTickets(const TArray<int64>& Tickets, TArray<int64>& OutCumTickets);
+
+	/**
+	* Make a small distribution with inline storage from a CookedSelectorDistribution of at most 16 entries, selecting with the same probabilities.
+	* Returns false (with an empty output) if there are more entries.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Fenix|SelectorUtils|SelectionPreprocessing")
+	static UPARAM(DisplayName = "Fits") bool CookSmallSelectorDistribution(const FCookedSelectorDistribution& Distribution, FCookedSmallSelectorDistribution& OutDistribution);
+
+	/**
+	* Make a weighted search tree from a CookedSelectorDistribution, for distributions where a few entries hold most of the mass (see FCookedWeightedSearchTree).
+	* Cooking is O(N log N).
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Fenix|SelectorUtils|SelectionPreprocessing")
+	static void CookWeightedSearchTree(const FCookedSelectorDistribution& Distribution, FCookedWeightedSearchTree& OutTree);
+
+	/** Make a compact distribution from a CookedSelectorDistribution, dropping the entries without positive mass and remapping the selection to the original indices. */
+	UFUNCTION(BlueprintCallable, Category = "Fenix|SelectorUtils|SelectionPreprocessing")
+	static void CookCompactDistribution(const FCookedSelectorDistribution& Distribution, FCookedCompactDistribution& OutDistribution);
+
+	/**
+	* Make a two-level category selector from item weights and the category of each item (categories numbered from 0, negative ones dropping the item).
+	* Items with non-positive weights are dropped, so they are never selected.
+	* Returns false, leaving OutSelector empty, if the arrays differ in length or a kept item's category is not below FCookedCategorySelector::MaxCategories.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Fenix|SelectorUtils|SelectionPreprocessing")
+	static bool CookCategorySelector(const TArray<double>& ItemWeights, const TArray<int32>& ItemCategories, FCookedCategorySelector& OutSelector);
 
 	/** Get an array of FWeightOrProbEntry's from a data table. */
 	UFUNCTION(BlueprintCallable, Category = "Fenix|SelectorUtils|DataTable")
@@ -193,6 +501,221 @@ public:
 	*/
 	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Select With WeightOrProbEntries From Stream"), Category = "Fenix|SelectorUtils|Selection")
 	static UPARAM(DisplayName = "OutIndex") int32 BPFunc_SelectWithWeightOrProbEntriesFromStream(const TArray<FWeightOrProbEntry>& Entries, const FRandomStream& RandomStream);
+
+	/** Select index with given alias table in O(1), negative returning value means failure. Not thread safe. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Select With Alias Table", NotBlueprintThreadSafe), Category = "Fenix|SelectorUtils|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 BPFunc_SelectWithAliasTable(const FCookedAliasTable& AliasTable);
+
+	/** Select index with given alias table and a random stream in O(1), negative returning value means failure. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Select With Alias Table From Stream"), Category = "Fenix|SelectorUtils|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 BPFunc_SelectWithAliasTableFromStream(const FCookedAliasTable& AliasTable, const FRandomStream& RandomStream);
+
+	/** Select index with given quantized distribution, negative returning value means failure. Not thread safe. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Select With Quantized Distribution", NotBlueprintThreadSafe), Category = "Fenix|SelectorUtils|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 BPFunc_SelectWithQuantizedDistribution(const FCookedQuantizedDistribution& Distribution);
+
+	/** Select index with given quantized distribution and a random stream, negative returning value means failure. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Select With Quantized Distribution From Stream"), Category = "Fenix|SelectorUtils|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 BPFunc_SelectWithQuantizedDistributionFromStream(const FCookedQuantizedDistribution& Distribution, const FRandomStream& RandomStream);
+
+	/** Select index with given small distribution, negative returning value means failure. Not thread safe. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Select With Small Distribution", NotBlueprintThreadSafe), Category = "Fenix|SelectorUtils|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 BPFunc_SelectWithSmallDistribution(const FCookedSmallSelectorDistribution& Distribution);
+
+	/** Select index with given small distribution and a random stream, negative returning value means failure. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Select With Small Distribution From Stream"), Category = "Fenix|SelectorUtils|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 BPFunc_SelectWithSmallDistributionFromStream(const FCookedSmallSelectorDistribution& Distribution, const FRandomStream& RandomStream);
+
+	/** Select index with given weighted search tree, negative returning value means failure. Not thread safe. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Select With Weighted Search Tree", NotBlueprintThreadSafe), Category = "Fenix|SelectorUtils|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 BPFunc_SelectWithWeightedSearchTree(const FCookedWeightedSearchTree& Tree);
+
+	/** Select index with given weighted search tree and a random stream, negative returning value means failure. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Select With Weighted Search Tree From Stream"), Category = "Fenix|SelectorUtils|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 BPFunc_SelectWithWeightedSearchTreeFromStream(const FCookedWeightedSearchTree& Tree, const FRandomStream& RandomStream);
+
+	/**
+	* Select item index with given category selector, each category's weight scaled by its multiplier (missing ones being 1.0, negative ones 0.0, capped at 1e9).
+	* Negative returning value means failure. Not thread safe.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Select With Category Selector", NotBlueprintThreadSafe), Category = "Fenix|SelectorUtils|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 BPFunc_SelectWithCategorySelector(const FCookedCategorySelector& Selector, const TArray<double>& CategoryMultipliers, int32& OutCategoryIndex);
+
+	/**
+	* Select item index with given category selector and a random stream, each category's weight scaled by its multiplier (missing ones being 1.0, negative ones 0.0, capped at 1e9).
+	* Negative returning value means failure.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Select With Category Selector From Stream"), Category = "Fenix|SelectorUtils|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 BPFunc_SelectWithCategorySelectorFromStream(const FCookedCategorySelector& Selector, const TArray<double>& CategoryMultipliers, const FRandomStream& RandomStream, int32& OutCategoryIndex);
+
+	/** Select index (in the original entries) with given compact distribution, negative returning value means failure. Not thread safe. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Select With Compact Distribution", NotBlueprintThreadSafe), Category = "Fenix|SelectorUtils|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 BPFunc_SelectWithCompactDistribution(const FCookedCompactDistribution& Distribution);
+
+	/** Select index (in the original entries) with given compact distribution and a random stream, negative returning value means failure. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Select With Compact Distribution From Stream"), Category = "Fenix|SelectorUtils|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 BPFunc_SelectWithCompactDistributionFromStream(const FCookedCompactDistribution& Distribution, const FRandomStream& RandomStream);
+
+	/**
+	* Select index with given cumulative tickets (integer weights), negative returning value means failure. Each index is selected with exactly its share of the tickets. Not thread safe.
+	* Require input non-negative and non-decreasing.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Select With Cum Tickets", NotBlueprintThreadSafe), Category = "Fenix|SelectorUtils|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 BPFunc_SelectWithCumTickets(const TArray<int64>& CumTickets);
+
+	/**
+	* Select index with given cumulative tickets (integer weights) and a random stream, negative returning value means failure.
+	* Each index is selected with exactly its share of the tickets, and the result for a given stream is the same on every platform.
+	* Require input non-negative and non-decreasing.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Select With Cum Tickets From Stream"), Category = "Fenix|SelectorUtils|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 BPFunc_SelectWithCumTicketsFromStream(const TArray<int64>& CumTickets, const FRandomStream& RandomStream);
+
+	/** Select index with given tickets (integer weights, negative ones regarded as zeros), negative returning value means failure. Not thread safe. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Select With Tickets", NotBlueprintThreadSafe), Category = "Fenix|SelectorUtils|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 BPFunc_SelectWithTickets(const TArray<int64>& Tickets);
+
+	/** Select index with given tickets (integer weights, negative ones regarded as zeros) and a random stream, negative returning value means failure. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Select With Tickets From Stream"), Category = "Fenix|SelectorUtils|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 BPFunc_SelectWithTicketsFromStream(const TArray<int64>& Tickets, const FRandomStream& RandomStream);
+
+	/**
+	* Sample how many times each index is selected in NumPulls selections with given cooked distribution, without doing the selections (cost independent of NumPulls).
+	* OutNumFailures counts the pulls selecting nothing (probabilities summing below 1). Not thread safe.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Counts", NotBlueprintThreadSafe), Category = "Fenix|SelectorUtils|Selection")
+	static void BPFunc_SampleCounts(const FCookedSelectorDistribution& Distribution, const int64 NumPulls, TArray<int64>& OutCounts, int64& OutNumFailures);
+
+	/**
+	* Sample how many times each index is selected in NumPulls selections with given cooked distribution and a random stream, without doing the selections (cost independent of NumPulls).
+	* OutNumFailures counts the pulls selecting nothing (probabilities summing below 1).
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Sample Counts From Stream"), Category = "Fenix|SelectorUtils|Selection")
+	static void BPFunc_SampleCountsFromStream(const FCookedSelectorDistribution& Distribution, const int64 NumPulls, const FRandomStream& RandomStream, TArray<int64>& OutCounts, int64& OutNumFailures);
+#pragma endregion
+
+#pragma region Blueprint internal APIs (fused data table selection for the Random Select node)
+	/** Fused selection with weights of a data table column, outputting the selected index, row name and row in one native call. For the Random Select node. */
+	UFUNCTION(BlueprintCallable, CustomThunk, meta = (CustomStructureParam = "OutRow", BlueprintInternalUseOnly = "true", NotBlueprintThreadSafe), Category = "Fenix|SelectorUtils|DataTable")
+	static UPARAM(DisplayName = "OutIndex") int32 DataTable_SelectRowWithWeights(const UDataTable* DataTable, const FName WeightPropertyName, FName& OutRowName, FTableRowBase& OutRow);
+	DECLARE_FUNCTION(execDataTable_SelectRowWithWeights)
+	{
+		P_GET_OBJECT(UDataTable, DataTable);
+		P_GET_PROPERTY(FNameProperty, WeightPropertyName);
+		P_GET_PROPERTY_REF(FNameProperty, OutRowName);
+		Stack.MostRecentPropertyAddress = nullptr;
+		Stack.StepCompiledIn<FStructProperty>(NULL);
+		void* OutRowPtr = Stack.MostRecentPropertyAddress;
+		const FStructProperty* OutRowProperty = CastField<FStructProperty>(Stack.MostRecentProperty);
+		P_FINISH;
+		P_NATIVE_BEGIN;
+		*(int32*)RESULT_PARAM = Generic_DataTable_SelectRowWithWeights(DataTable, WeightPropertyName, nullptr, OutRowName, OutRowProperty, OutRowPtr);
+		P_NATIVE_END;
+	}
+
+	/** Fused selection with weights of a data table column and a random stream, outputting the selected index, row name and row in one native call. For the Random Select node. */
+	UFUNCTION(BlueprintCallable, CustomThunk, meta = (CustomStructureParam = "OutRow", BlueprintInternalUseOnly = "true"), Category = "Fenix|SelectorUtils|DataTable")
+	static UPARAM(DisplayName = "OutIndex") int32 DataTable_SelectRowWithWeightsFromStream(const UDataTable* DataTable, const FName WeightPropertyName, const FRandomStream& RandomStream, FName& OutRowName, FTableRowBase& OutRow);
+	DECLARE_FUNCTION(execDataTable_SelectRowWithWeightsFromStream)
+	{
+		P_GET_OBJECT(UDataTable, DataTable);
+		P_GET_PROPERTY(FNameProperty, WeightPropertyName);
+		P_GET_STRUCT_REF(FRandomStream, RandomStream);
+		P_GET_PROPERTY_REF(FNameProperty, OutRowName);
+		Stack.MostRecentPropertyAddress = nullptr;
+		Stack.StepCompiledIn<FStructProperty>(NULL);
+		void* OutRowPtr = Stack.MostRecentPropertyAddress;
+		const FStructProperty* OutRowProperty = CastField<FStructProperty>(Stack.MostRecentProperty);
+		P_FINISH;
+		P_NATIVE_BEGIN;
+		*(int32*)RESULT_PARAM = Generic_DataTable_SelectRowWithWeights(DataTable, WeightPropertyName, &RandomStream, OutRowName, OutRowProperty, OutRowPtr);
+		P_NATIVE_END;
+	}
+
+	/** Fused selection with probabilities of a data table column, outputting the selected index, row name and row in one native call. For the Random Select node. */
+	UFUNCTION(BlueprintCallable, CustomThunk, meta = (CustomStructureParam = "OutRow", BlueprintInternalUseOnly = "true", NotBlueprintThreadSafe), Category = "Fenix|SelectorUtils|DataTable")
+	static UPARAM(DisplayName = "OutIndex") int32 DataTable_SelectRowWithProbs(const UDataTable* DataTable, const FName ProbPropertyName, FName& OutRowName, FTableRowBase& OutRow);
+	DECLARE_FUNCTION(execDataTable_SelectRowWithProbs)
+	{
+		P_GET_OBJECT(UDataTable, DataTable);
+		P_GET_PROPERTY(FNameProperty, ProbPropertyName);
+		P_GET_PROPERTY_REF(FNameProperty, OutRowName);
+		Stack.MostRecentPropertyAddress = nullptr;
+		Stack.StepCompiledIn<FStructProperty>(NULL);
+		void* OutRowPtr = Stack.MostRecentPropertyAddress;
+		const FStructProperty* OutRowProperty = CastField<FStructProperty>(Stack.MostRecentProperty);
+		P_FINISH;
+		P_NATIVE_BEGIN;
+		*(int32*)RESULT_PARAM = Generic_DataTable_SelectRowWithProbs(DataTable, ProbPropertyName, nullptr, OutRowName, OutRowProperty, OutRowPtr);
+		P_NATIVE_END;
+	}
+
+	/** Fused selection with probabilities of a data table column and a random stream, outputting the selected index, row name and row in one native call. For the Random Select node. */
+	UFUNCTION(BlueprintCallable, CustomThunk, meta = (CustomStructureParam = "OutRow", BlueprintInternalUseOnly = "true"), Category = "Fenix|SelectorUtils|DataTable")
+	static UPARAM(DisplayName = "OutIndex") int32 DataTable_SelectRowWithProbsFromStream(const UDataTable* DataTable, const FName ProbPropertyName, const FRandomStream& RandomStream, FName& OutRowName, FTableRowBase& OutRow);
+	DECLARE_FUNCTION(execDataTable_SelectRowWithProbsFromStream)
+	{
+		P_GET_OBJECT(UDataTable, DataTable);
+		P_GET_PROPERTY(FNameProperty, ProbPropertyName);
+		P_GET_STRUCT_REF(FRandomStream, RandomStream);
+		P_GET_PROPERTY_REF(FNameProperty, OutRowName);
+		Stack.MostRecentPropertyAddress = nullptr;
+		Stack.StepCompiledIn<FStructProperty>(NULL);
+		void* OutRowPtr = Stack.MostRecentPropertyAddress;
+		const FStructProperty* OutRowProperty = CastField<FStructProperty>(Stack.MostRecentProperty);
+		P_FINISH;
+		P_NATIVE_BEGIN;
+		*(int32*)RESULT_PARAM = Generic_DataTable_SelectRowWithProbs(DataTable, ProbPropertyName, &RandomStream, OutRowName, OutRowProperty, OutRowPtr);
+		P_NATIVE_END;
+	}
+
+	/** Fused selection with WeightOrProbEntry's of a data table column, outputting the selected index, row name and row in one native call. For the Random Select node. */
+	UFUNCTION(BlueprintCallable, CustomThunk, meta = (CustomStructureParam = "OutRow", BlueprintInternalUseOnly = "true", NotBlueprintThreadSafe), Category = "Fenix|SelectorUtils|DataTable")
+	static UPARAM(DisplayName = "OutIndex") int32 DataTable_SelectRowWithWeightOrProbEntries(const UDataTable* DataTable, const FName WeightOrProbPropertyName, const FName IsProbPropertyName, FName& OutRowName, FTableRowBase& OutRow);
+	DECLARE_FUNCTION(execDataTable_SelectRowWithWeightOrProbEntries)
+	{
+		P_GET_OBJECT(UDataTable, DataTable);
+		P_GET_PROPERTY(FNameProperty, WeightOrProbPropertyName);
+		P_GET_PROPERTY(FNameProperty, IsProbPropertyName);
+		P_GET_PROPERTY_REF(FNameProperty, OutRowName);
+		Stack.MostRecentPropertyAddress = nullptr;
+		Stack.StepCompiledIn<FStructProperty>(NULL);
+		void* OutRowPtr = Stack.MostRecentPropertyAddress;
+		const FStructProperty* OutRowProperty = CastField<FStructProperty>(Stack.MostRecentProperty);
+		P_FINISH;
+		P_NATIVE_BEGIN;
+		*(int32*)RESULT_PARAM = Generic_DataTable_SelectRowWithWeightOrProbEntries(DataTable, WeightOrProbPropertyName, IsProbPropertyName, nullptr, OutRowName, OutRowProperty, OutRowPtr);
+		P_NATIVE_END;
+	}
+
+	/** Fused selection with WeightOrProbEntry's of a data table column and a random stream, outputting the selected index, row name and row in one native call. For the Random Select node. */
+	UFUNCTION(BlueprintCallable, CustomThunk, meta = (CustomStructureParam = "OutRow", BlueprintInternalUseOnly = "true"), Category = "Fenix|SelectorUtils|DataTable")
+	static UPARAM(DisplayName = "OutIndex") int32 DataTable_SelectRowWithWeightOrProbEntriesFromStream(const UDataTable* DataTable, const FName WeightOrProbPropertyName, const FName IsProbPropertyName, const FRandomStream& RandomStream, FName& OutRowName, FTableRowBase& OutRow);
+	DECLARE_FUNCTION(execDataTable_SelectRowWithWeightOrProbEntriesFromStream)
+	{
+		P_GET_OBJECT(UDataTable, DataTable);
+		P_GET_PROPERTY(FNameProperty, WeightOrProbPropertyName);
+		P_GET_PROPERTY(FNameProperty, IsProbPropertyName);
+		P_GET_STRUCT_REF(FRandomStream, RandomStream);
+		P_GET_PROPERTY_REF(FNameProperty, OutRowName);
+		Stack.MostRecentPropertyAddress = nullptr;
+		Stack.StepCompiledIn<FStructProperty>(NULL);
+		void* OutRowPtr = Stack.MostRecentPropertyAddress;
+		const FStructProperty* OutRowProperty = CastField<FStructProperty>(Stack.MostRecentProperty);
+		P_FINISH;
+		P_NATIVE_BEGIN;
+		*(int32*)RESULT_PARAM = Generic_DataTable_SelectRowWithWeightOrProbEntries(DataTable, WeightOrProbPropertyName, IsProbPropertyName, &RandomStream, OutRowName, OutRowProperty, OutRowPtr);
+		P_NATIVE_END;
+	}
+
+	/**
+	* Native implementations of the fused data table selection: extract the column(s), select, then copy out the row name and the row
+	* while walking the row map once, instead of a separate GetDataTableRow (a second name lookup and row copy through the VM).
+	* The row is not copied if OutRowProperty is FTableRowBase itself (i.e. the row output is unused), or if its type does not match the table.
+	*/
+	static int32 Generic_DataTable_SelectRowWithWeights(const UDataTable* DataTable, const FName WeightPropertyName, const FRandomStream* RandomStream, FName& OutRowName, const FStructProperty* OutRowProperty, void* OutRowPtr);
+	static int32 Generic_DataTable_SelectRowWithProbs(const UDataTable* DataTable, const FName ProbPropertyName, const FRandomStream* RandomStream, FName& OutRowName, const FStructProperty* OutRowProperty, void* OutRowPtr);
+	static int32 Generic_DataTable_SelectRowWithWeightOrProbEntries(const UDataTable* DataTable, const FName WeightOrProbPropertyName, const FName IsProbPropertyName, const FRandomStream* RandomStream, FName& OutRowName, const FStructProperty* OutRowProperty, void* OutRowPtr);
 #pragma endregion
 
 #pragma region C++ only APIs
@@ -200,14 +723,16 @@ public:
 	* Select index with given cumulative weights, negative returning value means failure.
 	* Require input non-negative and non-decreasing.
 	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	* While audit recording is on, the array is hashed (O(n)) for its table id on every call unless AuditTableId (from FSelectorAuditLog::MakeTableId) is given.
 	*/
-	static int32 SelectWithCumWeights(const TArray<double>& CumWeights, const FRandomStream* RandomStream = nullptr);
+	static int32 SelectWithCumWeights(const TArray<double>& CumWeights, const FRandomStream* RandomStream = nullptr, const uint32 AuditTableId = 0);
 
 	/** 
 	* Select index with given weights, negative returning value means failure.
 	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	* While audit recording is on, the array is hashed (O(n)) for its table id on every call unless AuditTableId (from FSelectorAuditLog::MakeTableId) is given.
 	*/
-	static int32 SelectWithWeights(const TArray<double>& Weights, const FRandomStream* RandomStream = nullptr);
+	static int32 SelectWithWeights(const TArray<double>& Weights, const FRandomStream* RandomStream = nullptr, const uint32 AuditTableId = 0);
 
 	/**
 	* Select index with given cumulative probabilities, negative returning value means failure.
@@ -215,16 +740,18 @@ public:
 	* If the total is not enough, then when it rolls outside it counts as failure.
 	* Require input non-negative and non-decreasing.
 	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	* While audit recording is on, the array is hashed (O(n)) for its table id on every call unless AuditTableId (from FSelectorAuditLog::MakeTableId) is given.
 	*/
-	static int32 SelectWithCumProbs(const TArray<double>& CumProbs, const FRandomStream* RandomStream = nullptr);
+	static int32 SelectWithCumProbs(const TArray<double>& CumProbs, const FRandomStream* RandomStream = nullptr, const uint32 AuditTableId = 0);
 	
 	/**
 	* Select index with given probabilities, negative returning value means failure.
 	* Cut off or padded at the end to a cumulative probability of 1.0 if the total is more.
 	* If the total is not enough, then when it rolls outside it counts as failure.
 	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	* While audit recording is on, the array is hashed (O(n)) for its table id on every call unless AuditTableId (from FSelectorAuditLog::MakeTableId) is given.
 	*/
-	static int32 SelectWithProbs(const TArray<double>& Probs, const FRandomStream* RandomStream = nullptr);
+	static int32 SelectWithProbs(const TArray<double>& Probs, const FRandomStream* RandomStream = nullptr, const uint32 AuditTableId = 0);
 
 	/**
 	* Select index with given CookedSelectorDistribution, negative returning value means failure.
@@ -241,20 +768,127 @@ public:
 	* Probability entries are cut off at the end to a cumulative probability of 1.0 if the total is more.
 	* If all positive entries are probabilities and the total is not enough, then when it rolls outside it counts as failure.
 	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	* While audit recording is on, the array is hashed (O(n)) for its table id on every call unless AuditTableId (from FSelectorAuditLog::MakeTableId) is given.
+	*/
+	static int32 SelectWithWeightOrProbEntries(const TArray<FWeightOrProbEntry>& Entries, const FRandomStream* RandomStream = nullptr, const uint32 AuditTableId = 0);
+
+	/**
+	* Select index with given alias table in O(1), negative returning value means failure.
+	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	*/
+	static int32 SelectWithAliasTable(const FCookedAliasTable& AliasTable, const FRandomStream* RandomStream = nullptr);
+
+	/**
+	* Select index with given quantized distribution, negative returning value means failure. Compares a raw random word against the integer thresholds:
+	* a branchless count over up to 64 thresholds (vectorized by the compiler), a binary search beyond.
+	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	*/
+	static int32 SelectWithQuantizedDistribution(const FCookedQuantizedDistribution& Distribution, const FRandomStream* RandomStream = nullptr);
+
+	/**
+	* Select index with given small distribution in a single branchless pass over its inline slots, negative returning value means failure.
+	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	*/
+	static int32 SelectWithSmallDistribution(const FCookedSmallSelectorDistribution& Distribution, const FRandomStream* RandomStream = nullptr);
+
+	/**
+	* Select item index with given category selector, negative returning value means failure (with OutCategoryIndex -1 too).
+	* Each category's weight is scaled by its multiplier in CategoryMultipliers (missing ones being 1.0, negative or NaN ones 0.0, capped at MaxCategoryMultiplier), e.g. kept per player,
+	* so boosts need no re-cooking. A linear pass over the categories, then a binary search within the selected one.
+	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	*/
+	static int32 SelectWithCategorySelector(const FCookedCategorySelector& Selector, const TArray<double>& CategoryMultipliers, int32& OutCategoryIndex, const FRandomStream* RandomStream = nullptr);
+
+	/**
+	* Select index (in the original entries) with given compact distribution, negative returning value means failure.
+	* A single branchless count over the kept cumulatives (linear up to 64 of them, binary beyond) and a remap.
+	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	*/
+	static int32 SelectWithCompactDistribution(const FCookedCompactDistribution& Distribution, const FRandomStream* RandomStream = nullptr);
+
+	/**
+	* Select index with given weighted search tree, negative returning value means failure. Walks down from the root, the likely entries being near it.
+	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	*/
+	static int32 SelectWithWeightedSearchTree(const FCookedWeightedSearchTree& Tree, const FRandomStream* RandomStream = nullptr);
+
+	/**
+	* Select index with given cumulative tickets (integer weights), negative returning value means failure. Require input non-negative and non-decreasing.
+	* Exact: draws an integer below the total with Lemire's bounded method (32 bit draws while the total fits) and counts the cumulatives not above it,
+	* so each index gets exactly its share of the tickets with no floating point involved. Results for a given stream are the same on every platform.
+	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	* While audit recording is on, the array is hashed (O(n)) for its table id on every call unless AuditTableId is given.
+	*/
+	static int32 SelectWithCumTickets(const TArray<int64>& CumTickets, const FRandomStream* RandomStream = nullptr, const uint32 AuditTableId = 0);
+	static int32 SelectWithCumTickets(const TArray<uint32>& CumTickets, const FRandomStream* RandomStream = nullptr, const uint32 AuditTableId = 0);
+	static int32 SelectWithCumTickets(const TArray<uint64>& CumTickets, const FRandomStream* RandomStream = nullptr, const uint32 AuditTableId = 0);
+
+	/**
+	* Select index with given tickets (integer weights, negative ones regarded as zeros), negative returning value means failure. Exact as SelectWithCumTickets.
+	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	* While audit recording is on, the array is hashed (O(n)) for its table id on every call unless AuditTableId is given.
 	*/
-	static int32 SelectWithWeightOrProbEntries(const TArray<FWeightOrProbEntry>& Entries, const FRandomStream* RandomStream = nullptr);
+	static int32 SelectWithTickets(const TArray<int64>& Tickets, const FRandomStream* RandomStream = nullptr, const uint32 AuditTableId = 0);
+
+	/**
+	* Sample the multinomial counts of NumPulls selections with given cooked distribution (OutCounts having one count per entry), in O(entries) regardless of NumPulls:
+	* each count is binomial over the pulls left, with the probability of the entry among the entries left. Pulls are not audited.
+	* Returns the number of pulls selecting nothing (probabilities summing below 1).
+	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	*/
+	static int64 SampleCounts(const FCookedSelectorDistribution& Distribution, const int64 NumPulls, TArray<int64>& OutCounts, const FRandomStream* RandomStream = nullptr);
+
+	/**
+	* Sample the number of successes in NumTrials trials of probability Prob, with BTPE (Kachitvichyanukul and Schmeiser) when the mean is at least 30, by inversion otherwise.
+	* O(1) expected regardless of NumTrials. Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	*/
+	static int64 SampleBinomial(const int64 NumTrials, const double Prob, const FRandomStream* RandomStream = nullptr);
+
+	/** Alias table selection without stats and auditing, for batch samplers built on alias tables. */
+	static FORCEINLINE int32 SelectWithAliasTableUnchecked(const FCookedAliasTable& AliasTable, const FRandomStream* RandomStream)
+	{
+		// unbiased column even for large tables, and a 53 bit coin so the double thresholds are resolved in full
+		const int32 Column = static_cast<int32>(UCommonUtils::RandBounded32MaybeWithStream(static_cast<uint32>(AliasTable.Thresholds.Num()), RandomStream));
+		const int32 Selected = UCommonUtils::DRandMaybeWithStream(RandomStream) < AliasTable.Thresholds[Column] ? Column : AliasTable.Aliases[Column];
+		return Selected < AliasTable.NumEntries ? Selected : -1;
+	}
 #pragma endregion
 
 private:
+	/** Implementations of the C++ APIs above, without stats and auditing, so they can be used by each other without double counting. */
+	static int32 SelectWithCumWeightsImpl(const TArray<double>& CumWeights, const FRandomStream* RandomStream, const TArray<int32>* GuideTable = nullptr);
+	static int32 SelectWithWeightsImpl(const TArray<double>& Weights, const FRandomStream* RandomStream);
+	static int32 SelectWithCumProbsImpl(const TArray<double>& CumProbs, const FRandomStream* RandomStream, const TArray<int32>* GuideTable = nullptr);
+	static int32 SelectWithProbsImpl(const TArray<double>& Probs, const FRandomStream* RandomStream);
+	static int32 SelectWithCookedDistributionImpl(const FCookedSelectorDistribution& Distribution, const FRandomStream* RandomStream);
+	static int32 SelectWithWeightOrProbEntriesImpl(const TArray<FWeightOrProbEntry>& Entries, const FRandomStream* RandomStream);
+
+	/** Cumulation without stats, for the uncooked selection paths so they do not count as cooking. */
+	static void MakeCumulativesImpl(const TArray<double>& Values, TArray<double>& OutCumulatives, const double ValueLowerClamp = 0.0);
+	static void MakeCumulativesWithCutoffImpl(const TArray<double>& Values, TArray<double>& OutCumulatives, const double ValueLowerClamp = 0.0, const double TotalCutoff = 1.0);
+	static void MakeCumulativeTicketsImpl(const TArray<int64>& Tickets, TArray<int64>& OutCumTickets);
+
+	/** Binomial sampling for Prob in (0, 0.5] and a mean of at least 30 (BTPE), or below (inversion). */
+	static int64 SampleBinomialBTPE(const int64 NumTrials, const double Prob, const FRandomStream* RandomStream);
+	static int64 SampleBinomialInversion(const int64 NumTrials, const double Prob, const FRandomStream* RandomStream);
+
+	/** Shared by the alias table cooking functions: cook from non-negative masses, of which the first NumEntries are selectable. */
+	static void CookAliasTableFromMasses(const TArray<double>& Masses, const int32 NumEntries, FCookedAliasTable& OutAliasTable);
+
+	/** Output the row name and the row (if the output type is compatible) at the selected index of a data table. */
+	static void OutputSelectedDataTableRow(const UDataTable* DataTable, const int32 SelectedIndex, FName& OutRowName, const FStructProperty* OutRowProperty, void* OutRowPtr);
+
 	/** 
 	* Helper for selecting with weights. It assumes Num and SumWeight being appropriate and non-zero.
+	* Searching with the guide table built for CumWeights if GuideTable is not nullptr.
 	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
 	*/
-	static int32 SelectWithCumWeightsHelper(const TArray<double>& CumWeights, const int32 Num, const double SumWeight, const FRandomStream* RandomStream = nullptr);
+	static int32 SelectWithCumWeightsHelper(const TArray<double>& CumWeights, const int32 Num, const double SumWeight, const FRandomStream* RandomStream = nullptr, const TArray<int32>* GuideTable = nullptr);
 	
 	/** 
 	* Helper for selecting with probabilities. It assumes Num being appropriate and non-zero.
+	* Searching with the guide table built for CumProbs if GuideTable is not nullptr.
 	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
 	*/
-	static int32 SelectWithCumProbsHelper(const TArray<double>& CumProbs, const int32 Num, const FRandomStream* RandomStream = nullptr);
+	static int32 SelectWithCumProbsHelper(const TArray<double>& CumProbs, const int32 Num, const FRandomStream* RandomStream = nullptr, const TArray<int32>* GuideTable = nullptr);
 };
@@ -0,0 +1,89 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "SelectorUtils.h"
+#include <atomic>
+
+/**
+* Cooked distribution shared by concurrent readers and hot-swapped by live updates, read-copy-update style.
+* A read announces the global reader epoch in a slot of its thread, loads the current version and clears the slot when done: no locks and
+* no reference counting, so rolls never wait on updates. Publishing a newly cooked version swaps the pointer atomically and retires the old
+* version at the epoch of the swap; the core ticker frees it only once no thread is inside a read announced at or before that epoch,
+* however long the read is preempted or its callback takes.
+* Hence a version read with Read or Select must not be kept beyond the call; use Pin to hold one longer.
+*/
+class FENIXSTOCHASTICUTILS_API FSharedCookedDistribution : public TSharedFromThis<FSharedCookedDistribution, ESPMode::ThreadSafe>
+{
+public:
+	/** A published distribution, immutable once published. */
+	struct FVersion
+	{
+		FCookedSelectorDistribution Distribution;
+
+		/** 1 for the initial distribution, increasing with every publish. */
+		uint32 VersionNumber = 0;
+	};
+
+	static TSharedRef<FSharedCookedDistribution, ESPMode::ThreadSafe> Create(const FCookedSelectorDistribution& InDistribution);
+
+	~FSharedCookedDistribution();
+
+	/** Select with the current version, negative returning value means failure. Lock-free, thread safe when using a stream. */
+	int32 Select(const FRandomStream* RandomStream = nullptr) const;
+
+	/** Call Reader with the current version. Lock-free and reentrant; the reference must not escape the call. */
+	template <typename FReaderFunction>
+	auto Read(FReaderFunction&& Reader) const
+	{
+		FReadScope ReadScope;
+		return Reader(*Current.load(std::memory_order_seq_cst));  // ordered after the announcement of the read
+	}
+
+	/** Hold the current version for longer than a call, e.g. across frames. Takes the publish lock, so not for every roll. */
+	TSharedRef<const FVersion, ESPMode::ThreadSafe> Pin() const;
+
+	/** Publish a newly cooked distribution to the next readers and retire the previous one. Thread safe, never blocks readers. Returns the new version number. */
+	uint32 Publish(const FCookedSelectorDistribution& NewDistribution);
+
+	uint32 GetVersionNumber() const { return Read([](const FVersion& Version) { return Version.VersionNumber; }); }
+
+	/** Number of retired versions not freed yet. */
+	int32 GetNumRetiredVersions() const;
+
+private:
+	explicit FSharedCookedDistribution(const FCookedSelectorDistribution& InDistribution);
+
+	bool OnTick(float DeltaTime);
+
+	/** Announces a read on the current thread for its lifetime, nested ones being covered by the outermost. */
+	struct FReadScope
+	{
+		FReadScope() { EnterRead(); }
+		~FReadScope() { ExitRead(); }
+	};
+
+	static void EnterRead();
+	static void ExitRead();
+
+	struct FRetiredVersion
+	{
+		TSharedPtr<const FVersion, ESPMode::ThreadSafe> Version;
+
+		/** Reader epoch when it was swapped out: readers announcing a later epoch load a newer version. */
+		uint64 RetireEpoch = 0;
+	};
+
+	/** The version readers load. Always points into CurrentVersion or a retired version. */
+	std::atomic<const FVersion*> Current{nullptr};
+
+	/** Owner of the current version, only touched under PublishLock. */
+	TSharedPtr<const FVersion, ESPMode::ThreadSafe> CurrentVersion;
+
+	TArray<FRetiredVersion> RetiredVersions;
+	mutable FCriticalSection PublishLock;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+};
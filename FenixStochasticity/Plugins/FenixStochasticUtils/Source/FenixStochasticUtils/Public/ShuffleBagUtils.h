@@ -0,0 +1,128 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "SelectorUtils.h"
+
+#include "ShuffleBagUtils.generated.h"
+
+/**
+* Serializable state of a shuffle bag: the deck and what is left of it, one count per entry (plus one last for the failure cards of probabilities summing below 1).
+*/
+USTRUCT(BlueprintType)
+struct FENIXSTOCHASTICUTILS_API FSelectorShuffleBagSnapshot
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<int64> DeckCounts;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<int64> RemainingCounts;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 NumRefills = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 TableId = 0;
+};
+
+/**
+* A bag selector drawing without replacement from a virtual deck of integer counts, refilled when empty, so the rates are exact over each deck
+* (e.g. exactly 3 rares in every 100 drops). The deck is never materialized: the remaining counts are kept in a Fenwick tree,
+* so each draw is O(log entries) regardless of the deck size.
+*/
+USTRUCT(BlueprintType)
+struct FENIXSTOCHASTICUTILS_API FSelectorShuffleBag
+{
+	GENERATED_BODY()
+
+	/** Cards of each entry in a full deck (plus one last for the failure cards). */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TArray<int64> DeckCounts;
+
+	/** Fenwick tree of the remaining counts. */
+	UPROPERTY()
+	TArray<int64> RemainingTree;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int64 DeckSize = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int64 NumRemaining = 0;
+
+	/** Number of entries that can be selected, the failure cards being beyond. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 NumEntries = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 NumRefills = 0;
+
+	/** Audit table id of the distribution the bag was cooked from. */
+	UPROPERTY(VisibleAnywhere, AdvancedDisplay)
+	int32 TableId = 0;
+};
+
+/**
+* Shuffle bag cooking, drawing and snapshots. Drawing mutates the bag, so a bag must not be drawn from on several threads at once.
+*/
+UCLASS(meta = (BlueprintThreadSafe))
+class FENIXSTOCHASTICUTILS_API UShuffleBagUtils : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+#pragma region Blueprint and C++ APIs
+	/**
+	* Cook a bag of DeckSize cards from a cooked distribution: each entry gets its share of the deck rounded by the largest remainder method,
+	* so the counts add up to DeckSize exactly. With probabilities summing below 1, the missing share becomes failure cards.
+	* Returns false if the distribution has no positive weight/probability or DeckSize is not positive.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Fenix|ShuffleBagUtils|SamplingPreprocessing")
+	static bool CookShuffleBag(const FCookedSelectorDistribution& Distribution, const int64 DeckSize, FSelectorShuffleBag& OutBag);
+
+	/** Cook a bag with explicit cards per entry (non-negative), without failure cards. Returns false if there is no card. */
+	UFUNCTION(BlueprintCallable, Category = "Fenix|ShuffleBagUtils|SamplingPreprocessing")
+	static bool CookShuffleBagFromCounts(const TArray<int64>& Counts, FSelectorShuffleBag& OutBag);
+
+	/** Put all the cards back into the bag. */
+	UFUNCTION(BlueprintCallable, Category = "Fenix|ShuffleBagUtils")
+	static void RefillShuffleBag(UPARAM(ref) FSelectorShuffleBag& Bag);
+
+	/** The state of the bag in a small serializable struct (O(entries), not the deck size). */
+	UFUNCTION(BlueprintPure, Category = "Fenix|ShuffleBagUtils")
+	static FSelectorShuffleBagSnapshot SnapshotShuffleBag(const FSelectorShuffleBag& Bag);
+
+	/** Restore a bag from a snapshot. Returns false (leaving the bag untouched) if the snapshot is inconsistent. */
+	UFUNCTION(BlueprintCallable, Category = "Fenix|ShuffleBagUtils")
+	static bool RestoreShuffleBag(const FSelectorShuffleBagSnapshot& Snapshot, FSelectorShuffleBag& OutBag);
+
+	/** Remaining cards of an entry (the failure cards at index NumEntries). */
+	UFUNCTION(BlueprintPure, Category = "Fenix|ShuffleBagUtils")
+	static int64 GetShuffleBagRemainingCount(const FSelectorShuffleBag& Bag, const int32 Index);
+#pragma endregion
+
+#pragma region Blueprint only APIs (for C++ direct usage better use ones in the later section)
+	/** Draw a card from the bag (refilling it first if empty), negative returning value means failure. Not thread safe. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Draw From Shuffle Bag", NotBlueprintThreadSafe), Category = "Fenix|ShuffleBagUtils|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 BPFunc_DrawFromShuffleBag(UPARAM(ref) FSelectorShuffleBag& Bag);
+
+	/** Draw a card from the bag (refilling it first if empty) with a random stream, negative returning value means failure. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Draw From Shuffle Bag From Stream"), Category = "Fenix|ShuffleBagUtils|Selection")
+	static UPARAM(DisplayName = "OutIndex") int32 BPFunc_DrawFromShuffleBagFromStream(UPARAM(ref) FSelectorShuffleBag& Bag, const FRandomStream& RandomStream);
+#pragma endregion
+
+#pragma region C++ only APIs
+	/**
+	* Draw a card from the bag in O(log entries), refilling it first if empty. Negative returning value means failure (a failure card or an empty deck).
+	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream and the bag is not shared.
+	*/
+	static int32 DrawFromShuffleBag(FSelectorShuffleBag& Bag, const FRandomStream* RandomStream = nullptr);
+#pragma endregion
+
+private:
+	/** Build the Fenwick tree from counts in O(entries). */
+	static void BuildRemainingTree(const TArray<int64>& Counts, TArray<int64>& OutTree);
+};
@@ -0,0 +1,198 @@
+// Copyright 2025, Tiannan Chen, All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "CommonUtils.h"
+
+#include "ShuffleUtils.generated.h"
+
+/**
+* Uniform shuffles (Fisher-Yates with batched bounded random integers) and weighted shuffles (Efraimidis-Spirakis keys),
+* for any Blueprint array type and for C++ arrays.
+*/
+UCLASS(meta = (BlueprintThreadSafe))
+class FENIXSTOCHASTICUTILS_API UShuffleUtils : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+#pragma region Blueprint only APIs (for C++ direct usage better use ones in the later section)
+	/** Shuffle an array of any type in place, uniformly. Not thread safe. */
+	UFUNCTION(BlueprintCallable, CustomThunk, meta = (DisplayName = "Shuffle", ArrayParm = "TargetArray", NotBlueprintThreadSafe), Category = "Fenix|ShuffleUtils")
+	static void Array_Shuffle(const TArray<int32>& TargetArray);
+	DECLARE_FUNCTION(execArray_Shuffle)
+	{
+		Stack.MostRecentProperty = nullptr;
+		Stack.StepCompiledIn<FArrayProperty>(NULL);
+		void* ArrayAddr = Stack.MostRecentPropertyAddress;
+		FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Stack.MostRecentProperty);
+		if (!ArrayProperty)
+		{
+			Stack.bArrayContextFailed = true;
+			return;
+		}
+
+		P_FINISH;
+		P_NATIVE_BEGIN;
+		GenericArray_Shuffle(ArrayAddr, ArrayProperty, nullptr);
+		P_NATIVE_END;
+	}
+
+	/** Shuffle an array of any type in place, uniformly, with a random stream. */
+	UFUNCTION(BlueprintCallable, CustomThunk, meta = (DisplayName = "Shuffle From Stream", ArrayParm = "TargetArray"), Category = "Fenix|ShuffleUtils")
+	static void Array_ShuffleFromStream(const TArray<int32>& TargetArray, const FRandomStream& RandomStream);
+	DECLARE_FUNCTION(execArray_ShuffleFromStream)
+	{
+		Stack.MostRecentProperty = nullptr;
+		Stack.StepCompiledIn<FArrayProperty>(NULL);
+		void* ArrayAddr = Stack.MostRecentPropertyAddress;
+		FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Stack.MostRecentProperty);
+		if (!ArrayProperty)
+		{
+			Stack.bArrayContextFailed = true;
+			return;
+		}
+		P_GET_STRUCT_REF(FRandomStream, RandomStream);
+
+		P_FINISH;
+		P_NATIVE_BEGIN;
+		GenericArray_Shuffle(ArrayAddr, ArrayProperty, &RandomStream);
+		P_NATIVE_END;
+	}
+
+	/**
+	* Shuffle an array of any type in place by weights (one per element): the first element is selected by weight, then the next among the rest, and so on.
+	* Elements with non-positive weights go last in uniform order. Does nothing if the numbers of elements and weights differ. Not thread safe.
+	*/
+	UFUNCTION(BlueprintCallable, CustomThunk, meta = (DisplayName = "Weighted Shuffle", ArrayParm = "TargetArray", NotBlueprintThreadSafe), Category = "Fenix|ShuffleUtils")
+	static void Array_WeightedShuffle(const TArray<int32>& TargetArray, const TArray<double>& Weights);
+	DECLARE_FUNCTION(execArray_WeightedShuffle)
+	{
+		Stack.MostRecentProperty = nullptr;
+		Stack.StepCompiledIn<FArrayProperty>(NULL);
+		void* ArrayAddr = Stack.MostRecentPropertyAddress;
+		FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Stack.MostRecentProperty);
+		if (!ArrayProperty)
+		{
+			Stack.bArrayContextFailed = true;
+			return;
+		}
+		P_GET_TARRAY_REF(double, Weights);
+
+		P_FINISH;
+		P_NATIVE_BEGIN;
+		GenericArray_WeightedShuffle(ArrayAddr, ArrayProperty, Weights, nullptr);
+		P_NATIVE_END;
+	}
+
+	/** Weighted shuffle of an array of any type in place with a random stream, see Weighted Shuffle. */
+	UFUNCTION(BlueprintCallable, CustomThunk, meta = (DisplayName = "Weighted Shuffle From Stream", ArrayParm = "TargetArray"), Category = "Fenix|ShuffleUtils")
+	static void Array_WeightedShuffleFromStream(const TArray<int32>& TargetArray, const TArray<double>& Weights, const FRandomStream& RandomStream);
+	DECLARE_FUNCTION(execArray_WeightedShuffleFromStream)
+	{
+		Stack.MostRecentProperty = nullptr;
+		Stack.StepCompiledIn<FArrayProperty>(NULL);
+		void* ArrayAddr = Stack.MostRecentPropertyAddress;
+		FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Stack.MostRecentProperty);
+		if (!ArrayProperty)
+		{
+			Stack.bArrayContextFailed = true;
+			return;
+		}
+		P_GET_TARRAY_REF(double, Weights);
+		P_GET_STRUCT_REF(FRandomStream, RandomStream);
+
+		P_FINISH;
+		P_NATIVE_BEGIN;
+		GenericArray_WeightedShuffle(ArrayAddr, ArrayProperty, Weights, &RandomStream);
+		P_NATIVE_END;
+	}
+
+	/** Output the indices of the weights in a weighted shuffled order, see Weighted Shuffle. Not thread safe. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Weighted Shuffle Indices", NotBlueprintThreadSafe), Category = "Fenix|ShuffleUtils")
+	static void BPFunc_WeightedShuffleIndices(const TArray<double>& Weights, TArray<int32>& OutIndices);
+
+	/** Output the indices of the weights in a weighted shuffled order with a random stream, see Weighted Shuffle. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Weighted Shuffle Indices From Stream"), Category = "Fenix|ShuffleUtils")
+	static void BPFunc_WeightedShuffleIndicesFromStream(const TArray<double>& Weights, const FRandomStream& RandomStream, TArray<int32>& OutIndices);
+#pragma endregion
+
+#pragma region C++ only APIs
+	/** Native implementations of the wildcard shuffles. */
+	static void GenericArray_Shuffle(void* TargetArray, const FArrayProperty* ArrayProperty, const FRandomStream* RandomStream);
+	static void GenericArray_WeightedShuffle(void* TargetArray, const FArrayProperty* ArrayProperty, const TArray<double>& Weights, const FRandomStream* RandomStream);
+
+	/**
+	* Shuffle in place uniformly. Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	*/
+	template <typename T>
+	static void Shuffle(TArrayView<T> Values, const FRandomStream* RandomStream = nullptr)
+	{
+		ShuffleWithSwap(Values.Num(), [&Values](const int32 IndexA, const int32 IndexB) { Swap(Values[IndexA], Values[IndexB]); }, RandomStream);
+	}
+
+	/**
+	* Fisher-Yates shuffle of Num elements through a swap function. Each 64 bit random number gives as many bounded indices as the product of their bounds
+	* fits in 64 bits (Brackett-Luce and Lemire's batched ranged integers, multiplications without divisions but on rare rejections),
+	* e.g. 4 indices per random number for 10k elements.
+	* Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	*/
+	template <typename FSwapFunction>
+	static void ShuffleWithSwap(const int32 Num, FSwapFunction&& SwapFunction, const FRandomStream* RandomStream = nullptr)
+	{
+		constexpr int32 MaxBatchSize = 8;
+		uint64 Indices[MaxBatchSize];
+		int32 Remaining = Num;
+		while (Remaining > 1)
+		{
+			int32 BatchSize = 0;
+			uint64 Product = 1;
+			while (BatchSize < MaxBatchSize && Remaining - BatchSize > 1 && Product <= MAX_uint64 / static_cast<uint64>(Remaining - BatchSize))
+			{
+				Product *= static_cast<uint64>(Remaining - BatchSize);
+				BatchSize++;
+			}
+
+			uint64 Leftover = DrawBatchedIndices(Remaining, BatchSize, Indices, RandomStream);
+			if (Leftover < Product)  // rarely, check if the random number falls in the biased remainder
+			{
+				const uint64 Threshold = (0 - Product) % Product;
+				while (Leftover < Threshold)
+				{
+					Leftover = DrawBatchedIndices(Remaining, BatchSize, Indices, RandomStream);
+				}
+			}
+			for (int32 BatchIdx = 0; BatchIdx < BatchSize; BatchIdx++)
+			{
+				const int32 Last = Remaining - 1 - BatchIdx;
+				const int32 Picked = static_cast<int32>(Indices[BatchIdx]);
+				if (Picked != Last)
+				{
+					SwapFunction(Last, Picked);
+				}
+			}
+			Remaining -= BatchSize;
+		}
+	}
+
+	/**
+	* Indices of the weights in a weighted shuffled order: keys log(U) / Weight are sorted descending (Efraimidis-Spirakis), in parallel for large arrays.
+	* Non-positive weights go last in uniform order. Using a random stream if the optional input RandomStream is not nullptr. Threadsafe only when using a stream.
+	*/
+	static void WeightedShuffleIndices(const TArray<double>& Weights, TArray<int32>& OutIndices, const FRandomStream* RandomStream = nullptr);
+#pragma endregion
+
+private:
+	/** Indices uniform in [0, Bound), [0, Bound - 1) ... from one 64 bit random number by successive multiplications, returning the leftover low bits. */
+	static FORCEINLINE uint64 DrawBatchedIndices(const int32 Bound, const int32 BatchSize, uint64* OutIndices, const FRandomStream* RandomStream)
+	{
+		uint64 Random = UCommonUtils::Rand64MaybeWithStream(RandomStream);
+		for (int32 BatchIdx = 0; BatchIdx < BatchSize; BatchIdx++)
+		{
+			Random = UCommonUtils::Multiply64To128(Random, static_cast<uint64>(Bound - BatchIdx), OutIndices[BatchIdx]);
+		}
+		return Random;
+	}
+};